@@ -0,0 +1,29 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// 一行内按 cluster id 对锚点 x/y 分别做最小二乘直线拟合；累加一次，之后每次查询 O(1)
+struct RowLinearFit {
+    double n = 0.0, Sx = 0.0, Sxx = 0.0;
+    double Sy_x = 0.0, Sxy_x = 0.0;
+    double Sy_y = 0.0, Sxy_y = 0.0;
+
+    void add(int id, const cv::Point2f& p);
+    bool predict(int query_id, cv::Point2f& out) const;
+};
+
+// 在点的索引排列上按 y 原地分行（running mean <= dy_thresh 归为同一行），
+// 只保留 mean y 最大（want_bottom）或最小的那一行，不拷贝点、不生成行数组
+class RowGroupScanner {
+public:
+    int scan(const std::vector<cv::Point2f>& pts, float dy_thresh, float y_tie_eps, bool want_bottom);
+
+    const int*  begin() const { return order_.data() + gb_; }
+    const int*  end()   const { return order_.data() + gb_ + gs_; }
+    int         size()  const { return gs_; }
+    cv::Point2f mean(const std::vector<cv::Point2f>& pts) const;
+
+private:
+    std::vector<int> order_;
+    int gb_ = 0, gs_ = 0;
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChipDispatch.h"
+
+// 异步检测：采集线程 submit 一帧拿到票号立即返回，检测在内部线程池上进行，采集与检测重叠。
+// 结果严格按提交顺序交付：构造时给了回调就由工作线程依次回调，否则由调用方 poll。
+// 已提交未交付的帧数不超过 max_in_flight，到上限时 submit 阻塞（或按超时返回 0），
+// poll 模式下调用方不取结果也会因此停下来。
+//
+// 帧按 Mat 引用计数共享，不复制像素：采集端若会复用同一块缓冲，开 copy_frames 或自行 clone。
+
+struct AsyncParams {
+    int  workers = 0;            // 0 = hardware_concurrency
+    int  max_in_flight = 4;
+    bool copy_frames = false;    // submit 时复制像素
+    bool warm_up = true;         // 启动时每个工作线程对每个型号跑一遍空白帧
+};
+
+struct AsyncResult {
+    uint64_t    ticket = 0;
+    bool        found = false;   // detectChip 的返回值
+    ChipResult  chip;
+    double      wait_ms = 0;     // 提交到开始检测
+    double      run_ms  = 0;
+    std::string error;           // 检测抛异常时的信息
+};
+
+class AsyncDetector {
+public:
+    // 在工作线程上调用，同一时刻只有一个；可以把 r 里的内容 move 走。抛出的异常被吞掉，不影响后续交付。
+    // 回调开始前本帧已不计入在途，回调里可以 submit（别的线程可能先占满名额，宜带超时）；
+    // 回调里不能调 drain() 或析构本对象：它们要等交付结束，而交付正卡在这个回调里
+    typedef std::function<void(AsyncResult& r)> Callback;
+
+    explicit AsyncDetector(const AsyncParams& p = AsyncParams(), Callback on_complete = Callback());
+    ~AsyncDetector();   // 已提交的帧做完（回调模式下也交付完）再退出；不能在回调里析构
+    AsyncDetector(const AsyncDetector&) = delete;
+    AsyncDetector& operator=(const AsyncDetector&) = delete;
+
+    // 返回票号（从 1 递增）；在途帧满时等 timeout_ms（< 0 一直等），仍满或参数不合法返回 0。
+    // params 为空时用该型号默认参数；CHIP_AUTO 带 params 返回 0
+    uint64_t submit(const cv::Mat& frame16, ChipKind kind, const ChipParams* params = nullptr, int timeout_ms = -1);
+    // profile 同 chipd："4X" 或 "4X,dx=9.5,tol=4"
+    uint64_t submit(const cv::Mat& frame16, const std::string& profile, int timeout_ms = -1);
+
+    // 取下一个（按提交顺序）结果；无回调时才可用。超时返回 false
+    bool poll(AsyncResult& out, int timeout_ms = -1);
+    // 等已提交的帧全部检测完（回调模式下还要交付完）；不能在回调里调用
+    void drain();
+    int  inFlight() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct Job {
+        uint64_t          ticket = 0;
+        cv::Mat           frame;
+        ChipKind          kind = CHIP_STD;
+        ChipParams        params;
+        bool              custom_params = false;
+        Clock::time_point submitted;
+    };
+
+    void run();
+    void complete(AsyncResult&& r);
+
+    AsyncParams                      p_;
+    Callback                         cb_;
+    mutable std::mutex               mtx_;
+    std::condition_variable          work_cv_;    // 有作业 / 停止
+    std::condition_variable          space_cv_;   // 在途数下降
+    std::condition_variable          done_cv_;    // 有结果完成 / 交付
+    std::deque<Job>                  queue_;
+    std::map<uint64_t, AsyncResult>  done_;       // 已完成、等前面的票号先交付
+    uint64_t                         next_ticket_  = 1;
+    uint64_t                         next_deliver_ = 1;
+    int                              in_flight_ = 0;    // 已提交未交付
+    int                              unfinished_ = 0;   // 已提交未检测完
+    bool                             delivering_ = false;
+    bool                             stop_ = false;
+    std::vector<std::thread>         threads_;
+};
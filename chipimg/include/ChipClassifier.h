@@ -0,0 +1,41 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include "ChipDispatch.h"
+
+// 芯片型号自动识别：用流水线本来就要算的廉价特征（直方图百分位、连通域个数与面积、
+// 孔内点数、点间距）和各型号的版图常量比对，取最近的一个。
+struct ChipFeatures {
+    uint16_t low_v = 0, high_v = 65535;
+    int      blobs = 0;
+    float    median_area = 0.f;
+    int      clusters = 0;           // 点数 >= 3 的聚类（孔）
+    float    pts_per_cluster = 0.f;  // 中位数
+    float    pitch_x = 0.f;          // 孔内横向 / 纵向最近邻间距中位数
+    float    pitch_y = 0.f;
+};
+
+struct ChipProfile {
+    ChipKind kind;
+    float    pts_per_well;   // 网格点数（GridLayout 行 x 列）
+    float    pitch_x, pitch_y;
+    bool     large_spots;    // std 的斑点面积在 100~500，其余型号只有几十像素
+};
+
+const ChipProfile* chipProfiles(int* count);
+
+struct ChipClass {
+    ChipKind     kind = CHIP_STD;
+    float        score = 0.f;    // 与所选型号的距离，越小越像
+    float        margin = 0.f;   // 次优距离 - 最优距离，太小说明区分度低
+    ChipFeatures features;
+};
+
+class FrameStages;
+
+// hist16 可空
+bool computeChipFeatures(const cv::Mat& src16, const uint32_t* hist16, ChipFeatures& f);
+bool classifyChip(const cv::Mat& src16, const uint32_t* hist16, ChipClass& out);
+// 连通域取自帧的阶段缓存（同一帧上的多个 auto 请求共用一次连通域）
+bool computeChipFeatures(FrameStages& stages, ChipFeatures& f);
+bool classifyChip(FrameStages& stages, ChipClass& out);
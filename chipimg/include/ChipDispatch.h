@@ -0,0 +1,104 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "DetectOptions.h"
+#include "StageGraph.h"
+
+// 各型号检测结果的统一形式。各型号的 SD_Position / POINTPOSITIONINFO 同名不同义，
+// 不能放进同一个编译单元，所以每个型号各有一个适配文件（src/<型号>/ChipAdapter_*.cpp）。
+enum ChipKind {
+    CHIP_C5  = 0,
+    CHIP_4X  = 1,
+    CHIP_GMY = 2,
+    CHIP_PG  = 3,
+    CHIP_STD = 4,
+    CHIP_KIND_COUNT,
+    CHIP_AUTO = CHIP_KIND_COUNT   // 由 classifyChip 识别后再分派
+};
+
+struct ChipPoint {
+    int   wr = 0, wc = 0, pr = 0, pc = 0;
+    float x = 0.f, y = 0.f;       // 整帧坐标
+    bool  measured = true;        // std 区分实测 / 拟合，其余型号恒为实测
+};
+
+struct ChipResult {
+    int                    chip_index = -1;
+    cv::Rect               roi;
+    ChipKind               kind = CHIP_STD;
+    bool                   ok = false;
+    bool                   auto_kind = false;   // kind 由自动识别得到
+    float                  kind_margin = 0.f;   // 识别的区分度（次优 - 最优距离）
+    std::vector<ChipPoint> points;   // 只含 valid 点
+    int                    slots = 0;       // 位置数组总格数（孔数 x 孔内点数，含无效格）
+    // 位置数组形状：每行孔数可不同（C5 / 4X / GMY / PG 按检出的簇分行），孔内 point_rows x point_cols
+    std::vector<int>       wells_per_row;
+    int                    point_rows = 0, point_cols = 0;
+    SD_Report              report;          // report.anchors 已换算为整帧坐标
+};
+
+// PerformShapeDetection* 的参数。std 的参数是 OutputInterface_std.cpp 里的编译期常量，
+// 这里只登记 low_pct / high_pct / gamma_v 供阶段缓存做 key，其余项 std 不用。
+struct ChipParams {
+    double low_pct  = 0.0;
+    double high_pct = 0.0;
+    double gamma_v  = 1.0;
+    int    area_min = 6;
+    float  EPS       = 30.0f;
+    float  dy_thresh = 7.0f;
+    float  dx = 9.0f, dy = 9.0f, tol = 3.0f;
+    float  up_a = 0.f, down_b = 0.f, left_c = 0.f, right_d = 0.f;
+};
+
+const char* chipKindName(ChipKind k);
+bool parseChipKind(const char* s, ChipKind& k);
+
+// ShapeDetectionAPI_*.h 中的默认参数
+ChipParams  chipDefaultParams(ChipKind k);
+EnhanceMode chipEnhanceMode(ChipKind k);
+
+// 按名字读写 ChipParams：low_pct high_pct gamma area_min eps dy_thresh dx dy tol up_a down_b left_c right_d
+bool setChipParam(ChipParams& p, const std::string& name, double v);
+bool getChipParam(const ChipParams& p, const std::string& name, double& v);
+const std::vector<std::string>& chipParamNames();
+// 该型号的检测是否读这个参数：std 的参数全是编译期常量，一个都不读
+bool chipParamUsed(ChipKind k, const std::string& name);
+
+// roi16 可以是整帧上的 ROI 视图（不要求连续），结果坐标加上 offset 换回整帧
+bool detectChipC5 (const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out);
+bool detectChip4X (const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out);
+bool detectChipGMY(const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out);
+bool detectChipPG (const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out);
+bool detectChipStd(const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out);
+
+// SD_PositionArray 系列（[wr][wc][pr][pc]，x/y/valid）转成 ChipPoint，
+// 同时填 slots / 数组形状，并把 report.anchors 移到整帧坐标
+template <class PosArr>
+void collectChipPoints(const PosArr& arr, cv::Point offset, ChipResult& out)
+{
+    out.points.clear();
+    out.slots = 0;
+    out.wells_per_row.assign(arr.size(), 0);
+    out.point_rows = out.point_cols = 0;
+    for (int wr = 0; wr < (int)arr.size(); ++wr) {
+        out.wells_per_row[wr] = (int)arr[wr].size();
+        for (int wc = 0; wc < (int)arr[wr].size(); ++wc)
+        for (int pr = 0; pr < (int)arr[wr][wc].size(); ++pr) {
+            out.point_rows = std::max(out.point_rows, (int)arr[wr][wc].size());
+            out.point_cols = std::max(out.point_cols, (int)arr[wr][wc][pr].size());
+            for (int pc = 0; pc < (int)arr[wr][wc][pr].size(); ++pc) {
+                const auto& p = arr[wr][wc][pr][pc];
+                ++out.slots;
+                if (!p.valid) continue;
+                ChipPoint q;
+                q.wr = wr; q.wc = wc; q.pr = pr; q.pc = pc;
+                q.x = (float)(p.x + offset.x);
+                q.y = (float)(p.y + offset.y);
+                out.points.push_back(q);
+            }
+        }
+    }
+    for (auto& a : out.report.anchors) a += cv::Point2f(offset);
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include <vector>
+#include "DetectOptions.h"
 
 struct Cluster4X {
     int id;
@@ -11,9 +12,13 @@ struct Cluster4X {
     cv::Point2f              centroid;
 };
 
+// out_lowv/out_highv 传入 low < high 时作为预设拉伸区间直接使用（跳过直方图）；
+// 否则由 opts->percentile_tracker 或全图直方图求得。返回实际使用的区间。
 std::vector<Cluster4X> findClusters4X(const cv::Mat& src16,
                                       double low_pct, double high_pct, double gamma_v,
                                       int area_min, float EPS,
                                       double* out_otsu = nullptr,
                                       uint16_t* out_lowv = nullptr,
-                                      uint16_t* out_highv = nullptr);
+                                      uint16_t* out_highv = nullptr,
+                                      const SD_Options* opts = nullptr,
+                                      SD_Report* report = nullptr);
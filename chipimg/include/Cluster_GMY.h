@@ -2,6 +2,7 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <cstdint>
+#include "DetectOptions.h"
 
 struct ClusterGMY {
     int id;
@@ -12,8 +13,12 @@ struct ClusterGMY {
     cv::Point2f              centroid;
 };
 
+// out_lowv/out_highv 传入 low < high 时作为预设拉伸区间直接使用（跳过直方图）；
+// 否则由 opts->percentile_tracker 或全图直方图求得。返回实际使用的区间。
 std::vector<ClusterGMY> findClustersGMY(const cv::Mat& src16,
                                         double low_pct, double high_pct, double gamma_v,
                                         int area_min, float EPS, double* out_otsu = nullptr,
                                         uint16_t* out_lowv = nullptr,
-                                        uint16_t* out_highv = nullptr);
+                                        uint16_t* out_highv = nullptr,
+                                        const SD_Options* opts = nullptr,
+                                        SD_Report* report = nullptr);
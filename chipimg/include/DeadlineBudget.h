@@ -0,0 +1,192 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "LatticeModel.h"
+
+struct SD_Report;
+
+// 单帧时延预算：每个可降级阶段开始前，按本帧已用时间 + 本阶段及其后各阶段的历史耗时
+// （完整做法，EMA）预测是否超出预算，超出则本阶段改用便宜做法。
+// 越靠前的捷径对精度影响越小，所以从前往后逐级降级，每一级都重新看实际已用时间。
+enum DegradeShortcut {
+    DG_NONE               = 0,
+    DG_SAMPLED_PERCENTILE = 1 << 0,   // 子采样估计百分位，代替整帧直方图
+    DG_SKIP_CLAHE         = 1 << 1,   // 4X / GMY 跳过 CLAHE
+    DG_ROI_LABELLING      = 1 << 2,   // 只在上一帧芯片区域内二值化 + 连通域
+    DG_LATTICE_ANCHORS    = 1 << 3    // 用上一帧的晶格模型直接给锚点，不再逐簇求
+};
+
+enum DeadlineStage {
+    DL_PERCENTILE = 0,   // 整帧直方图求百分位
+    DL_CLAHE,
+    DL_LABEL,            // 拉伸 / gamma / Otsu / 连通域
+    DL_ANCHOR,
+    DL_TAIL,             // 其余不可降级的部分（聚类、网格、合并、组装输出），按总耗时减去各阶段求得
+    DL_STAGE_COUNT
+};
+
+// 同一芯片连续帧共用（非线程安全，与 PercentileTracker 相同）
+struct DeadlineState {
+    double       stage_ms[DL_STAGE_COUNT] = {0, 0, 0, 0, 0};   // 完整做法的耗时 EMA，0 = 尚未测到
+    cv::Rect     roi;                  // 上一帧簇的外接框（已加边距）
+    LatticeModel lattice;              // 上一帧的锚点晶格
+    cv::Point2f  anchor_offset;        // 锚点相对簇 bbox 中心的平均偏移，用于把簇对到晶格节点
+    long long    lattice_frame = -1;   // 拟合 lattice 时的 frames
+    bool         last_over_budget = false;
+    long long    frames = 0;
+    long long    degraded_frames = 0;
+    long long    over_budget_frames = 0;
+};
+
+struct DeadlineParams {
+    double         budget_ms  = 0.0;    // <= 0 不限时
+    DeadlineState* state      = nullptr;
+    double         ema_alpha  = 0.3;
+    int            roi_margin = 48;     // 像素
+    int            sample_stride = 4;   // DG_SAMPLED_PERCENTILE 的子采样步长
+    int            lattice_refit_frames = 30;   // 未开晶格修正时，备用晶格每隔多少帧重拟合
+};
+
+class DeadlineClock {
+public:
+    explicit DeadlineClock(const DeadlineParams& p);
+
+    double elapsedMs() const;
+    // 完整做法预计超出预算时返回 true（available 为 false 时不降级），并记下 shortcut
+    bool shouldDegrade(DeadlineStage s, int shortcut, bool available = true);
+    // 阶段实测耗时；cheap 为 true 时只计入已用，不更新该阶段的历史
+    void record(DeadlineStage s, double ms, bool cheap);
+
+    void setRoi(const cv::Rect& roi)                                    { roi_ = roi; }
+    void setLattice(const LatticeModel& m, const cv::Point2f& offset)   { lattice_ = m; offset_ = offset; has_lattice_ = true; }
+
+    // 上一帧的芯片区域，与本帧尺寸不符或已是整帧时为空
+    cv::Rect reusableRoi(const cv::Size& img_size) const;
+    // 备用晶格是否要重拟合：还没有、已隔 lattice_refit_frames 帧，或上一帧超了预算（下一帧多半要用它）
+    bool latticeStale() const;
+
+    const DeadlineParams& params() const { return p_; }
+    DeadlineState*        state() const  { return p_.state; }
+    int                   shortcuts() const { return shortcuts_; }
+
+    // 写回 state（阶段耗时、ROI、晶格），report 可为空
+    void finish(SD_Report* report);
+
+private:
+    typedef std::chrono::steady_clock clock;
+    DeadlineParams    p_;
+    clock::time_point t0_;
+    double            measured_[DL_STAGE_COUNT];
+    double            spent_ = 0.0;
+    int               shortcuts_ = DG_NONE;
+    cv::Rect          roi_;
+    LatticeModel      lattice_;
+    cv::Point2f       offset_;
+    bool              has_lattice_ = false;
+};
+
+// 在 scope 内计时，析构时记入 clock；clock 为空时什么都不做
+class DeadlineStep {
+public:
+    DeadlineStep(DeadlineClock* c, DeadlineStage s, int shortcut, bool available = true)
+        : c_(c), s_(s), cheap_(c && c->shouldDegrade(s, shortcut, available)),
+          t0_(std::chrono::steady_clock::now()) {}
+    ~DeadlineStep()
+    {
+        if (c_) c_->record(s_, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0_).count(), cheap_);
+    }
+    bool cheap() const { return cheap_; }
+
+private:
+    DeadlineStep(const DeadlineStep&) = delete;
+    DeadlineStep& operator=(const DeadlineStep&) = delete;
+    DeadlineClock*                        c_;
+    DeadlineStage                         s_;
+    bool                                  cheap_;
+    std::chrono::steady_clock::time_point t0_;
+};
+
+// "sampled_percentile+skip_clahe"；无捷径时为 "none"
+std::string degradeSummary(int shortcuts);
+
+template <class ClusterT>
+cv::Rect clustersBoundingRect(const std::vector<ClusterT>& clusters, int margin, const cv::Size& img_size)
+{
+    cv::Rect r;
+    for (const auto& cl : clusters) r = r.area() > 0 ? (r | cl.bbox) : cl.bbox;
+    if (r.area() <= 0) return cv::Rect();
+    r = cv::Rect(r.x - margin, r.y - margin, r.width + 2 * margin, r.height + 2 * margin);
+    return r & cv::Rect(0, 0, img_size.width, img_size.height);
+}
+
+// 锚点相对簇 bbox 中心的平均偏移（只看 exact 锚点）
+template <class AnchorT>
+cv::Point2f meanAnchorOffset(const std::vector<AnchorT>& anchors)
+{
+    cv::Point2f s(0.f, 0.f);
+    int n = 0;
+    for (const auto& a : anchors) {
+        if (!a.has_exact6 || !std::isfinite(a.anchor.x) || !std::isfinite(a.anchor.y)) continue;
+        s += a.anchor - (cv::Point2f((float)a.bbox.x, (float)a.bbox.y) +
+                         cv::Point2f(a.bbox.width * 0.5f, a.bbox.height * 0.5f));
+        ++n;
+    }
+    return n ? s * (1.0f / n) : s;
+}
+
+// 每个簇取 bbox 中心 + offset，解出最近的晶格节点 (r, c)，锚点取模型预测；has_exact6 一律为 false
+template <class ClusterT, class AnchorT>
+bool latticeAnchorsFromModel(const std::vector<ClusterT>& clusters, const LatticeModel& m,
+                             const cv::Point2f& offset, std::vector<AnchorT>& out)
+{
+    const float det = m.row_vec.x * m.col_vec.y - m.row_vec.y * m.col_vec.x;
+    if (!m.valid || std::fabs(det) < 1e-6f) return false;
+    out.clear();
+    out.reserve(clusters.size());
+    for (const auto& cl : clusters) {
+        const cv::Point2f q = cv::Point2f((float)cl.bbox.x + cl.bbox.width * 0.5f,
+                                          (float)cl.bbox.y + cl.bbox.height * 0.5f) + offset;
+        const cv::Point2f d = q - m.origin;
+        const float r = (d.x * m.col_vec.y - d.y * m.col_vec.x) / det;
+        const float c = (m.row_vec.x * d.y - m.row_vec.y * d.x) / det;
+        AnchorT ai;
+        ai.id = cl.id;
+        ai.row = cl.row;
+        ai.bbox = cl.bbox;
+        ai.anchor = m.predict((int)std::lround(r), (int)std::lround(c));
+        out.push_back(ai);
+    }
+    return true;
+}
+
+// 锚点阶段：限时且上一帧有晶格时直接用模型预测；否则 compute() 逐簇求，lattice 非空时再做晶格修正。
+// 带 state 时把本帧的晶格留给后续帧；未开晶格修正时另在副本上拟合，拟合要跑 RANSAC，只在 latticeStale() 时做
+template <class AnchorT, class ClusterT, class Compute>
+std::vector<AnchorT> computeAnchorsTimed(const std::vector<ClusterT>& clusters, Compute compute,
+                                         const LatticeParams* lattice, DeadlineClock* dl,
+                                         LatticeModel* out_model, int* out_replaced)
+{
+    std::vector<AnchorT> anchors;
+    const DeadlineState* st = dl ? dl->state() : nullptr;
+    DeadlineStep step(dl, DL_ANCHOR, DG_LATTICE_ANCHORS, st && st->lattice.valid);
+    if (step.cheap() && latticeAnchorsFromModel(clusters, st->lattice, st->anchor_offset, anchors))
+        return anchors;
+
+    anchors = compute();
+    if (lattice) {
+        LatticeModel lm;
+        const int n = applyLatticeAnchors(anchors, *lattice, &lm);
+        if (out_model)    *out_model = lm;
+        if (out_replaced) *out_replaced = n;
+        if (st) dl->setLattice(lm, meanAnchorOffset(anchors));
+    } else if (st && dl->latticeStale()) {
+        std::vector<AnchorT> tmp = anchors;
+        LatticeModel lm;
+        applyLatticeAnchors(tmp, LatticeParams{}, &lm);
+        dl->setLattice(lm, meanAnchorOffset(anchors));
+    }
+    return anchors;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 库内各阶段的中间图快照。未挂 sink 时每个发布点只是一次空指针判断，
+// 图像表达式在判断之后才求值；定义 CHIP_NO_DEBUG_SINK 编译时整段展开为空。
+//
+// 阶段名（findClusters* / std）：
+//   "stretch16"  百分位拉伸后（CV_16U）
+//   "gamma16"    gamma 后（CV_16U）
+//   "clahe16"    CLAHE 后（4X / GMY，CV_16U）
+//   "view8"      送进 Otsu 的 8 位图
+//   "bin8"       二值图
+// 只在逐像素的整帧路径上发布（分带 / 上游已给连通域时没有这些图）；
+// 限时模式走 ROI 连通域时（DG_ROI_LABELLING）快照只覆盖该 ROI
+class DebugSink {
+public:
+    virtual ~DebugSink() {}
+    // 不要的阶段返回 false，发布方跳过该图
+    virtual bool wants(const char* stage) const { (void)stage; return true; }
+    // img 只在回调期间有效，需要保留时 clone
+    virtual void publish(const char* stage, const cv::Mat& img) = 0;
+};
+
+#ifdef CHIP_NO_DEBUG_SINK
+#define CHIP_DEBUG_PUBLISH(sink, stage, img) ((void)(sink))
+#else
+#define CHIP_DEBUG_PUBLISH(sink, stage, img)                                  \
+    do {                                                                      \
+        DebugSink* chip_dbg_ = (sink);                                        \
+        if (chip_dbg_ && chip_dbg_->wants(stage)) chip_dbg_->publish((stage), (img)); \
+    } while (0)
+#endif
+
+// 收集快照（clone），同名后发布的覆盖先发布的；stages 非空时只收这些
+class DebugImageCollector : public DebugSink {
+public:
+    explicit DebugImageCollector(std::vector<std::string> stages = {});
+
+    bool wants(const char* stage) const override;
+    void publish(const char* stage, const cv::Mat& img) override;
+
+    // 没有该阶段时返回空 Mat
+    cv::Mat get(const std::string& stage) const;
+    std::vector<std::string> names() const;
+    void clear();
+
+private:
+    std::vector<std::string>       stages_;
+    mutable std::mutex             mtx_;
+    std::map<std::string, cv::Mat> images_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include "FrameQuality.h"
+#include "PercentileEstimator.h"
+#include "LocalRedetect.h"
+#include "LatticeModel.h"
+#include "RawFrameDecode.h"
+#include "StripedBlobs.h"
+#include "DeadlineBudget.h"
+#include "DebugSink.h"
+#include "DetectScratch.h"
+
+struct SD_Options {
+    bool               quality_gate = false;
+    FrameQualityParams quality;
+
+    uint16_t           preset_low_v  = 0;
+    uint16_t           preset_high_v = 0;
+    PercentileTracker* percentile_tracker = nullptr;
+    // src16 的 65536 桶直方图（见 RawFrameBuffer），非空时百分位直接从它取，不再扫整帧
+    const uint32_t*    histogram = nullptr;
+
+    LocalRedetectParams redetect;
+
+    LatticeParams      lattice;
+
+    // 上游已算好的连通域（见 StageGraph.h 的 FrameStages）：非空时跳过拉伸 / gamma / Otsu / 连通域。
+    // 须与 preset_low_v/high_v、gamma 及本型号的增强方式（是否 CLAHE）对应
+    const std::vector<BlobStat>* blobs = nullptr;
+    double             blobs_otsu = 0.0;
+
+    // 分带低内存模式（C5 / PG / std；4X、GMY 含 CLAHE，忽略此项）
+    StripeParams       stripe;
+
+    // 单帧时延预算（见 DeadlineBudget.h）；budget_ms <= 0 时不生效
+    DeadlineParams     deadline;
+    // 内部使用：PerformShapeDetection* 按 deadline 建立，findClusters* 据此选做法
+    DeadlineClock*     deadline_clock = nullptr;
+
+    // 中间图快照（见 DebugSink.h），空则不发布
+    DebugSink*         debug = nullptr;
+
+    // 中间图复用缓冲（见 DetectScratch.h），空则逐帧临时分配
+    DetectScratch*     scratch = nullptr;
+};
+
+struct SD_Report {
+    FrameQualityStats  quality;
+    bool               rejected = false;
+
+    PercentileEstimate percentile;
+
+    int                redetect_wells     = 0;
+    int                redetect_recovered = 0;
+
+    LatticeModel       lattice;
+    int                lattice_replaced = 0;
+
+    int                degrade = DG_NONE;    // DegradeShortcut 位或
+    double             elapsed_ms = 0.0;     // 仅在设置了 deadline 时统计
+    bool               over_budget = false;
+
+    // 本帧阈值与各阶段计数（见 ResultRecord.h）
+    double             otsu_th = 0.0;
+    uint16_t           low_v = 0, high_v = 0;
+    int                spots = 0;         // 连通域数
+    int                clusters = 0;
+    int                grid_keeps = 0;
+    std::vector<cv::Point2f> anchors;     // 每孔锚点，按 wr, wc 顺序，检测图坐标
+};
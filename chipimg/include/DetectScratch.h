@@ -0,0 +1,18 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// 前端中间图的复用缓冲（见 SD_Options::scratch）。同一路流逐帧传同一个实例，
+// 尺寸不变时 convertTo / threshold / connectedComponents 直接写进已有内存，不再逐帧分配整帧 CV_32F 等中间图。
+// 同一时刻只能给一次检测用：并行检测（拼板、多请求）各芯片不共用
+struct DetectScratch {
+    cv::Mat f32;                       // 拉伸 / gamma 的浮点中间图
+    cv::Mat stretched16, enhanced16, clahe16;
+    cv::Mat view8, bin8;
+    cv::Mat labels, stats, centroids;
+
+    std::vector<uint32_t> hist16;      // 分带模式下自己统计的直方图
+    std::vector<uint8_t>  lut;         // 分带模式的增强查找表
+    cv::Mat band_bin, band_labels;     // stripedBlobs16U 的单带缓冲
+};
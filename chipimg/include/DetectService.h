@@ -0,0 +1,129 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChipDispatch.h"
+
+// 常驻检测服务：作业进有界队列，由固定的工作线程池处理。每个工作线程按型号各持一份
+// 预热过的检测上下文（参数、结果缓冲），进程启动、OpenCV 初始化和首次分配只在启动时付一次。
+//
+// 请求为一行文本：<id> <profile> <source>
+//   profile：型号名（C5 4X GMY PG std auto），可带参数覆盖，如 4X,dx=9.5,tol=4
+//   source ：图像路径（.png / .chrf 第 0 帧），或 shm:<name>:<w>x<h>[:<stride>[:<offset>]]
+//            表示 POSIX 共享内存对象里的一帧 Mono16
+// 另有两条命令：stats（返回队列深度与时延统计）、quit。
+// 应答为一行 JSON：检测结果同 formatChipResult（frame 为作业 id），另加 status / wait_ms / run_ms。
+//
+// 另一种接法是共享内存帧环（runRingService，环协议见 ShmRing.h）：采集进程把帧写进帧环的槽，
+// 工作线程直接认领槽、就地检测，结果编码后投进结果环，全程没有文件读写和跨进程拷贝。
+
+struct ServiceParams {
+    int  workers   = 0;       // 0 = hardware_concurrency
+    int  max_queue = 64;      // 排队上限
+    bool block_when_full = false;   // true：submit 阻塞直到有空位（管道输入）；false：立即拒绝（socket）
+    bool warm_up   = true;    // 启动时每个工作线程对每个型号跑一遍空白帧
+    int  latency_window = 1024;     // 时延分位数统计的最近作业数
+};
+
+struct ServiceJob {
+    long long   id = 0;
+    ChipKind    kind = CHIP_STD;
+    ChipParams  params;
+    bool        custom_params = false;   // 否则用该型号默认参数
+    std::string source;
+    // 在工作线程上调用，line 含结尾换行
+    std::function<void(const std::string& line)> reply;
+    std::chrono::steady_clock::time_point enqueued;
+};
+
+struct ServiceStats {
+    long long submitted = 0;
+    long long completed = 0;
+    long long failed    = 0;     // 读图失败或未检出
+    long long rejected  = 0;     // 队列满被拒
+    int       queue_depth = 0;
+    int       max_queue_depth = 0;
+    int       busy_workers = 0;
+    int       workers = 0;
+    // 最近 latency_window 个作业：排队 + 处理的总时延
+    double    latency_mean_ms = 0, latency_p50_ms = 0, latency_p95_ms = 0, latency_p99_ms = 0;
+    double    wait_mean_ms = 0;  // 其中排队部分
+};
+
+// "4X" 或 "4X,dx=9.5,tol=4"
+bool parseChipProfile(const std::string& s, ChipKind& kind, ChipParams& params, bool& custom);
+
+enum ServiceCommand {
+    SC_JOB = 0,
+    SC_STATS,
+    SC_QUIT,
+    SC_INVALID
+};
+
+// 解析一行请求；SC_INVALID 时 err 给出原因（job.id 能解析出来时也填上）
+ServiceCommand parseServiceRequest(const std::string& line, ServiceJob& job, std::string& err);
+
+// source 为路径或 shm: 描述，结果是只读的 CV_16UC1（shm 时为映射区视图，keep 负责持有映射）
+cv::Mat loadServiceFrame(const std::string& source, std::shared_ptr<void>& keep, std::string& err);
+
+void formatServiceStats(std::string& out, const ServiceStats& s);
+void formatServiceError(std::string& out, long long id, const char* status, const std::string& msg);
+
+struct RingServiceParams {
+    std::string frame_ring;          // 由采集端创建；未就绪时按 open_wait_ms 重试
+    std::string result_ring;
+    int  workers = 0;                // 0 = hardware_concurrency
+    bool warm_up = true;
+    int  open_wait_ms   = 10000;
+    int  result_wait_ms = 100;       // 结果环满时最多等这么久，之后丢弃该结果
+};
+
+struct RingServiceStats {
+    long long frames   = 0;
+    long long failed   = 0;          // 帧头非法或未检出
+    long long dropped  = 0;          // 结果环满或记录超过槽大小
+    double    run_mean_ms = 0;
+};
+
+// 阻塞运行直到 stop 置位（或环打不开，返回 false）
+bool runRingService(const RingServiceParams& p, const std::atomic<bool>& stop, RingServiceStats* stats = nullptr);
+
+class DetectService {
+public:
+    explicit DetectService(const ServiceParams& p = ServiceParams());
+    ~DetectService();   // 处理完已排队的作业再退出
+    DetectService(const DetectService&) = delete;
+    DetectService& operator=(const DetectService&) = delete;
+
+    // 队列满且 block_when_full=false 时返回 false（调用方回 busy），作业不执行
+    bool submit(ServiceJob job);
+    // 等队列清空、所有作业完成
+    void drain();
+    ServiceStats stats() const;
+
+private:
+    void run();
+    void finishJob(double total_ms, double wait_ms, bool ok);
+
+    ServiceParams              p_;
+    mutable std::mutex         mtx_;
+    std::condition_variable    cv_;         // 有作业 / 停止
+    std::condition_variable    space_cv_;   // 有空位
+    std::condition_variable    idle_cv_;
+    std::deque<ServiceJob>     queue_;
+    bool                       stop_ = false;
+    int                        busy_ = 0;
+    ServiceStats               st_;
+    std::vector<double>        lat_ring_;    // 最近作业的总时延 / 排队时延
+    std::vector<double>        wait_ring_;
+    size_t                     lat_count_ = 0;
+    std::vector<std::thread>   threads_;
+};
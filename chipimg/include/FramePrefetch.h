@@ -0,0 +1,76 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 同尺寸帧缓冲池：acquire 得到的 shared_ptr 释放时缓冲回池，批量处理时不再反复分配整帧
+class FrameBufferPool {
+public:
+    explicit FrameBufferPool(size_t max_cached = 8);
+    std::shared_ptr<cv::Mat> acquire(int rows, int cols, int type);
+    size_t cached() const;
+
+private:
+    struct State {
+        std::mutex           mtx;
+        std::vector<cv::Mat> free;
+        size_t               max_cached = 8;
+    };
+    std::shared_ptr<State> st_;
+};
+
+// 按行带解码 16 位灰度 PNG（libpng 逐行读），每解完 band_rows 行回调一次 on_band(row0, rows)，
+// 调用方可以在整张图解完之前就开始处理已就绪的行。dst16 尺寸类型不符时重新分配。
+// 非 16 位灰度、隔行扫描或未启用 libpng 时返回 false，调用方退回 imread。
+bool decodePng16Bands(const std::string& path, cv::Mat& dst16, int band_rows,
+                      const std::function<void(int row0, int rows)>& on_band = nullptr);
+
+struct PrefetchParams {
+    int  workers        = 2;
+    int  max_ahead      = 4;      // 解码最多领先消费方多少帧（同时也是缓冲池大小）
+    int  band_rows      = 256;
+    bool with_histogram = false;  // 解码时逐行带累加 65536 桶直方图，交给 SD_Options::histogram
+};
+
+struct PrefetchedFrame {
+    int                      index = -1;
+    std::string              path;
+    std::shared_ptr<cv::Mat> img;        // CV_16UC1；失败时为空
+    std::vector<uint32_t>    hist;       // with_histogram 时有效
+    double                   decode_ms = 0.0;
+};
+
+// 后台线程池按顺序预解码一批文件，next() 按提交顺序交付，解码与检测重叠
+class FramePrefetcher {
+public:
+    FramePrefetcher(std::vector<std::string> paths, const PrefetchParams& p = PrefetchParams());
+    ~FramePrefetcher();
+    FramePrefetcher(const FramePrefetcher&) = delete;
+    FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+    // 取下一帧（阻塞等待）；全部取完返回 false
+    bool next(PrefetchedFrame& out);
+    int  size() const { return (int)paths_.size(); }
+
+private:
+    void worker();
+    void decodeOne(int idx, PrefetchedFrame& f);
+
+    std::vector<std::string>       paths_;
+    PrefetchParams                 p_;
+    FrameBufferPool                pool_;
+    std::mutex                     mtx_;
+    std::condition_variable        cv_;
+    std::map<int, PrefetchedFrame> ready_;
+    int                            next_issue_ = 0;
+    int                            next_take_  = 0;
+    bool                           stop_ = false;
+    std::vector<std::thread>       threads_;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+enum FrameQualityFail {
+    FQ_OK             = 0,
+    FQ_SATURATED      = 1 << 0,
+    FQ_LOW_RANGE      = 1 << 1,
+    FQ_OUT_OF_FOCUS   = 1 << 2,
+    FQ_FG_MISMATCH    = 1 << 3
+};
+
+struct FrameQualityParams {
+    int    saturation_level   = 65535;
+    double max_saturated_frac = 0.01;
+
+    int    min_dynamic_range  = 256;
+
+    int    focus_step         = 4;
+    double min_focus          = 0.0;
+
+    double fg_level           = 0.5;
+    double expected_fg_frac   = -1.0;
+    double fg_frac_tol        = 0.05;
+
+    bool   reject             = true;
+};
+
+struct FrameQualityStats {
+    double saturated_frac = 0.0;
+    int    dynamic_range  = 0;
+    double focus_var      = 0.0;
+    double focus_score    = 0.0;
+    double fg_frac        = 0.0;
+    int    fail_mask      = FQ_OK;
+    bool   rejected       = false;
+};
+
+void findPercentile16UWithQuality(const cv::Mat& img16,
+                                  double low_pct, double high_pct, double gamma_v,
+                                  const FrameQualityParams& qp,
+                                  uint16_t& low_v, uint16_t& high_v,
+                                  FrameQualityStats& qs);
+
+// hist 为整帧 65536 级直方图（SD_Options::histogram、分带统计或解码时顺带算好的）；
+// 百分位、饱和、动态范围、前景比例都由它得到，只在 focus_step 子采样网格上读像素算清晰度。
+// hist 为空时同上一个重载
+void findPercentile16UWithQuality(const cv::Mat& img16, const uint32_t* hist,
+                                  double low_pct, double high_pct, double gamma_v,
+                                  const FrameQualityParams& qp,
+                                  uint16_t& low_v, uint16_t& high_v,
+                                  FrameQualityStats& qs);
@@ -0,0 +1,69 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <vector>
+#include <cfloat>
+
+// 各芯片孔内点阵的布局：行列数与相对锚点的偏移在编译期确定，间距 dx/dy 仍由调用方传入
+template <int R, int C, int OffX, int OffY>
+struct GridLayout {
+    static constexpr int   rows  = R;
+    static constexpr int   cols  = C;
+    static constexpr int   size  = R * C;
+    static constexpr float off_x = (float)OffX;
+    static constexpr float off_y = (float)OffY;
+};
+
+using GridLayoutC5  = GridLayout<6, 6, -23, -43>;
+using GridLayout4X  = GridLayout<5, 6, -23,   0>;
+using GridLayoutGMY = GridLayout<8, 8, -25, -49>;
+using GridLayoutPG  = GridLayout<3, 6, -25, -38>;
+
+template <class L>
+using GridPoints = std::array<cv::Point2f, L::size>;
+
+// 行主序：grid[i*cols + j] = anchor + off + (j*dx, i*dy)
+template <class L>
+inline void genGridFixed(const cv::Point2f& anchor, float dx, float dy, GridPoints<L>& out)
+{
+    const float base_x = anchor.x + L::off_x;
+    const float base_y = anchor.y + L::off_y;
+    for (int i = 0; i < L::rows; ++i)
+        for (int j = 0; j < L::cols; ++j)
+            out[i * L::cols + j] = cv::Point2f(base_x + j * dx, base_y + i * dy);
+}
+
+// 每个格点在 pts 中的最近点（距离相同取下标最小者，与逐格点扫描一致）。
+// 外层遍历 pts、内层遍历定长格点，内层可展开/向量化
+template <class L>
+inline void nearestToGridFixed(const GridPoints<L>& grid, const std::vector<cv::Point2f>& pts,
+                               std::array<int, L::size>& best_k,
+                               std::array<float, L::size>& best_d2)
+{
+    best_k.fill(-1);
+    best_d2.fill(FLT_MAX);
+    for (int k = 0; k < (int)pts.size(); ++k) {
+        const float px = pts[k].x, py = pts[k].y;
+        for (int g = 0; g < L::size; ++g) {
+            const float dx_ = px - grid[g].x;
+            const float dy_ = py - grid[g].y;
+            const float d2 = dx_*dx_ + dy_*dy_;
+            if (d2 < best_d2[g]) { best_d2[g] = d2; best_k[g] = k; }
+        }
+    }
+}
+
+// 格点 g 与 pts 中任一点距离 <= sqrt(tol2) 时 near[g] = 1
+template <class L>
+inline void nearSignalFixed(const GridPoints<L>& grid, const std::vector<cv::Point2f>& pts,
+                            float tol2, std::array<char, L::size>& near)
+{
+    near.fill(0);
+    for (const auto& sp : pts) {
+        for (int g = 0; g < L::size; ++g) {
+            const float dx_ = grid[g].x - sp.x;
+            const float dy_ = grid[g].y - sp.y;
+            near[g] |= (char)(dx_*dx_ + dy_*dy_ <= tol2);
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+
+struct LatticeParams {
+    bool     enable        = false;
+    int      ransac_iters  = 64;
+    float    inlier_tol    = 6.0f;   // 像素，锚点到模型预测的距离
+    float    huber_delta   = 2.0f;   // IRLS 中 Huber 权重的拐点
+    int      irls_iters    = 4;
+    int      min_inliers   = 4;
+    bool     snap_outliers = true;   // exact 锚点若为离群点也改用模型预测
+    unsigned seed          = 12345u;
+};
+
+// anchor(r, c) = origin + r * row_vec + c * col_vec
+struct LatticeModel {
+    cv::Point2f origin  = {0.f, 0.f};
+    cv::Point2f row_vec = {0.f, 0.f};
+    cv::Point2f col_vec = {0.f, 0.f};
+    bool  valid   = false;
+    int   samples = 0;
+    int   inliers = 0;
+    float rms     = 0.f;
+
+    cv::Point2f predict(int r, int c) const {
+        return origin + row_vec * (float)r + col_vec * (float)c;
+    }
+    float dx() const { return std::sqrt(col_vec.dot(col_vec)); }   // 孔间距（列方向）
+    float dy() const { return std::sqrt(row_vec.dot(row_vec)); }   // 孔间距（行方向）
+    // 给定行号，把点投影到列方向上，取最近的整数列
+    int nearestCol(int r, const cv::Point2f& p) const;
+};
+
+struct LatticeSample {
+    int row = 0;
+    int col = 0;
+    cv::Point2f p;
+};
+
+// 先 RANSAC（3 点精确解）选内点，再在内点上做 Huber IRLS；inlier_mask 与 samples 一一对应
+bool fitLatticeModel(const std::vector<LatticeSample>& samples, const LatticeParams& p,
+                     LatticeModel& out, std::vector<char>* inlier_mask = nullptr);
+
+// 按模型预测的锚点生成搜索窗口（与 anchorWindowRect 的上下左右约定一致），供 ROI / 跟踪模式使用
+cv::Rect latticeWellWindow(const LatticeModel& m, int r, int c,
+                           float up_a, float down_b, float left_c, float right_d,
+                           const cv::Size& img_size);
+
+// 用整片芯片的晶格模型重建各孔锚点：非 exact 的锚点（以及 snap_outliers 时 exact 的离群点）替换为模型预测。
+// 列号先取行内 bbox 中心 x 的名次，粗拟合后再按投影取整重新编号，缺孔不会让后面的列整体错位。
+// 返回被替换的锚点数；模型不可用时不改动 infos
+template <class AnchorT>
+int applyLatticeAnchors(std::vector<AnchorT>& infos, const LatticeParams& p,
+                        LatticeModel* out_model = nullptr)
+{
+    const int N = (int)infos.size();
+    std::vector<int> col(N, 0);
+    std::map<int, std::vector<int>> row2idx;
+    for (int i = 0; i < N; ++i) row2idx[infos[i].row].push_back(i);
+    for (auto& kv : row2idx) {
+        auto& v = kv.second;
+        std::sort(v.begin(), v.end(), [&](int a, int b){
+            return infos[a].bbox.x * 2 + infos[a].bbox.width < infos[b].bbox.x * 2 + infos[b].bbox.width;
+        });
+        for (int k = 0; k < (int)v.size(); ++k) col[v[k]] = k;
+    }
+
+    auto finite = [](const cv::Point2f& q){ return std::isfinite(q.x) && std::isfinite(q.y); };
+    std::vector<LatticeSample> samples;
+    std::vector<int> sample_of(N, -1);
+    auto build = [&]{
+        samples.clear();
+        for (int i = 0; i < N; ++i) {
+            sample_of[i] = -1;
+            if (!infos[i].has_exact6 || !finite(infos[i].anchor)) continue;
+            sample_of[i] = (int)samples.size();
+            samples.push_back(LatticeSample{infos[i].row, col[i], infos[i].anchor});
+        }
+    };
+
+    LatticeModel m;
+    std::vector<char> inl;
+    build();
+    bool ok = fitLatticeModel(samples, p, m, &inl);
+    if (ok) {
+        // 行内名次在缺孔时会错位，row_vec 可能混入整数倍的 col_vec：先约化成最短的行向量，
+        // 再按投影重新编号（最小列号平移到 0）
+        const float n2 = m.col_vec.dot(m.col_vec);
+        if (n2 > 1e-12f) {
+            const float k = std::round(m.row_vec.dot(m.col_vec) / n2);
+            m.row_vec -= m.col_vec * k;
+        }
+        std::vector<int> nc(N, 0);
+        int cmin = 0; bool first = true;
+        for (int i = 0; i < N; ++i) {
+            if (!finite(infos[i].anchor)) continue;
+            nc[i] = m.nearestCol(infos[i].row, infos[i].anchor);
+            if (first || nc[i] < cmin) { cmin = nc[i]; first = false; }
+        }
+        bool changed = false;
+        for (int i = 0; i < N; ++i) {
+            if (!finite(infos[i].anchor)) continue;
+            if (nc[i] - cmin != col[i]) { col[i] = nc[i] - cmin; changed = true; }
+        }
+        if (changed) {
+            build();
+            ok = fitLatticeModel(samples, p, m, &inl);
+        }
+    }
+    if (out_model) *out_model = m;
+    if (!ok) return 0;
+
+    int replaced = 0;
+    for (int i = 0; i < N; ++i) {
+        const int s = sample_of[i];
+        if (s >= 0 && (inl[s] || !p.snap_outliers)) continue;
+        infos[i].anchor = m.predict(infos[i].row, col[i]);
+        ++replaced;
+    }
+    return replaced;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+enum LocalRedetectMethod {
+    LRD_OTSU       = 0,
+    LRD_PERCENTILE = 1
+};
+
+struct LocalRedetectParams {
+    bool   enable       = false;
+    int    method       = LRD_OTSU;
+    double fg_pct       = 0.08;
+    int    min_contrast = 32;
+    int    area_min     = 3;
+    int    area_max     = 0;
+    float  dedup_r      = 3.0f;
+};
+
+cv::Rect anchorWindowRect(const cv::Point2f& anchor,
+                          float up_a, float down_b, float left_c, float right_d,
+                          const cv::Size& img_size);
+
+// 只在 win 内对原始 16 位图做局部 Otsu / 百分位阈值，返回与 existing 距离 > dedup_r 的新斑点中心
+std::vector<cv::Point2f> redetectSpotsInWindow(const cv::Mat& src16, const cv::Rect& win,
+                                               const LocalRedetectParams& p,
+                                               const std::vector<cv::Point2f>& existing);
+
+template <class PlaneT, class GridT>
+int mergeRedetectedPoints(PlaneT& plane, const GridT& grid, int cols,
+                          const std::vector<cv::Point2f>& extra, float tol)
+{
+    int recovered = 0;
+    const float tol2 = tol * tol;
+    std::vector<char> used(extra.size(), 0);
+    for (int i = 0; i < (int)plane.size(); ++i) {
+        for (int j = 0; j < (int)plane[i].size(); ++j) {
+            auto& pos = plane[i][j];
+            if (pos.valid) continue;
+            const cv::Point2f& g = grid[i * cols + j];
+            int best_k = -1; float best_d2 = tol2;
+            for (int k = 0; k < (int)extra.size(); ++k) {
+                if (used[k]) continue;
+                const float dx_ = extra[k].x - g.x;
+                const float dy_ = extra[k].y - g.y;
+                const float d2 = dx_*dx_ + dy_*dy_;
+                if (d2 <= best_d2) { best_d2 = d2; best_k = k; }
+            }
+            if (best_k < 0) continue;
+            used[best_k] = 1;
+            pos.x = cvRound(extra[best_k].x);
+            pos.y = cvRound(extra[best_k].y);
+            pos.valid = 1;
+            ++recovered;
+        }
+    }
+    return recovered;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "ChipDispatch.h"
+#include "StageGraph.h"
+
+struct DetectRequest {
+    ChipKind   kind = CHIP_STD;
+    ChipParams params;
+};
+
+inline DetectRequest defaultRequest(ChipKind k) { return DetectRequest{ k, chipDefaultParams(k) }; }
+
+// 同一帧上一次跑多组（型号, 参数）。直方图、百分位、增强 + Otsu + 连通域作为阶段按参数缓存，
+// 参数相同的请求共用一份结果；各请求在 workers 个线程上并发（0 = hardware_concurrency）。
+// 结果与 reqs 一一对应。CHIP_AUTO 的请求先识别型号再用该型号默认参数。
+std::vector<ChipResult> detectMulti(FrameStages& stages, const std::vector<DetectRequest>& reqs,
+                                    int workers = 0, const SD_Options* opts = nullptr);
+
+std::vector<ChipResult> detectMulti(const cv::Mat& src16, const std::vector<DetectRequest>& reqs,
+                                    int workers = 0, const SD_Options* opts = nullptr);
@@ -0,0 +1,145 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ChipDispatch.h"
+
+// 字符位图缓存：可打印 ASCII 逐字先 putText 成掩码，画标签时只做掩码拷贝，
+// 不再每个点 cv::format + 抗锯齿 putText
+class GlyphCache {
+public:
+    explicit GlyphCache(double font_scale = 0.38, int thickness = 1);
+    // org 为基线左端，同 putText；超出画布的部分裁掉
+    void draw(cv::Mat& bgr, cv::Point org, const char* text, const cv::Scalar& color) const;
+    void draw(cv::Mat& bgr, cv::Point org, const std::string& text, const cv::Scalar& color) const
+    {
+        draw(bgr, org, text.c_str(), color);
+    }
+    int height() const { return ascent_; }
+
+private:
+    struct Glyph {
+        cv::Mat mask;      // CV_8UC1，非零处着色
+        int     top = 0;   // 掩码顶端相对基线的偏移（向上为负）
+        int     advance = 0;
+    };
+    Glyph glyphs_[95];
+    int   ascent_ = 0;
+};
+
+// 各阶段 drawKeptGridPoints* 等共用（font_scale 0.38）
+const GlyphCache& overlayGlyphs();
+
+// 与型号无关的叠加图内容，坐标为整帧像素
+struct OverlayScene {
+    std::vector<cv::Rect>    boxes;      // 簇 / 芯片外接框
+    std::vector<cv::Point2f> spots;      // 连通域中心
+    std::vector<cv::Point2f> anchors;
+    std::vector<cv::Rect>    windows;    // 合并窗口
+    std::vector<cv::Point2f> grid;       // 网格保留点
+    std::vector<cv::Point2f> merged;     // 最终实测点
+    std::vector<cv::Point2f> fitted;     // 拟合补出的点（std）
+    std::vector<std::pair<cv::Point2f, std::string>> labels;
+    std::string caption;                 // 左上角一行
+};
+
+// 由流水线中间结果填（main_*.cpp 的画法）
+template <class ClusterT, class AnchorT, class KeepT, class MergedT>
+void fillOverlayScene(OverlayScene& s,
+                      const std::vector<ClusterT>& clusters, const std::vector<AnchorT>& anchors,
+                      const std::vector<KeepT>& keeps, const std::vector<MergedT>& merged,
+                      float up_a, float down_b, float left_c, float right_d)
+{
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        s.boxes.push_back(clusters[i].bbox);
+        s.spots.insert(s.spots.end(), clusters[i].points.begin(), clusters[i].points.end());
+        if (i >= anchors.size()) continue;
+        const cv::Point2f a = anchors[i].anchor;
+        if (!std::isfinite(a.x) || !std::isfinite(a.y)) continue;
+        s.anchors.push_back(a);
+        s.windows.push_back(cv::Rect(cv::Point(cvRound(a.x - left_c), cvRound(a.y - up_a)),
+                                     cv::Point(cvRound(a.x + right_d), cvRound(a.y + down_b))));
+    }
+    for (const auto& g : keeps) s.grid.push_back(g.pt);
+    for (const auto& mc : merged) s.merged.insert(s.merged.end(), mc.points.begin(), mc.points.end());
+}
+
+// 由统一结果填：芯片 ROI 框、实测 / 拟合点，每孔第一个点旁标 "wr,wc"
+void fillOverlayScene(OverlayScene& s, const ChipResult& r, bool well_labels = true);
+
+// base8 为整帧 8 位灰度（或已按 scale 缩好的图，见 preview_ready）；输出 BGR，尺寸 = 整帧 * scale。
+// 只用 LINE_8，点半径不随 scale 缩小到 1 像素以下
+void renderOverlay(const cv::Mat& base8, double scale, bool preview_ready,
+                   const OverlayScene& scene, const GlyphCache& glyphs, cv::Mat& out_bgr);
+
+// 哪些帧出叠加图：QA 标记的帧、前 first_n 帧、每 every_n 帧一张
+struct OverlaySampling {
+    int  every_n = 0;
+    int  first_n = 0;
+    bool on_qa   = true;
+};
+
+struct OverlayParams {
+    double          scale = 0.5;        // 预览分辨率（相对整帧）
+    OverlaySampling sampling;
+    int             max_queue = 4;      // 排队超过此数时丢弃新提交，不阻塞检测线程
+    std::string     out_dir = ".";
+    std::string     prefix  = "overlay";
+    // 非空时交给 sink（在渲染线程上调用），否则写 out_dir/prefix_<index>.png
+    std::function<void(long long index, const cv::Mat& bgr)> sink;
+};
+
+// 后台线程渲染：检测线程只做抽样判断和一次缩小 + 转 8 位（只对选中的帧），画图与写盘都在渲染线程
+class OverlayRenderer {
+public:
+    explicit OverlayRenderer(const OverlayParams& p = OverlayParams());
+    ~OverlayRenderer();
+    OverlayRenderer(const OverlayRenderer&) = delete;
+    OverlayRenderer& operator=(const OverlayRenderer&) = delete;
+
+    bool wants(long long index, bool qa_flag) const;
+    // 未选中或队列满时返回 false；src 提交后即可复用。
+    // src 为 CV_16UC1 原始帧（按 1/256 转 8 位），或已增强好的 CV_8UC1 底图
+    bool submit(long long index, const cv::Mat& src, OverlayScene scene, bool qa_flag = false);
+    // base8 已是按 scale 缩好的 CV_8UC1 底图：不再缩放，与渲染线程共享不复制，提交后不能再改
+    bool submitPreview(long long index, const cv::Mat& base8, OverlayScene scene, bool qa_flag = false);
+    // 等队列清空
+    void flush();
+
+    long long rendered() const { return rendered_; }
+    long long dropped() const  { return dropped_; }
+    long long failed() const   { return failed_; }   // 渲染、sink 或写盘失败的张数
+
+private:
+    struct Job {
+        long long    index = 0;
+        cv::Mat      base8;   // 已按 scale 缩好
+        OverlayScene scene;
+    };
+    bool enqueue(long long index, const cv::Mat& base8, OverlayScene scene);
+    void worker();
+
+    OverlayParams           p_;
+    GlyphCache              glyphs_;
+    std::mutex              mtx_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Job>         queue_;
+    bool                    busy_ = false;
+    bool                    stop_ = false;
+    std::atomic<long long>  rendered_{0};
+    std::atomic<long long>  dropped_{0};
+    std::atomic<long long>  failed_{0};
+    std::thread             thread_;
+};
+
+// 单帧查看工具（main_*.cpp）用：各 scene 依次画在同一底图上（预览分辨率，渲染在 OverlayRenderer 线程），
+// 结果与 scenes 一一对应。base 同 OverlayRenderer::submit
+std::vector<cv::Mat> renderPreviews(const cv::Mat& base, const std::vector<OverlayScene>& scenes,
+                                    double scale = OverlayParams().scale);
@@ -0,0 +1,45 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "ChipDispatch.h"
+#include "PanelSegment.h"
+
+struct PanelDetectParams {
+    PanelSegmentParams segment;
+    int                workers = 0;   // 0 = hardware_concurrency
+};
+
+// 按型号分派单芯片检测；kind 为 CHIP_AUTO 时先 classifyChip 识别型号，只跑识别出的那一条流水线。
+// 该型号未编进来时返回 false
+bool detectChip(ChipKind kind, const cv::Mat& roi16, cv::Point offset,
+                const SD_Options* opts, ChipResult& out);
+// prm 为空时用 chipDefaultParams(kind)。CHIP_AUTO 用识别出的型号的默认值，prm 非空时返回 false（不悄悄丢掉）；
+// 识别和所选流水线共用一份直方图，流水线的连通域也由同一份阶段缓存给出
+bool detectChip(ChipKind kind, const cv::Mat& roi16, cv::Point offset,
+                const ChipParams* prm, const SD_Options* opts, ChipResult& out);
+
+// 常驻工作线程（DetectService、AsyncDetector）私有的检测上下文：每个型号（含 auto）一份选项、结果缓冲
+// 与中间图缓冲，逐帧状态和缓冲在同一线程的作业之间复用
+struct ChipWorkerContext {
+    struct Kind {
+        SD_Options    opts;
+        ChipResult    result;
+        DetectScratch scratch;   // opts.scratch 指向它，所以不可复制
+
+        Kind() { opts.scratch = &scratch; }
+        Kind(const Kind&) = delete;
+        Kind& operator=(const Kind&) = delete;
+    };
+    Kind kinds[CHIP_KIND_COUNT + 1];
+
+    Kind& operator[](ChipKind k) { return kinds[k]; }
+    // 每个型号跑一遍空白帧，OpenCV 初始化和首次分配在启动时付掉
+    void warmUp();
+};
+
+// 拼板：分割出芯片 ROI 后并行检测，结果下标即芯片编号（先行后列）。
+// 各 ROI 是整帧上的视图，不复制像素。opts 中整帧相关的字段（histogram、percentile_tracker）
+// 对单个芯片不成立，传给各芯片前会被清掉。
+std::vector<ChipResult> detectPanel(const cv::Mat& src16, ChipKind kind,
+                                    const PanelDetectParams& p = PanelDetectParams(),
+                                    const SD_Options* opts = nullptr);
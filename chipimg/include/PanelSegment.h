@@ -0,0 +1,22 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// 多芯片拼板：在粗网格上找亮斑聚集区，每个聚集区的外接矩形（外扩 margin）即一个芯片 ROI
+struct PanelSegmentParams {
+    int    cell      = 32;      // 粗网格边长（像素）
+    double fg_pct    = 0.03;    // 最亮 fg_pct 的像素视为斑点
+    int    sample    = 4;       // 统计格子命中时的采样步长
+    int    min_hits  = 2;       // 格子内采样命中数下限
+    int    merge_gap = 4;       // 间隔不超过此格数的聚集区并为同一芯片（须小于芯片间缝隙）
+    int    margin    = 32;
+    int    min_w     = 128;
+    int    min_h     = 128;
+    double row_tol   = 0.5;     // 排序时 y 中心差 < row_tol * 高度视为同一排
+};
+
+// 返回芯片数；chips 按先行后列排序，下标即芯片编号。
+// hist16 为整帧 65536 桶直方图（可空，空时这里统计一遍），整帧只读不复制。
+int segmentPanel(const cv::Mat& src16, const PanelSegmentParams& p,
+                 std::vector<cv::Rect>& chips, const uint32_t* hist16 = nullptr);
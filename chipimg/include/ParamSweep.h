@@ -0,0 +1,32 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "ChipDispatch.h"
+#include "ResultScore.h"
+
+// 参数扫描：在多张图上按网格或随机搜索评估 ChipParams，按 BatchScore 排序。
+// 每张图一个 FrameStages：直方图只算一次，连通域按（拉伸区间, gamma）只算一次，
+// 只有下游的聚类 / 锚点 / 网格 / 合并随参数重跑。
+struct SweepRange {
+    std::string name;              // 见 setChipParam
+    double      lo = 0, hi = 0, step = 0;   // step <= 0 时只取 lo
+};
+
+struct SweepSpec {
+    ChipKind                kind = CHIP_C5;
+    ChipParams              base;           // 未扫描的参数取这里
+    std::vector<SweepRange> ranges;
+    int                     random = 0;     // 0 = 全网格；> 0 = 在网格里随机抽这么多组
+    unsigned                seed = 1;
+    int                     workers = 0;    // 0 = hardware_concurrency
+};
+
+struct SweepEntry {
+    ChipParams params;
+    BatchScore score;
+};
+
+// 按得分从高到低返回全部参数组
+std::vector<SweepEntry> runSweep(const std::vector<cv::Mat>& frames, const SweepSpec& spec,
+                                 const SD_Options* opts = nullptr);
@@ -0,0 +1,55 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+struct PercentileSampleParams {
+    int    stride    = 4;
+    double confidence = 0.99;
+    double ema_alpha = 0.25;
+    double drift_tol = 0.03;
+    int    max_skip  = 100;
+};
+
+struct PercentileEstimate {
+    uint16_t low_v    = 0;
+    uint16_t high_v   = 65535;
+    uint16_t err_low  = 0;
+    uint16_t err_high = 0;
+    long long samples = 0;
+    bool     exact    = false;
+};
+
+void computePercentile16U(const cv::Mat& img16, double low_pct, double high_pct,
+                          uint16_t& low_v, uint16_t& high_v);
+
+// hist 为 65536 桶直方图（如解包时顺带统计的），total 为像素数；约定同 computePercentile16U
+void percentileFromHistogram16U(const uint32_t* hist, long long total,
+                                double low_pct, double high_pct,
+                                uint16_t& low_v, uint16_t& high_v);
+
+PercentileEstimate estimatePercentile16USampled(const cv::Mat& img16,
+                                                double low_pct, double high_pct,
+                                                int stride = 4, double confidence = 0.99);
+
+// 同一芯片连续帧共用一个 tracker（非线程安全）：平时只做子采样估计并做 EMA 平滑，
+// 估计值偏离超过 drift_tol*(high-low)+误差界，或连续 max_skip 帧未校准时才做全图直方图。
+class PercentileTracker {
+public:
+    explicit PercentileTracker(const PercentileSampleParams& params = PercentileSampleParams());
+
+    PercentileEstimate update(const cv::Mat& img16, double low_pct, double high_pct);
+    void reset();
+
+    bool primed() const { return primed_; }
+    long long frames() const { return frames_; }
+    long long exactFrames() const { return exact_frames_; }
+
+private:
+    PercentileSampleParams params_;
+    bool      primed_ = false;
+    double    ema_low_ = 0.0, ema_high_ = 65535.0;
+    double    last_low_pct_ = -1.0, last_high_pct_ = -1.0;
+    int       since_exact_ = 0;
+    long long frames_ = 0;
+    long long exact_frames_ = 0;
+};
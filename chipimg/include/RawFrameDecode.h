@@ -0,0 +1,40 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// 相机原始像素格式（GenICam 命名）
+enum RawPixelFormat {
+    RPF_MONO16        = 0,   // 16 位小端
+    RPF_MONO12_PACKED = 1,   // 2 像素 / 3 字节：b0=p0[11:4], b1=p0[3:0]|p1[3:0]<<4, b2=p1[11:4]
+    RPF_MONO10        = 2,   // 10 位有效值放在 16 位小端容器里
+    RPF_MONO10_PACKED = 3    // 2 像素 / 3 字节：b0=p0[9:2], b1=p0[1:0]|p1[1:0]<<4, b2=p1[9:2]
+};
+
+struct RawFrameView {
+    const uint8_t* data   = nullptr;
+    int            width  = 0;
+    int            height = 0;
+    size_t         stride = 0;      // 每行字节数，0 表示紧密排列
+    int            format = RPF_MONO16;
+};
+
+size_t rawFrameMinStride(int width, int format);
+int    rawFrameBitDepth(int format);
+
+// 解包成 CV_16UC1（dst16 尺寸/类型不符时重新分配，否则复用），同一遍里累加 65536 桶直方图：
+// hist 非空时先清零，之后可直接交给 percentileFromHistogram16U / SD_Options::histogram，省掉再读一遍整帧。
+// msb_align 为 true 时左移到 16 位满量程（12 位 <<4，10 位 <<6），直方图统计的是移位后的值。
+bool unpackRawFrame16U(const RawFrameView& in, cv::Mat& dst16,
+                       uint32_t* hist = nullptr, bool msb_align = false);
+
+// 跨帧复用的解包缓冲区与直方图；unpack 之后把 hist.data() 填到 SD_Options::histogram
+struct RawFrameBuffer {
+    cv::Mat               frame16;
+    std::vector<uint32_t> hist = std::vector<uint32_t>(65536, 0u);
+
+    bool unpack(const RawFrameView& in, bool msb_align = false) {
+        return unpackRawFrame16U(in, frame16, hist.data(), msb_align);
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "RawFrameDecode.h"
+
+// 未压缩多帧容器（.chrf），小端：
+//   文件头 64 字节：magic "CHRF" | u16 version | u16 header_size | 保留
+//   每帧：帧头 64 字节 | meta（UTF-8 文本，如源文件名） | 补齐到 64 | 像素数据 stride*height | 补齐到 64
+//   帧头：magic "FRM1" | u32 header_size | i32 width | i32 height | u32 stride | u32 format(RawPixelFormat)
+//         | u32 meta_len | u32 保留 | u64 data_len | i64 timestamp_us | 保留
+// 帧数不写在文件头里，可以一直追加；读端打开时扫一遍帧头建索引。
+static constexpr uint16_t kRawStoreVersion = 1;
+
+class RawFrameWriter {
+public:
+    RawFrameWriter() = default;
+    ~RawFrameWriter() { close(); }
+    RawFrameWriter(const RawFrameWriter&) = delete;
+    RawFrameWriter& operator=(const RawFrameWriter&) = delete;
+
+    // append=true 且文件已存在时在末尾继续写（文件头需合法；不完整的尾帧先截掉）
+    bool open(const std::string& path, bool append = false);
+    bool append(const cv::Mat& img16, const std::string& meta = std::string(), int64_t timestamp_us = 0);
+    bool appendRaw(const RawFrameView& frame, const std::string& meta = std::string(), int64_t timestamp_us = 0);
+    void close();
+
+    bool isOpen() const { return fp_ != nullptr; }
+    int  frames() const { return frames_; }
+
+private:
+    std::FILE* fp_ = nullptr;
+    int        frames_ = 0;
+};
+
+struct RawFrameEntry {
+    RawFrameView view;           // data 指向映射区，reader 关闭后失效
+    std::string  meta;
+    int64_t      timestamp_us = 0;
+};
+
+// POSIX 下用 mmap 只读映射整个文件，帧数据零拷贝；Windows 下退化为整文件读入
+class RawFrameReader {
+public:
+    RawFrameReader() = default;
+    ~RawFrameReader() { close(); }
+    RawFrameReader(const RawFrameReader&) = delete;
+    RawFrameReader& operator=(const RawFrameReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    int size() const { return (int)frames_.size(); }
+    const RawFrameEntry& entry(int i) const { return frames_[i]; }
+
+    // Mono16 帧直接包一层 CV_16UC1 Mat（不拷贝、只读）；打包格式返回空 Mat
+    cv::Mat mat16(int i) const;
+    // 任意格式解包到 dst，hist 非空时顺带统计直方图
+    bool decode16(int i, cv::Mat& dst, uint32_t* hist = nullptr) const;
+
+private:
+    const uint8_t*             base_ = nullptr;
+    size_t                     bytes_ = 0;
+    bool                       mapped_ = false;
+    std::vector<uint8_t>       owned_;
+    std::vector<RawFrameEntry> frames_;
+};
+
+// path 以 .chrf 结尾时从容器读第 index 帧（Mono16 零拷贝，需要 reader 存活），否则 imread
+cv::Mat loadFrame16(const std::string& path, RawFrameReader& reader, int index = 0);
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ChipDispatch.h"
+#include "TextWriter.h"
+
+// 检测结果的紧凑二进制记录（.chrr），小端，每个芯片结果一条，可一直追加：
+//   文件头 16 字节：magic "CHRR" | u16 version | u16 header_size | 保留
+//   每条记录：记录头（header_size 字节，见 ResultRecord.cpp） | u16 wells_per_row[well_rows]
+//            | 锚点 i32 x,y [anchor_count] | valid 位图 | measured 位图 | 有效点 i32 x,y [popcount(valid)]
+//   坐标相对芯片 ROI 左上角，1/4 像素，有符号（ROI 左上方的点也能存），INT32_MIN 表示无。
+//   版本 1 的记录坐标为 u16（0xFFFF 表示无），读端按记录头的 version 区分
+// 记录头首字段为整条记录的字节数。新版本只在记录头末尾、记录末尾追加字段，
+// 读端按 header_size / record_size 跳过不认识的部分；写到一半的尾记录读端忽略，追加打开时截掉。
+static constexpr uint16_t kResultRecordVersion = 2;
+
+struct ResultRecord {
+    uint64_t   frame_id = 0;
+    int64_t    timestamp_us = 0;
+    ChipResult chip;    // points 只含有效点；阈值、锚点与计数在 chip.report
+};
+
+// 编码追加到 out 末尾 / 从 data 解码一条（len 为该条的字节数）
+void encodeResultRecord(const ChipResult& r, uint64_t frame_id, int64_t timestamp_us,
+                        std::vector<uint8_t>& out);
+bool decodeResultRecord(const uint8_t* data, size_t len, ResultRecord& rec);
+
+class ResultRecordWriter {
+public:
+    ResultRecordWriter() = default;
+    ~ResultRecordWriter() { close(); }
+    ResultRecordWriter(const ResultRecordWriter&) = delete;
+    ResultRecordWriter& operator=(const ResultRecordWriter&) = delete;
+
+    // append=true 且文件已存在时在末尾继续写（文件头需合法；不完整的尾记录先截掉）
+    bool open(const std::string& path, bool append = false);
+    // 先攒在内存里，超过 flush_bytes 才落盘
+    bool append(const ChipResult& r, uint64_t frame_id, int64_t timestamp_us = 0);
+    bool append(const std::vector<ChipResult>& rs, uint64_t frame_id, int64_t timestamp_us = 0);
+    bool flush();
+    void close();
+
+    bool      isOpen() const  { return fp_ != nullptr; }
+    long long records() const { return records_; }
+    size_t    flush_bytes = 64 * 1024;
+
+private:
+    std::FILE*           fp_ = nullptr;
+    std::vector<uint8_t> buf_;
+    long long            records_ = 0;
+};
+
+// 顺序读，不整文件载入
+class ResultRecordReader {
+public:
+    ResultRecordReader() = default;
+    ~ResultRecordReader() { close(); }
+    ResultRecordReader(const ResultRecordReader&) = delete;
+    ResultRecordReader& operator=(const ResultRecordReader&) = delete;
+
+    bool open(const std::string& path);
+    // 到文件尾或遇到截断 / 损坏的记录时返回 false
+    bool next(ResultRecord& rec);
+    void close();
+
+    uint16_t version() const { return version_; }
+
+    // 单条记录的上限，超过按损坏处理
+    static constexpr uint32_t kMaxRecordBytes = 64u << 20;
+
+private:
+    std::FILE*           fp_ = nullptr;
+    uint16_t             version_ = 0;
+    long long            end_ = 0;      // 已知的文件长度
+    std::vector<uint8_t> buf_;
+};
+
+// CSV：逐格一行（含无效格，无效格 x/y 留空），或逐芯片一行的汇总
+void writeResultCsvHeader(TextBuffer& tb);
+void writeResultCsv(TextBuffer& tb, const ResultRecord& rec);
+void writeResultSummaryCsvHeader(TextBuffer& tb);
+void writeResultSummaryCsv(TextBuffer& tb, const ResultRecord& rec);
@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include "ChipDispatch.h"
+
+// 位置数组的完整度 / 一致性打分，供参数扫描排序
+struct ResultScore {
+    int    wells = 0;
+    float  completeness = 0.f;   // 有效点 / 总格数
+    float  regularity   = 0.f;   // 1 - 孔内相邻点横纵间距的变异系数（截到 [0,1]）
+    float  score        = 0.f;   // completeness * regularity
+};
+
+ResultScore scoreChipResult(const ChipResult& r);
+
+// 多张图的汇总：各图得分均值，再乘以孔数等于众数的图所占比例（同批芯片孔数应一致）
+struct BatchScore {
+    float score = 0.f;
+    float completeness = 0.f;
+    float regularity = 0.f;
+    float well_consistency = 0.f;
+    int   modal_wells = 0;
+};
+
+BatchScore scoreBatch(const std::vector<ResultScore>& per_image);
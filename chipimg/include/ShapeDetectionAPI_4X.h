@@ -25,7 +25,10 @@ void PerformShapeDetection(
     float dx = 9.5f, float dy = 9.5f, float tol = 5.0f,
     float up_a = 5.0f, float down_b = 48.0f, float left_c = 28.0f, float right_d = 28.0f,
 
-    SD_PositionArray* out_arr = nullptr
+    SD_PositionArray* out_arr = nullptr,
+
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr
 );
 
 void PrintPositionArray(const SD_PositionArray& arr);
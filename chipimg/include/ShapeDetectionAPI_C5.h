@@ -25,7 +25,10 @@ void PerformShapeDetectionC5(
     float dx = 9.0f, float dy = 9.0f, float tol = 3.0f,
     float up_a = 48.0f, float down_b = 5.0f, float left_c = 27.0f, float right_d = 26.0f,
 
-    SD_PositionArray* out_arr = nullptr
+    SD_PositionArray* out_arr = nullptr,
+
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr
 );
 
 void PrintPositionArrayC5(const SD_PositionArray& arr);
@@ -25,7 +25,10 @@ void PerformShapeDetectionPG(
     float dx = 10.0f, float dy = 19.0f, float tol = 4.0f,
     float up_a = 50.0f, float down_b = 5.0f, float left_c = 28.0f, float right_d = 28.0f,
 
-    SD_PositionArray_PG* out_arr = nullptr
+    SD_PositionArray_PG* out_arr = nullptr,
+
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr
 );
 
 void PrintPositionArrayPG(const SD_PositionArray_PG& arr);
@@ -0,0 +1,85 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ResultRecord.h"
+
+struct ShmRingHeader;
+struct ShmSlotMeta;
+
+// POSIX 共享内存环形缓冲（跨进程、多生产者 / 多消费者），按槽就地读写，不拷贝：
+//   写端 beginWrite 认领一个空槽 -> 直接往 slot.data 写 -> commitWrite 发布
+//   读端 beginRead 认领最早发布的槽 -> 就地处理 -> endRead 归还
+// 槽的认领用每槽序号（有界 MPMC 队列的做法），两个进程共享的信号量只用来睡眠等待。
+// 共享对象布局：头（magic "CHSR"、槽数、槽大小、读写位置、信号量） | 各槽 [64 字节元数据 | 负载]。
+// 某个进程在持有槽时崩溃会让环停在该槽，需重建。
+static constexpr uint16_t kShmRingVersion = 1;
+
+class ShmRing {
+public:
+    struct Slot {
+        uint8_t*     data = nullptr;   // 负载起点（64 对齐）
+        size_t       capacity = 0;
+        size_t       bytes = 0;        // 读端：写端发布的字节数
+        uint64_t     pos = 0;
+        ShmSlotMeta* meta = nullptr;
+    };
+
+    ShmRing() = default;
+    ~ShmRing() { close(); }
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // 新建（已存在的同名对象先删掉）。通常由采集端建帧环和结果环
+    bool create(const std::string& name, uint32_t slots, size_t slot_bytes);
+    // 映射已建好的环；对方尚未初始化完成时返回 false，可稍后重试
+    bool open(const std::string& name);
+    void close();
+    static bool remove(const std::string& name);
+
+    bool isOpen() const { return hdr_ != nullptr; }
+    uint32_t slots() const;
+    size_t   slotBytes() const;
+    // 累计认领写入 / 读出的槽数
+    uint64_t writePos() const;
+    uint64_t readPos() const;
+
+    // timeout_ms < 0 一直等，0 不等；超时同时覆盖等空位 / 数据和等前面的槽被乱序归还 / 发布
+    bool beginWrite(Slot& s, int timeout_ms = 0);
+    void commitWrite(Slot& s, size_t bytes);
+    bool beginRead(Slot& s, int timeout_ms = -1);
+    void endRead(Slot& s);
+
+private:
+    ShmRingHeader* hdr_ = nullptr;
+    size_t         map_bytes_ = 0;
+    std::string    name_;
+};
+
+// 帧环的槽：64 字节帧头 + Mono16 像素（stride 为行字节数）
+struct ShmFrameHeader {
+    uint64_t frame_id;
+    int64_t  timestamp_us;    // shmNowUs()，同机各进程可比
+    int32_t  width;
+    int32_t  height;
+    uint32_t stride;
+    int32_t  kind;            // ChipKind，含 CHIP_AUTO
+    uint8_t  reserved[32];
+};
+static_assert(sizeof(ShmFrameHeader) == 64, "ShmFrameHeader must be 64 bytes");
+
+int64_t shmNowUs();
+// 能放下 max_w x max_h 帧的槽大小
+size_t  shmFrameSlotBytes(int max_w, int max_h);
+inline ShmFrameHeader* shmFrameHeader(const ShmRing::Slot& s) { return reinterpret_cast<ShmFrameHeader*>(s.data); }
+inline uint16_t*       shmFramePixels(const ShmRing::Slot& s) { return reinterpret_cast<uint16_t*>(s.data + sizeof(ShmFrameHeader)); }
+// 按帧头把槽内像素包成 Mat（不拷贝）；帧头与槽大小不符时返回空
+cv::Mat shmFrameMat(const ShmRing::Slot& s);
+// 写端：把 img16 拷进槽并填帧头（模拟相机 / 测试用；真实采集端可直接往 shmFramePixels 里写）
+bool shmPutFrame(ShmRing::Slot& s, const cv::Mat& img16, uint64_t frame_id, int64_t timestamp_us, int kind);
+
+// 结果环：每槽一条 ResultRecord 编码（见 ResultRecord.h）。scratch 供编码复用
+bool postShmResult(ShmRing& ring, const ChipResult& r, uint64_t frame_id, int64_t timestamp_us,
+                   std::vector<uint8_t>& scratch, int timeout_ms = 0);
+bool takeShmResult(ShmRing& ring, ResultRecord& rec, int timeout_ms = -1);
@@ -0,0 +1,132 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "StripedBlobs.h"
+
+// 阶段结果缓存：key 由阶段名 + 输入参数拼成，同一 key 只算一次。
+// 多个线程同时请求同一 key 时，后到者等先到者算完直接取结果，不重复计算。
+class StageCache {
+public:
+    template <class T>
+    std::shared_ptr<const T> get(const std::string& key, const std::function<T()>& compute)
+    {
+        std::promise<std::shared_ptr<const void>> mine;
+        std::shared_future<std::shared_ptr<const void>> fut;
+        bool owner = false;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            auto it = map_.find(key);
+            if (it != map_.end()) {
+                fut = it->second;
+                hits_++;
+            } else {
+                fut = mine.get_future().share();
+                map_.emplace(key, fut);
+                owner = true;
+                misses_++;
+            }
+        }
+        if (owner) {
+            try {
+                mine.set_value(std::make_shared<const T>(compute()));
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> lk(mtx_);
+                    map_.erase(key);
+                }
+                mine.set_exception(std::current_exception());
+            }
+        }
+        return std::static_pointer_cast<const T>(fut.get());
+    }
+
+    void   clear();
+    // 丢掉 key 以 prefix 开头的条目（已取走的结果不受影响），返回丢掉的个数
+    size_t erasePrefix(const std::string& prefix);
+    size_t size() const;
+    long long hits() const   { return hits_; }
+    long long misses() const { return misses_; }
+
+private:
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const void>>> map_;
+    std::atomic<long long> hits_{0}, misses_{0};
+};
+
+// 拼 key：stageKey("blobs", a, b, gamma) -> "blobs|a|b|gamma"；浮点按十六进制写，保证同值同 key
+inline void stageKeyAppend(std::ostringstream&) {}
+template <class T, class... Rest>
+inline void stageKeyAppend(std::ostringstream& os, const T& v, const Rest&... rest)
+{
+    os << '|' << v;
+    stageKeyAppend(os, rest...);
+}
+template <class... Args>
+inline std::string stageKey(const char* stage, const Args&... args)
+{
+    std::ostringstream os;
+    os << std::hexfloat << stage;
+    stageKeyAppend(os, args...);
+    return os.str();
+}
+
+// 在 workers 个线程上跑 fn(0..n-1)；互相独立的分支并发执行，共享阶段靠 StageCache 去重
+void runParallel(int n, int workers, const std::function<void(int)>& fn);
+
+// ---------------- 检测前端的公共阶段 ----------------
+// 直方图 -> 百分位 -> 增强 + Otsu + 连通域，各型号在这一段只差参数和是否 CLAHE
+
+enum EnhanceMode {
+    ENH_PLAIN = 0,   // stretch + gamma（C5 / PG / std）
+    ENH_CLAHE = 1    // stretch + gamma + CLAHE(2.0, 8x8)（4X / GMY）
+};
+
+struct PercentilePair {
+    uint16_t low_v = 0, high_v = 65535;
+};
+
+struct BlobSet {
+    uint16_t              low_v = 0, high_v = 65535;
+    double                otsu = 0.0;
+    std::vector<BlobStat> blobs;   // 未按面积过滤，area_min / area_max 由下游各自筛
+};
+
+// 增强 + 阈值 + 连通域。th < 0 用 Otsu（乘 otsu_scale），否则固定阈值。
+// band_rows > 0 且 mode 为 ENH_PLAIN 时走分带查找表路径（见 StripedBlobs.h）
+void computeBlobSet(const cv::Mat& src16, uint16_t low_v, uint16_t high_v, double gamma,
+                    EnhanceMode mode, double th, double otsu_scale, int band_rows,
+                    const uint32_t* hist16, BlobSet& out);
+
+// 单帧的阶段图：每个方法是一个阶段，按参数缓存。帧数据需在对象存活期间保持不变。
+// hist16 非空时为调用方已有的整帧直方图（如 SD_Options::histogram），直方图阶段直接取它
+class FrameStages {
+public:
+    explicit FrameStages(const cv::Mat& src16, std::shared_ptr<StageCache> cache = nullptr,
+                         int band_rows = 0, const uint32_t* hist16 = nullptr);
+
+    const cv::Mat& frame() const { return src16_; }
+    StageCache&     cache() { return *cache_; }
+
+    std::shared_ptr<const std::vector<uint32_t>> histogram();
+    std::shared_ptr<const PercentilePair>        percentiles(double low_pct, double high_pct);
+    std::shared_ptr<const BlobSet>               blobs(double low_pct, double high_pct, double gamma,
+                                                       EnhanceMode mode, double th = -1.0,
+                                                       double otsu_scale = 1.0);
+    // 丢掉该（拉伸区间, gamma）下各模式 / 阈值的连通域结果；参数扫描换到下一组上游参数时调用
+    void releaseBlobs(double low_pct, double high_pct, double gamma);
+
+private:
+    cv::Mat                     src16_;
+    std::shared_ptr<StageCache> cache_;
+    int                         band_rows_ = 0;
+    const uint32_t*             hist16_ = nullptr;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+// std 芯片的前端参数：编译期常量，OutputInterface_std.cpp 与 chipDefaultParams 共用这一份
+constexpr double kStdLowPct  = 0.0046;
+constexpr double kStdHighPct = 0.0087;
+constexpr double kStdGamma   = 1.33;
+constexpr int    kStdAreaMin = 100;
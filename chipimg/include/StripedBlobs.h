@@ -0,0 +1,38 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// 低内存分带模式：拉伸 / gamma / 转 8 位都是逐像素映射，折成一张 65536 项查找表；
+// Otsu 阈值由 16 位直方图经查找表换算出的 256 桶直方图求出；连通域按水平带逐带求，
+// 跨带缝的分量用并查集合并。常驻内存只有一个带的二值图和标签图，不再有整帧 CV_32F 中间图。
+// 带之间不需要重叠：带内只做逐像素运算，缝两侧只比较相邻两行的标签。
+// 4X / GMY 含 CLAHE（依赖整帧分块），不走此模式。
+struct StripeParams {
+    bool enable    = false;
+    int  band_rows = 256;
+};
+
+struct BlobStat {
+    int         area = 0;
+    cv::Rect    bbox;
+    cv::Point2f centroid;
+};
+
+// 把 [row0, row0+rows) 行累加进 65536 桶直方图（调用方负责清零）
+void accumulateHistogram16U(const cv::Mat& src16, int row0, int rows, uint32_t* hist);
+
+// 16 位原始值 -> stretch16U(a,b) + gamma16U(gamma) + convertTo(CV_8U, 1/256) 的结果
+void buildEnhanceLut8(uint16_t a, uint16_t b, float gamma, std::vector<uint8_t>& lut);
+
+// 与 OpenCV THRESH_OTSU 相同的判据
+double otsuThreshold8(const uint64_t* hist256);
+
+// 分带求 8 连通前景分量（像素值 > th 为前景）。th < 0 时用 Otsu 阈值乘 otsu_scale（截到 [0,255]）。
+// hist16 为 src16 的直方图，仅 Otsu 时需要。分量按光栅序首像素排序，同 connectedComponentsWithStats。
+// scratch 非空时单带的二值图与标签图复用其中的缓冲
+struct DetectScratch;
+bool stripedBlobs16U(const cv::Mat& src16, const std::vector<uint8_t>& lut,
+                     const uint32_t* hist16, double th, double otsu_scale,
+                     int band_rows, std::vector<BlobStat>& out, double* out_th = nullptr,
+                     DetectScratch* scratch = nullptr);
@@ -0,0 +1,185 @@
+#pragma once
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ChipDispatch.h"
+
+// 文本结果输出：先格式化进可复用的大缓冲区（整数 / 定点小数自己转，不经 iostream），
+// 再整块写出。多线程批处理时每个线程用自己的 TextBuffer，整块交给 TextResultWriter。
+class TextBuffer {
+public:
+    explicit TextBuffer(size_t reserve = 64 * 1024) { buf_.reserve(reserve); }
+
+    TextBuffer& put(char c) { buf_.push_back(c); return *this; }
+    TextBuffer& put(const char* s);
+    TextBuffer& put(const char* s, size_t n) { buf_.insert(buf_.end(), s, s + n); return *this; }
+    TextBuffer& put(const std::string& s)    { return put(s.data(), s.size()); }
+    TextBuffer& putInt(long long v);
+    // 四舍五入到 decimals 位，去掉末尾的 0；非有限值写 nan_text
+    TextBuffer& putFixed(double v, int decimals = 2, const char* nan_text = "nan");
+
+    const char* data() const { return buf_.data(); }
+    size_t      size() const { return buf_.size(); }
+    bool        empty() const { return buf_.empty(); }
+    void        clear() { buf_.clear(); }   // 保留容量
+    void        truncate(size_t n) { if (n < buf_.size()) buf_.resize(n); }
+    bool        writeTo(std::FILE* fp) const;
+
+private:
+    std::vector<char> buf_;
+};
+
+class TextResultWriter {
+public:
+    TextResultWriter() = default;
+    ~TextResultWriter() { close(); }
+    TextResultWriter(const TextResultWriter&) = delete;
+    TextResultWriter& operator=(const TextResultWriter&) = delete;
+
+    bool open(const std::string& path, bool append = false);
+    // 如 stdout，不负责关闭
+    void attach(std::FILE* fp);
+    // 线程安全；同一块内容不会与其他线程的交错。攒够 chunk_bytes 才 fwrite
+    bool write(const TextBuffer& tb);
+    bool flush();
+    void close();
+
+    bool   isOpen() const { return fp_ != nullptr; }
+    size_t chunk_bytes = 1 << 20;
+
+private:
+    bool flushLocked();
+
+    std::mutex        mtx_;
+    std::FILE*        fp_ = nullptr;
+    bool              owned_ = false;
+    std::vector<char> pending_;
+};
+
+// TF_TEXT 为 main_* 原来的控制台格式；TF_JSON 每帧一行（JSON Lines）
+enum TextFormat {
+    TF_TEXT = 0,
+    TF_CSV,
+    TF_JSON
+};
+
+bool parseTextFormat(const char* s, TextFormat& f);
+
+// CSV 表头
+void putPositionCsvHeader(TextBuffer& tb);   // frame,wr,wc,pr,pc,x,y,valid
+void putBoxCsvHeader(TextBuffer& tb);        // frame,i,x0,y0,x1,y1
+void putCircleCsvHeader(TextBuffer& tb);     // frame,i,x,y,r
+void putChipCsvHeader(TextBuffer& tb);       // frame,chip,kind,wr,wc,pr,pc,x,y,measured
+
+// SD_PositionArray 系列（[wr][wc][pr][pc]，int x/y/valid）
+template <class PosArr>
+void formatPositionArray(TextBuffer& tb, TextFormat f, const PosArr& arr,
+                         long long frame = 0, const char* title = "PostionArray")
+{
+    const int WR = (int)arr.size();
+    if (f == TF_TEXT) {
+        tb.put(title).put(" WellRow=").putInt(WR).put('\n');
+        for (int wr = 0; wr < WR; ++wr) {
+            const int WC = (int)arr[wr].size();
+            tb.put(" Row ").putInt(wr).put(" (WellCol=").putInt(WC).put(")\n");
+            for (int wc = 0; wc < WC; ++wc) {
+                tb.put("  Well(").putInt(wr).put(',').putInt(wc).put("):\n");
+                for (const auto& prow : arr[wr][wc]) {
+                    tb.put("   ");
+                    for (const auto& p : prow) {
+                        if (p.valid) tb.put('(').putInt(p.x).put(',').putInt(p.y).put(") ");
+                        else         tb.put("[--] ", 5);
+                    }
+                    tb.put('\n');
+                }
+            }
+        }
+    } else if (f == TF_CSV) {
+        for (int wr = 0; wr < WR; ++wr)
+        for (int wc = 0; wc < (int)arr[wr].size(); ++wc)
+        for (int pr = 0; pr < (int)arr[wr][wc].size(); ++pr)
+        for (int pc = 0; pc < (int)arr[wr][wc][pr].size(); ++pc) {
+            const auto& p = arr[wr][wc][pr][pc];
+            tb.putInt(frame).put(',').putInt(wr).put(',').putInt(wc).put(',').putInt(pr).put(',').putInt(pc)
+              .put(',').putInt(p.x).put(',').putInt(p.y).put(',').put(p.valid ? '1' : '0').put('\n');
+        }
+    } else {
+        // {"frame":F,"rows":[[well:[[x,y,valid],...] 按 pr, pc 展开], ...]}
+        tb.put("{\"frame\":").putInt(frame).put(",\"rows\":[");
+        for (int wr = 0; wr < WR; ++wr) {
+            tb.put(wr ? ",[" : "[");
+            for (int wc = 0; wc < (int)arr[wr].size(); ++wc) {
+                tb.put(wc ? ",[" : "[");
+                bool first = true;
+                for (const auto& prow : arr[wr][wc])
+                    for (const auto& p : prow) {
+                        tb.put(first ? "[" : ",[").putInt(p.x).put(',').putInt(p.y).put(',')
+                          .put(p.valid ? '1' : '0').put(']');
+                        first = false;
+                    }
+                tb.put(']');
+            }
+            tb.put(']');
+        }
+        tb.put("]}\n");
+    }
+}
+
+// POINTPOSITIONINFO_BOX（各型号同形：x0 y0 x1 y1）
+template <class BoxT>
+void formatBoxes(TextBuffer& tb, TextFormat f, const std::vector<BoxT>& boxes, long long frame = 0)
+{
+    if (f == TF_TEXT) {
+        tb.put("BOX count: ").putInt((long long)boxes.size()).put('\n');
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const auto& a = boxes[i];
+            tb.putInt((long long)i).put(") x0=").putInt(a.x0).put(", y0=").putInt(a.y0)
+              .put(", x1=").putInt(a.x1).put(", y1=").putInt(a.y1).put('\n');
+        }
+    } else if (f == TF_CSV) {
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const auto& a = boxes[i];
+            tb.putInt(frame).put(',').putInt((long long)i).put(',').putInt(a.x0).put(',').putInt(a.y0)
+              .put(',').putInt(a.x1).put(',').putInt(a.y1).put('\n');
+        }
+    } else {
+        tb.put("{\"frame\":").putInt(frame).put(",\"boxes\":[");
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const auto& a = boxes[i];
+            tb.put(i ? ",[" : "[").putInt(a.x0).put(',').putInt(a.y0).put(',')
+              .putInt(a.x1).put(',').putInt(a.y1).put(']');
+        }
+        tb.put("]}\n");
+    }
+}
+
+// POINTPOSITIONINFO_CIRCLE（ix0 iy0 ir）
+template <class CircleT>
+void formatCircles(TextBuffer& tb, TextFormat f, const std::vector<CircleT>& circles, long long frame = 0)
+{
+    if (f == TF_TEXT) {
+        tb.put("CIRCLE count: ").putInt((long long)circles.size()).put('\n');
+        for (size_t i = 0; i < circles.size(); ++i) {
+            const auto& a = circles[i];
+            tb.putInt((long long)i).put(") ix0=").putInt(a.ix0).put(", iy0=").putInt(a.iy0)
+              .put(", ir=").putInt(a.ir).put('\n');
+        }
+    } else if (f == TF_CSV) {
+        for (size_t i = 0; i < circles.size(); ++i) {
+            const auto& a = circles[i];
+            tb.putInt(frame).put(',').putInt((long long)i).put(',').putInt(a.ix0).put(',')
+              .putInt(a.iy0).put(',').putInt(a.ir).put('\n');
+        }
+    } else {
+        tb.put("{\"frame\":").putInt(frame).put(",\"circles\":[");
+        for (size_t i = 0; i < circles.size(); ++i) {
+            const auto& a = circles[i];
+            tb.put(i ? ",[" : "[").putInt(a.ix0).put(',').putInt(a.iy0).put(',').putInt(a.ir).put(']');
+        }
+        tb.put("]}\n");
+    }
+}
+
+// 统一结果（拼板 / 多型号）；TF_TEXT 同 panel 的控制台输出
+void formatChipResult(TextBuffer& tb, TextFormat f, const ChipResult& r, long long frame = 0);
@@ -0,0 +1,140 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ChipDispatch.h"
+#include "LatticeModel.h"
+#include "StageGraph.h"
+
+// 交互调参：参数变化时只从受影响的阶段往下重算。
+//   low_pct / high_pct / gamma -> 增强 + 连通域（FrameStages 缓存，来回拖动不重算）
+//   area_min / EPS             -> 聚类
+//   dy_thresh                  -> 锚点
+//   dx / dy / tol              -> 网格生成与筛选
+//   up_a / down_b / left_c / right_d -> mergeAndFilterClusterPoints
+enum TuneStage {
+    TS_BLOBS = 0,
+    TS_CLUSTERS,
+    TS_ANCHORS,
+    TS_GRIDS,
+    TS_MERGE,
+    TS_DONE
+};
+
+TuneStage firstDirtyStage(const ChipParams& a, const ChipParams& b);
+
+class TunePipeline {
+public:
+    virtual ~TunePipeline() {}
+    // from 之前的阶段沿用上次结果
+    virtual void update(const ChipParams& p, TuneStage from) = 0;
+    virtual void draw(cv::Mat& canvas, const ChipParams& p) const = 0;
+    virtual int  mergedPoints() const = 0;
+
+    double stage_ms[TS_DONE] = {0, 0, 0, 0, 0};
+};
+
+// V 提供各型号的类型与阶段函数（见 src/<型号>/Tune_*.cpp）
+template <class V>
+class TunePipelineT : public TunePipeline {
+public:
+    TunePipelineT(FrameStages& stages, const SD_Options* opts)
+        : stages_(stages), opts_(opts ? *opts : SD_Options{})
+    {
+        opts_.percentile_tracker = nullptr;
+        opts_.redetect.enable = false;
+    }
+
+    void update(const ChipParams& p, TuneStage from) override
+    {
+        using clk = std::chrono::steady_clock;
+        auto ms = [](clk::time_point t0){
+            return std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+        };
+        for (int s = from; s < TS_DONE; ++s) stage_ms[s] = 0;
+
+        clk::time_point t0 = clk::now();
+        if (from <= TS_BLOBS) {
+            blobs_ = stages_.blobs(p.low_pct, p.high_pct, p.gamma_v, chipEnhanceMode(V::kKind));
+            stage_ms[TS_BLOBS] = ms(t0); t0 = clk::now();
+        }
+        if (from <= TS_CLUSTERS) {
+            SD_Options o = opts_;
+            o.histogram     = stages_.histogram()->data();
+            o.preset_low_v  = blobs_->low_v;
+            o.preset_high_v = blobs_->high_v;
+            o.blobs         = &blobs_->blobs;
+            o.blobs_otsu    = blobs_->otsu;
+            uint16_t lo = blobs_->low_v, hi = blobs_->high_v;
+            double otsu = 0;
+            clusters_ = V::findClusters(stages_.frame(), p.low_pct, p.high_pct, p.gamma_v,
+                                        p.area_min, p.EPS, &otsu, &lo, &hi, &o, nullptr);
+            stage_ms[TS_CLUSTERS] = ms(t0); t0 = clk::now();
+        }
+        if (from <= TS_ANCHORS) {
+            anchors_ = V::computeAnchors(clusters_, p.dy_thresh);
+            if (opts_.lattice.enable) applyLatticeAnchors(anchors_, opts_.lattice);
+            stage_ms[TS_ANCHORS] = ms(t0); t0 = clk::now();
+        }
+        if (from <= TS_GRIDS) {
+            keeps_ = V::generateGrids(clusters_, anchors_, p.dx, p.dy, p.tol);
+            stage_ms[TS_GRIDS] = ms(t0); t0 = clk::now();
+        }
+        if (from <= TS_MERGE) {
+            merged_ = V::mergeFilter(clusters_, keeps_, anchors_, p.up_a, p.down_b, p.left_c, p.right_d);
+            stage_ms[TS_MERGE] = ms(t0);
+        }
+    }
+
+    // 配色同 main_*.cpp
+    void draw(cv::Mat& canvas, const ChipParams& p) const override
+    {
+        const cv::Scalar COL_BOX(0, 255, 0), COL_PTS(255, 255, 0), COL_ANCHOR(0, 0, 255);
+        const cv::Scalar COL_GRID(255, 0, 255), COL_MERGED(0, 255, 255), COL_WINBOX(100, 100, 255);
+        for (size_t i = 0; i < clusters_.size(); ++i) {
+            cv::rectangle(canvas, clusters_[i].bbox, COL_BOX, 1, cv::LINE_AA);
+            for (const auto& q : clusters_[i].points) cv::circle(canvas, q, 2, COL_PTS, cv::FILLED, cv::LINE_AA);
+            if (i >= anchors_.size()) continue;
+            const cv::Point2f a = anchors_[i].anchor;
+            if (!std::isfinite(a.x) || !std::isfinite(a.y)) continue;
+            const cv::Point c(cvRound(a.x), cvRound(a.y));
+            cv::line(canvas, cv::Point(c.x - 7, c.y), cv::Point(c.x + 7, c.y), COL_ANCHOR, 2, cv::LINE_AA);
+            cv::line(canvas, cv::Point(c.x, c.y - 7), cv::Point(c.x, c.y + 7), COL_ANCHOR, 2, cv::LINE_AA);
+            cv::rectangle(canvas, cv::Point(cvRound(a.x - p.left_c), cvRound(a.y - p.up_a)),
+                          cv::Point(cvRound(a.x + p.right_d), cvRound(a.y + p.down_b)), COL_WINBOX, 1, cv::LINE_AA);
+        }
+        for (const auto& g : keeps_) cv::circle(canvas, g.pt, 2, COL_GRID, cv::FILLED, cv::LINE_AA);
+        for (const auto& mc : merged_)
+            for (const auto& q : mc.points) cv::circle(canvas, q, 2, COL_MERGED, cv::FILLED, cv::LINE_AA);
+    }
+
+    int mergedPoints() const override
+    {
+        int n = 0;
+        for (const auto& mc : merged_) n += (int)mc.points.size();
+        return n;
+    }
+
+private:
+    FrameStages&                            stages_;
+    SD_Options                              opts_;
+    std::shared_ptr<const BlobSet>          blobs_;
+    std::vector<typename V::ClusterT>       clusters_;
+    std::vector<typename V::AnchorT>        anchors_;
+    std::vector<typename V::KeepT>          keeps_;
+    std::vector<typename V::MergedT>        merged_;
+};
+
+std::unique_ptr<TunePipeline> makeTunePipelineC5 (FrameStages& stages, const SD_Options* opts);
+std::unique_ptr<TunePipeline> makeTunePipeline4X (FrameStages& stages, const SD_Options* opts);
+std::unique_ptr<TunePipeline> makeTunePipelineGMY(FrameStages& stages, const SD_Options* opts);
+std::unique_ptr<TunePipeline> makeTunePipelinePG (FrameStages& stages, const SD_Options* opts);
+// 按型号分派（libchip_panel，只含已编译的型号）；std 没有可拆分的阶段，返回空
+std::unique_ptr<TunePipeline> makeTunePipeline(ChipKind kind, FrameStages& stages, const SD_Options* opts);
+
+// 带滑条的窗口，Esc / q 退出，回车把当前参数打印成 main_*.cpp 里的常量写法；返回最终参数
+ChipParams runTuneViewer(TunePipeline& pipe, const cv::Mat& src16, const ChipParams& init,
+                         const std::string& title);
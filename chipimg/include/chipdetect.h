@@ -0,0 +1,149 @@
+#ifndef CHIPDETECT_H
+#define CHIPDETECT_H
+/*
+ * libchipdetect：稳定的 C 接口（不含 C++ / OpenCV 类型）。
+ *
+ * 用法：按芯片型号建 context -> 反复 chipdetect_detect（结果写进调用方给的缓冲区）-> destroy。
+ * context 在两次调用之间保留逐帧状态（百分位跟踪、时延预算）、结果点缓冲和前端中间图
+ * （拉伸 / gamma / 二值 / 标签图等，见 DetectScratch.h）；帧尺寸不变时连续帧不再重新分配这些缓冲。
+ * 同一个 context 不能被多个线程同时使用；不同 context 可以在不同线程上并发。
+ *
+ * ABI 约定：已有函数签名不变。chipdetect_params / chipdetect_summary 以 struct_size 开头，
+ * 调用方传入前置为 sizeof（用 chipdetect_params_init / chipdetect_summary_init）；新字段只追加在末尾，
+ * 库只读写双方都认识的前缀，新旧版本混用不会越界。chipdetect_point 按数组传递，布局冻结。
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#  if defined(CHIPDETECT_BUILD)
+#    define CHIPDETECT_API __declspec(dllexport)
+#  else
+#    define CHIPDETECT_API __declspec(dllimport)
+#  endif
+#else
+#  define CHIPDETECT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHIPDETECT_ABI_VERSION 2
+
+typedef struct chipdetect_ctx chipdetect_ctx;
+
+/* 与内部 ChipKind 取值一致 */
+enum {
+    CHIPDETECT_C5   = 0,
+    CHIPDETECT_4X   = 1,
+    CHIPDETECT_GMY  = 2,
+    CHIPDETECT_PG   = 3,
+    CHIPDETECT_STD  = 4,
+    CHIPDETECT_AUTO = 5
+};
+
+/* 返回码：>= 0 成功 */
+enum {
+    CHIPDETECT_OK            = 0,
+    CHIPDETECT_E_ARG         = -1,   /* 参数非法（空指针、尺寸、步长） */
+    CHIPDETECT_E_KIND        = -2,   /* 型号未知或未编进本库 */
+    CHIPDETECT_E_BUFFER      = -3,   /* 点缓冲区不够，所需数量见 summary.points */
+    CHIPDETECT_E_NOT_FOUND   = -4,   /* 未检出（或帧质量不合格，见 summary.rejected） */
+    CHIPDETECT_E_INTERNAL    = -5    /* 内部异常，见 chipdetect_last_error */
+};
+
+/* 检测参数，含义同 ShapeDetectionAPI_*.h（std 为编译期常量，不读这些字段） */
+typedef struct chipdetect_params {
+    uint32_t struct_size;    /* = sizeof(chipdetect_params) */
+    double low_pct;
+    double high_pct;
+    double gamma;
+    int    area_min;
+    float  eps;
+    float  dy_thresh;
+    float  dx, dy, tol;
+    float  up_a, down_b, left_c, right_d;
+} chipdetect_params;
+
+typedef struct chipdetect_point {
+    int   wr, wc, pr, pc;   /* 孔行、孔列、孔内行、孔内列 */
+    float x, y;             /* 像素坐标 */
+    int   measured;         /* 0 = 由网格拟合补出（仅 std） */
+} chipdetect_point;
+
+typedef struct chipdetect_summary {
+    uint32_t struct_size;    /* = sizeof(chipdetect_summary) */
+    int      kind;           /* 实际使用的型号（AUTO 时为识别结果） */
+    int      ok;
+    int      rejected;       /* 帧质量门限拒绝 */
+    int      points;         /* 有效点数 */
+    int      slots;          /* 位置数组总格数 */
+    int      well_rows;
+    int      point_rows, point_cols;
+    int      wells;          /* 孔数（各行孔数之和） */
+    uint16_t low_v, high_v;  /* 拉伸用百分位 */
+    double   otsu_th;
+    double   elapsed_ms;
+    int      degrade;        /* 超预算时采用的降级捷径（位或） */
+} chipdetect_summary;
+
+static inline void chipdetect_params_init(chipdetect_params* p)
+{
+    memset(p, 0, sizeof(*p));
+    p->struct_size = (uint32_t)sizeof(*p);
+}
+
+static inline void chipdetect_summary_init(chipdetect_summary* s)
+{
+    memset(s, 0, sizeof(*s));
+    s->struct_size = (uint32_t)sizeof(*s);
+}
+
+CHIPDETECT_API uint32_t    chipdetect_abi_version(void);
+CHIPDETECT_API const char* chipdetect_status_string(int status);
+
+/* 型号的默认参数（out->struct_size 需已设好）；返回 CHIPDETECT_OK、CHIPDETECT_E_ARG 或 CHIPDETECT_E_KIND */
+CHIPDETECT_API int chipdetect_default_params(int kind, chipdetect_params* out);
+
+/* params 为 NULL 时用默认参数；CHIPDETECT_AUTO 只能传 NULL（识别出的型号用各自默认参数，set_params / set_param 也返回 E_ARG）。失败返回 NULL */
+CHIPDETECT_API chipdetect_ctx* chipdetect_create(int kind, const chipdetect_params* params);
+CHIPDETECT_API void            chipdetect_destroy(chipdetect_ctx* ctx);
+
+CHIPDETECT_API int chipdetect_set_params(chipdetect_ctx* ctx, const chipdetect_params* params);
+/* 按名字改单个参数（low_pct high_pct gamma area_min eps dy_thresh dx dy tol up_a down_b left_c right_d） */
+CHIPDETECT_API int chipdetect_set_param(chipdetect_ctx* ctx, const char* name, double value);
+/*
+ * 开关与逐帧状态：
+ *   "track_percentile" 0/1  连续帧用子采样 + EMA 跟踪百分位（同一芯片的视频流）
+ *   "budget_ms"        >0   单帧时延预算，超出时逐级降级；0 关闭
+ *   "redetect"         0/1  缺点的孔局部重检
+ *   "lattice"          0/1  锚点晶格拟合
+ *   "quality_gate"     0/1  帧质量门限
+ * 调用 chipdetect_reset 清掉跟踪状态（换片时）
+ */
+CHIPDETECT_API int  chipdetect_set_option(chipdetect_ctx* ctx, const char* name, double value);
+CHIPDETECT_API void chipdetect_reset(chipdetect_ctx* ctx);
+
+/*
+ * 检测一帧 16 位灰度图。data 按行存放，stride_bytes 为行字节数（0 = width*2），不复制像素。
+ * 有效点按 (wr, wc, pr, pc) 顺序写进 points（最多 capacity 个），summary 可为 NULL（非 NULL 时 struct_size 需已设好）。
+ * 返回写入的点数，或负的错误码；points 为 NULL 且 capacity 为 0 时只返回所需数量。
+ */
+CHIPDETECT_API int chipdetect_detect(chipdetect_ctx* ctx,
+                                     const uint16_t* data, int width, int height, size_t stride_bytes,
+                                     chipdetect_point* points, int capacity,
+                                     chipdetect_summary* summary);
+
+/* 上一次检测的各孔锚点（xy 交替，NaN 表示该孔无锚点），返回锚点个数；xy 为 NULL 时只返回个数 */
+CHIPDETECT_API int chipdetect_anchors(const chipdetect_ctx* ctx, float* xy, int capacity);
+
+/* 本 context 最近一次错误的说明，无错误时为空串；指针在下一次调用前有效 */
+CHIPDETECT_API const char* chipdetect_last_error(const chipdetect_ctx* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CHIPDETECT_H */
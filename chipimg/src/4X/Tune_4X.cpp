@@ -0,0 +1,44 @@
+#include "TuneViewer.h"
+#include "Cluster_4X.h"
+#include "Anchor_4X.h"
+#include "Grid_4X.h"
+#include "MergeFilter_4X.h"
+
+namespace {
+struct Tune4X {
+    typedef Cluster4X ClusterT;
+    typedef AnchorInfo4X AnchorT;
+    typedef GridKeepPoint4X KeepT;
+    typedef MergedClusterPoints4X MergedT;
+    static const ChipKind kKind = CHIP_4X;
+
+    static std::vector<ClusterT> findClusters(const cv::Mat& src16, double low_pct, double high_pct, double gamma_v,
+                                              int area_min, float EPS, double* out_otsu,
+                                              uint16_t* out_lowv, uint16_t* out_highv,
+                                              const SD_Options* opts, SD_Report* report)
+    {
+        return ::findClusters4X(src16, low_pct, high_pct, gamma_v, area_min, EPS,
+            out_otsu, out_lowv, out_highv, opts, report);
+    }
+    static std::vector<AnchorT> computeAnchors(const std::vector<ClusterT>& clusters, float dy_thresh)
+    {
+        return ::computeAllAnchorsWithFit4X(clusters, dy_thresh);
+    }
+    static std::vector<KeepT> generateGrids(const std::vector<ClusterT>& clusters, const std::vector<AnchorT>& anchors,
+                                            float dx, float dy, float tol)
+    {
+        return ::generateAndFilterGrids4X(clusters, anchors, dx, dy, tol);
+    }
+    static std::vector<MergedT> mergeFilter(const std::vector<ClusterT>& clusters, const std::vector<KeepT>& keeps,
+                                            const std::vector<AnchorT>& anchors,
+                                            float up_a, float down_b, float left_c, float right_d)
+    {
+        return ::mergeAndFilterClusterPoints4X(clusters, keeps, anchors, up_a, down_b, left_c, right_d);
+    }
+};
+}
+
+std::unique_ptr<TunePipeline> makeTunePipeline4X(FrameStages& stages, const SD_Options* opts)
+{
+    return std::unique_ptr<TunePipeline>(new TunePipelineT<Tune4X>(stages, opts));
+}
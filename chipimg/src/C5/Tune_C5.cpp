@@ -0,0 +1,44 @@
+#include "TuneViewer.h"
+#include "Cluster.h"
+#include "Anchor.h"
+#include "Grid.h"
+#include "MergeFilter.h"
+
+namespace {
+struct TuneC5 {
+    typedef Cluster ClusterT;
+    typedef AnchorInfo AnchorT;
+    typedef GridKeepPoint KeepT;
+    typedef MergedClusterPoints MergedT;
+    static const ChipKind kKind = CHIP_C5;
+
+    static std::vector<ClusterT> findClusters(const cv::Mat& src16, double low_pct, double high_pct, double gamma_v,
+                                              int area_min, float EPS, double* out_otsu,
+                                              uint16_t* out_lowv, uint16_t* out_highv,
+                                              const SD_Options* opts, SD_Report* report)
+    {
+        return ::findClusters(src16, low_pct, high_pct, gamma_v, area_min, EPS,
+            out_otsu, out_lowv, out_highv, opts, report);
+    }
+    static std::vector<AnchorT> computeAnchors(const std::vector<ClusterT>& clusters, float dy_thresh)
+    {
+        return ::computeAllAnchorsWithFit(clusters, dy_thresh);
+    }
+    static std::vector<KeepT> generateGrids(const std::vector<ClusterT>& clusters, const std::vector<AnchorT>& anchors,
+                                            float dx, float dy, float tol)
+    {
+        return ::generateAndFilterGrids(clusters, anchors, dx, dy, tol);
+    }
+    static std::vector<MergedT> mergeFilter(const std::vector<ClusterT>& clusters, const std::vector<KeepT>& keeps,
+                                            const std::vector<AnchorT>& anchors,
+                                            float up_a, float down_b, float left_c, float right_d)
+    {
+        return ::mergeAndFilterClusterPoints(clusters, keeps, anchors, up_a, down_b, left_c, right_d);
+    }
+};
+}
+
+std::unique_ptr<TunePipeline> makeTunePipelineC5(FrameStages& stages, const SD_Options* opts)
+{
+    return std::unique_ptr<TunePipeline>(new TunePipelineT<TuneC5>(stages, opts));
+}
@@ -1,21 +1,13 @@
 #include "Grid_GMY.h"
+#include "GridKernel.h"
+#include "OverlayRenderer.h"
+#include <cstdio>
 #include <algorithm>
 #include <cmath>
 
 using namespace cv;
 using namespace std;
 
-namespace {
-static void genGridRaw_GMY(const Point2f& anchor, float dx, float dy, vector<Point2f>& out){
-    out.clear(); out.reserve(36);
-    const float base_x = anchor.x - 25.0f;
-    const float base_y = anchor.y - 49.0f;
-    for (int i=0;i<8;++i)
-        for (int j=0;j<8;++j)
-            out.emplace_back(base_x + j*dx, base_y + i*dy);
-}
-}
-
 std::vector<GridKeepPointGMY> generateAndFilterGridsGMY(
     const std::vector<ClusterGMY>& clusters,
     const std::vector<AnchorInfoGMY>& anchors,
@@ -25,21 +17,18 @@ std::vector<GridKeepPointGMY> generateAndFilterGridsGMY(
     if (clusters.size()!=anchors.size()) return keeps;
 
     const float tol2 = tol*tol;
+    GridPoints<GridLayoutGMY> grid;
+    std::array<char, GridLayoutGMY::size> near;
     for (size_t k=0;k<clusters.size();++k){
         const auto& cl = clusters[k];
         const auto& ai = anchors[k];
         if (!isFinitePtGMY(ai.anchor)) continue;
 
-        vector<Point2f> grid;
-        genGridRaw_GMY(ai.anchor, dx, dy, grid);
+        genGridFixed<GridLayoutGMY>(ai.anchor, dx, dy, grid);
+        nearSignalFixed<GridLayoutGMY>(grid, cl.points, tol2, near);
 
-        for (const auto& gp : grid){
-            bool close=false;
-            for (const auto& sp : cl.points){
-                float dx_ = gp.x - sp.x, dy_ = gp.y - sp.y;
-                if (dx_*dx_ + dy_*dy_ <= tol2){ close=true; break; }
-            }
-            if (!close) keeps.push_back(GridKeepPointGMY{cl.id, cl.row, gp});
+        for (int g=0; g<GridLayoutGMY::size; ++g){
+            if (!near[g]) keeps.push_back(GridKeepPointGMY{cl.id, cl.row, grid[g]});
         }
     }
     return keeps;
@@ -51,10 +40,12 @@ void drawKeptGridPointsGMY(cv::Mat& canvas,
                            const cv::Scalar& textColor)
 {
     const int radius=2, thickness=cv::FILLED;
-    for (const auto& g : keeps){
-        circle(canvas, g.pt, radius, ptColor, thickness, LINE_AA);
-        const string txt = cv::format("(%.1f, %.1f)", g.pt.x, g.pt.y);
-        Point org((int)std::round(g.pt.x) + 3, (int)std::round(g.pt.y) - 3);
-        putText(canvas, txt, org, FONT_HERSHEY_SIMPLEX, 0.38, textColor, 1, LINE_AA);
+    // 标签走字形缓存，不再逐点 cv::format + 抗锯齿 putText
+    const GlyphCache& glyphs = overlayGlyphs();
+    char txt[48];
+    for (const auto& g : keeps) {
+        circle(canvas, g.pt, radius, ptColor, thickness, LINE_8);
+        snprintf(txt, sizeof(txt), "(%.1f, %.1f)", g.pt.x, g.pt.y);
+        glyphs.draw(canvas, Point((int)std::round(g.pt.x) + 3, (int)std::round(g.pt.y) - 3), txt, textColor);
     }
 }
@@ -1,21 +1,12 @@
 #include "ShapeDetectionAPI_GMY.h"
+#include "TextWriter.h"
+#include "GridKernel.h"
 #include <map>
 #include <cfloat>
 #include <cmath>
 using namespace cv;
 using namespace std;
 
-static void genGridRaw_GMY_local(const Point2f& anchor, float dx, float dy, vector<Point2f>& out) {
-    out.clear(); out.reserve(64);
-    const float base_x = anchor.x - 25.0f;
-    const float base_y = anchor.y - 49.0f;
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            out.emplace_back(base_x + j * dx, base_y + i * dy);
-        }
-    }
-}
-
 static void groupClustersByRowGMY(const std::vector<ClusterGMY>& clusters,
                                   std::vector<std::vector<int>>& rows_idx)
 {
@@ -50,26 +41,54 @@ void PerformShapeDetectionGMY(
     float dy_thresh,
     float dx, float dy, float tol,
     float up_a, float down_b, float left_c, float right_d,
-    SD_PositionArray_GMY* out_arr)
+    SD_PositionArray_GMY* out_arr,
+    const SD_Options* opts, SD_Report* report)
 {
     if (!out_arr) return;
     out_arr->clear();
+    if (report) *report = SD_Report{};
 
     if (src16.empty() || src16.type() != CV_16UC1) {
 
         return;
     }
 
+    // 限时模式：clock 随 opts 传给 findClusters*，各阶段按预算选做法（见 DeadlineBudget.h）
+    DeadlineClock clk(opts ? opts->deadline : DeadlineParams{});
+    SD_Options timed_opts;
+    if (opts && opts->deadline.budget_ms > 0.0) {
+        timed_opts = *opts;
+        timed_opts.deadline_clock = &clk;
+        opts = &timed_opts;
+    }
+    DeadlineClock* dl = opts ? opts->deadline_clock : nullptr;
+
     double otsu_th = 0.0;
-    uint16_t low_v = 0, high_v = 0;
+    uint16_t low_v  = opts ? opts->preset_low_v  : 0;
+    uint16_t high_v = opts ? opts->preset_high_v : 0;
 
     auto clusters = findClustersGMY(src16, low_pct, high_pct, gamma_v,
-                                    area_min, EPS, &otsu_th, &low_v, &high_v);
-    auto anchors  = computeAllAnchorsWithFitGMY(clusters, dy_thresh);
+                                    area_min, EPS, &otsu_th, &low_v, &high_v,
+                                    opts, report);
+    if (dl) dl->setRoi(clustersBoundingRect(clusters, opts->deadline.roi_margin, src16.size()));
+    const bool use_lattice = opts && opts->lattice.enable;
+    LatticeModel lm;
+    int lattice_replaced = 0;
+    auto anchors  = computeAnchorsTimed<AnchorInfoGMY>(clusters,
+                        [&]{ return computeAllAnchorsWithFitGMY(clusters, dy_thresh); },
+                        use_lattice ? &opts->lattice : nullptr, dl, &lm, &lattice_replaced);
+    if (use_lattice && report) { report->lattice = lm; report->lattice_replaced = lattice_replaced; }
     auto keeps    = generateAndFilterGridsGMY(clusters, anchors, dx, dy, tol);
     auto merged   = mergeAndFilterClusterPointsGMY(clusters, keeps, anchors,
                                                    up_a, down_b, left_c, right_d);
 
+    if (report) {
+        report->otsu_th = otsu_th; report->low_v = low_v; report->high_v = high_v;
+        for (const auto& c : clusters) report->spots += (int)c.points.size();
+        report->clusters   = (int)clusters.size();
+        report->grid_keeps = (int)keeps.size();
+    }
+
     vector<vector<int>> rows_idx;
     groupClustersByRowGMY(clusters, rows_idx);
     const int WellRow = (int)rows_idx.size();
@@ -86,67 +105,60 @@ void PerformShapeDetectionGMY(
             int cid = clusters[idxs[wc]].id;
 
             Point2f anch = anchors[idxs[wc]].anchor;
-            vector<Point2f> grid;
-            genGridRaw_GMY_local(anch, dx, dy, grid);
+            if (report) report->anchors.push_back(anch);
+            GridPoints<GridLayoutGMY> grid;
+            genGridFixed<GridLayoutGMY>(anch, dx, dy, grid);
 
+            static const vector<Point2f> kNoPoints;
             const auto it = id2pts.find(cid);
-            const vector<Point2f>& detected = (it == id2pts.end())
-                                              ? * (new vector<Point2f>())
-                                              : it->second;
+            const vector<Point2f>& detected = (it == id2pts.end()) ? kNoPoints : it->second;
 
             auto& plane = (*out_arr)[wr][wc];
-            plane.assign(8, std::vector<SD_Position_GMY>(8));
+            plane.assign(GridLayoutGMY::rows, std::vector<SD_Position_GMY>(GridLayoutGMY::cols));
 
-            const float tol2 = tol * tol;
-            for (int i = 0; i < 8; ++i) {
-                for (int j = 0; j < 8; ++j) {
-                    const Point2f& g = grid[i*8 + j];
-                    int best_k = -1; float best_d2 = FLT_MAX;
-
-                    for (int k = 0; k < (int)detected.size(); ++k) {
-                        const float dx_ = detected[k].x - g.x;
-                        const float dy_ = detected[k].y - g.y;
-                        const float d2 = dx_*dx_ + dy_*dy_;
-                        if (d2 < best_d2) { best_d2 = d2; best_k = k; }
-                    }
+            std::array<int,   GridLayoutGMY::size> best_k;
+            std::array<float, GridLayoutGMY::size> best_d2;
+            nearestToGridFixed<GridLayoutGMY>(grid, detected, best_k, best_d2);
 
+            const float tol2 = tol * tol;
+            for (int i = 0; i < GridLayoutGMY::rows; ++i) {
+                for (int j = 0; j < GridLayoutGMY::cols; ++j) {
+                    const int g = i*GridLayoutGMY::cols + j;
                     SD_Position_GMY pos;
-                    if (best_k >= 0 && best_d2 <= tol2) {
-                        pos.x = cvRound(detected[best_k].x);
-                        pos.y = cvRound(detected[best_k].y);
+                    if (best_k[g] >= 0 && best_d2[g] <= tol2) {
+                        pos.x = cvRound(detected[best_k[g]].x);
+                        pos.y = cvRound(detected[best_k[g]].y);
                         pos.valid = 1;
                     } else {
-                        pos.x = cvRound(g.x);
-                        pos.y = cvRound(g.y);
+                        pos.x = cvRound(grid[g].x);
+                        pos.y = cvRound(grid[g].y);
                         pos.valid = 0;
                     }
                     plane[i][j] = pos;
                 }
             }
+
+            if (opts && opts->redetect.enable) {
+                bool missing = false;
+                for (const auto& prow : plane)
+                    for (const auto& p : prow) if (!p.valid) missing = true;
+                if (missing) {
+                    const Rect win = anchorWindowRect(anch, up_a, down_b, left_c, right_d, src16.size());
+                    const auto extra = redetectSpotsInWindow(src16, win, opts->redetect, detected);
+                    const int n = mergeRedetectedPoints(plane, grid, GridLayoutGMY::cols, extra, tol);
+                    if (report) { ++report->redetect_wells; report->redetect_recovered += n; }
+                }
+            }
         }
     }
+
+    if (dl) dl->finish(report);
 }
 
 void PrintPositionArrayGMY(const SD_PositionArray_GMY& arr)
 {
-    const int WR = (int)arr.size();
-    std::cout << "PostionArray (GMY) WellRow=" << WR << "\n";
-    for (int wr = 0; wr < WR; ++wr) {
-        const int WC = (int)arr[wr].size();
-        std::cout << " Row " << wr << " (WellCol=" << WC << ")\n";
-        for (int wc = 0; wc < WC; ++wc) {
-            std::cout << "  Well(" << wr << "," << wc << "):\n";
-            for (int i = 0; i < 8; ++i) {
-                std::cout << "   ";
-                for (int j = 0; j < 8; ++j) {
-                    const auto& p = arr[wr][wc][i][j];
-                    if (p.valid)
-                        std::cout << "(" << p.x << "," << p.y << ") ";
-                    else
-                        std::cout << "[--] ";
-                }
-                std::cout << "\n";
-            }
-        }
-    }
+    // 整块格式化后一次写出（见 TextWriter.h）
+    TextBuffer tb;
+    formatPositionArray(tb, TF_TEXT, arr, 0, "PostionArray (GMY)");
+    tb.writeTo(stdout);
 }
@@ -0,0 +1,24 @@
+#include "ChipDispatch.h"
+#include "ShapeDetectionAPI_PG.h"
+
+bool detectChipPG(const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out)
+{
+    out.kind = CHIP_PG;
+    out.points.clear();
+    out.slots = 0;
+    out.wells_per_row.clear();
+    out.point_rows = out.point_cols = 0;
+    out.report = SD_Report{};
+    out.ok = false;
+    if (roi16.empty() || roi16.type() != CV_16UC1) return false;
+
+    SD_PositionArray_PG arr;
+    PerformShapeDetectionPG(roi16,
+        prm.low_pct, prm.high_pct, prm.gamma_v, prm.area_min, prm.EPS,
+        prm.dy_thresh, prm.dx, prm.dy, prm.tol,
+        prm.up_a, prm.down_b, prm.left_c, prm.right_d,
+        &arr, opts, &out.report);
+    collectChipPoints(arr, offset, out);
+    out.ok = !out.report.rejected && !out.points.empty();
+    return out.ok;
+}
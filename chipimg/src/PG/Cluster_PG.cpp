@@ -34,22 +34,24 @@ static void findPercentile16U(const Mat& img16, double low_pct, double high_pct,
     if (low_v >= high_v) { low_v = 0; high_v = 65535; }
 }
 
-static Mat stretch16U(const Mat& src16, uint16_t a, uint16_t b) {
-    if (a >= b) return src16.clone();
-    Mat f32, dst16;
-    src16.convertTo(f32, CV_32F);
-    f32 = (f32 - static_cast<float>(a)) * (65535.0f / static_cast<float>(b - a));
-    threshold(f32, f32, 65535.0, 65535.0, THRESH_TRUNC);
-    threshold(f32, f32, 0.0,     0.0,     THRESH_TOZERO);
-    f32.convertTo(dst16, CV_16U);
-    return dst16;
+// 结果写进 s.stretched16，浮点中间图用 s.f32（见 DetectScratch.h）
+static const Mat& stretch16U(const Mat& src16, uint16_t a, uint16_t b, DetectScratch& s) {
+    if (a >= b) { src16.copyTo(s.stretched16); return s.stretched16; }
+    Mat& f = s.f32;
+    src16.convertTo(f, CV_32F);
+    f = (f - (float)a) * (65535.0f / (float)(b - a));
+    threshold(f, f, 65535.0, 65535.0, THRESH_TRUNC);
+    threshold(f, f, 0.0, 0.0, THRESH_TOZERO);
+    f.convertTo(s.stretched16, CV_16U);
+    return s.stretched16;
 }
 
-static Mat gamma16U(const Mat& src16, float gamma) {
-    Mat f; src16.convertTo(f, CV_32F, 1.0/65535.0);
+static const Mat& gamma16U(const Mat& src16, float gamma, DetectScratch& s) {
+    Mat& f = s.f32;
+    src16.convertTo(f, CV_32F, 1.0/65535.0);
     pow(f, gamma, f);
-    Mat out; f.convertTo(out, CV_16U, 65535.0);
-    return out;
+    f.convertTo(s.enhanced16, CV_16U, 65535.0);
+    return s.enhanced16;
 }
 }
 
@@ -58,42 +60,123 @@ std::vector<ClusterPG> findClustersPG(const cv::Mat& src16,
                                       int area_min, float EPS,
                                       double* out_otsu,
                                       uint16_t* out_lowv,
-                                      uint16_t* out_highv)
+                                      uint16_t* out_highv,
+                                      const SD_Options* opts,
+                                      SD_Report* report)
 {
     vector<ClusterPG> clusters;
     if (src16.empty() || src16.type() != CV_16UC1) return clusters;
+    // 中间图写进调用方给的复用缓冲，没有就用本次的临时缓冲
+    DetectScratch local_scratch;
+    DetectScratch& scratch = (opts && opts->scratch) ? *opts->scratch : local_scratch;
 
-    uint16_t low_v = 0, high_v = 65535;
-    findPercentile16U(src16, low_pct, high_pct, low_v, high_v);
-    Mat stretched = stretch16U(src16, low_v, high_v);
-    Mat enhanced  = gamma16U(stretched, static_cast<float>(gamma_v));
-
-    Mat view8; enhanced.convertTo(view8, CV_8U, 1.0/256.0);
-    Mat bin8;
-    const double otsu_th = threshold(view8, bin8, 0, 255, THRESH_BINARY | THRESH_OTSU);
-
-    if (out_otsu)  *out_otsu  = otsu_th;
+    uint16_t low_v  = out_lowv  ? *out_lowv  : 0;
+    uint16_t high_v = out_highv ? *out_highv : 65535;
+    bool use_fixed = (out_lowv && out_highv && low_v < high_v);
+    if (!use_fixed && opts && opts->percentile_tracker) {
+        const PercentileEstimate pe = opts->percentile_tracker->update(src16, low_pct, high_pct);
+        if (report) report->percentile = pe;
+        low_v = pe.low_v; high_v = pe.high_v;
+        use_fixed = true;
+    }
+    // 分带模式的 Otsu 也要直方图；没有现成的就逐带统计一次
+    const bool precomputed = opts && opts->blobs;
+    const bool striped = opts && opts->stripe.enable && !precomputed;
+    const uint32_t* hist16 = opts ? opts->histogram : nullptr;
+    if (striped && !hist16) {
+        scratch.hist16.assign(65536, 0u);
+        for (int r0 = 0; r0 < src16.rows; r0 += std::max(1, opts->stripe.band_rows))
+            accumulateHistogram16U(src16, r0, opts->stripe.band_rows, scratch.hist16.data());
+        hist16 = scratch.hist16.data();
+    }
+    bool rejected = false;
+    if (opts && opts->quality_gate) {
+        uint16_t q_low = 0, q_high = 65535;
+        FrameQualityStats qs;
+        findPercentile16UWithQuality(src16, hist16, low_pct, high_pct, gamma_v, opts->quality,
+                                     q_low, q_high, qs);
+        if (!use_fixed) { low_v = q_low; high_v = q_high; }
+        if (report) { report->quality = qs; report->rejected = qs.rejected; }
+        rejected = qs.rejected;
+    } else if (!use_fixed && hist16) {
+        percentileFromHistogram16U(hist16, 1LL * src16.rows * src16.cols,
+                                   low_pct, high_pct, low_v, high_v);
+    } else if (!use_fixed) {
+        DeadlineStep step(opts ? opts->deadline_clock : nullptr, DL_PERCENTILE, DG_SAMPLED_PERCENTILE);
+        if (step.cheap()) {
+            const PercentileEstimate pe = estimatePercentile16USampled(src16, low_pct, high_pct,
+                                                                       opts->deadline.sample_stride);
+            if (report) report->percentile = pe;
+            low_v = pe.low_v; high_v = pe.high_v;
+        } else {
+            findPercentile16U(src16, low_pct, high_pct, low_v, high_v);
+        }
+    }
     if (out_lowv)  *out_lowv  = low_v;
     if (out_highv) *out_highv = high_v;
-
-    Mat labels, stats, centroids;
-    int nLabels = connectedComponentsWithStats(bin8, labels, stats, centroids, 8, CV_32S);
+    if (rejected) return clusters;
 
     struct Region { Rect bbox; Point2f center; };
     vector<Region> regions;
-    regions.reserve(std::max(0, nLabels - 1));
-    for (int i = 1; i < nLabels; ++i) {
-        const int area = stats.at<int>(i, CC_STAT_AREA);
-        if (area < area_min) continue;
-        const int x = stats.at<int>(i, CC_STAT_LEFT);
-        const int y = stats.at<int>(i, CC_STAT_TOP);
-        const int w = stats.at<int>(i, CC_STAT_WIDTH);
-        const int h = stats.at<int>(i, CC_STAT_HEIGHT);
-        const Point2f c(static_cast<float>(centroids.at<double>(i,0)),
-                        static_cast<float>(centroids.at<double>(i,1)));
-        regions.push_back({ Rect(x,y,w,h), c });
-    }
+    if (precomputed) {
+        if (out_otsu) *out_otsu = opts->blobs_otsu;
+        regions.reserve(opts->blobs->size());
+        for (const BlobStat& b : *opts->blobs) {
+            if (b.area < area_min) continue;
+            regions.push_back({ b.bbox, b.centroid });
+        }
+    } else if (striped) {
+        vector<uint8_t>& lut = scratch.lut;
+        buildEnhanceLut8(low_v, high_v, (float)gamma_v, lut);
+        vector<BlobStat> blobs;
+        double otsu_th = 0.0;
+        stripedBlobs16U(src16, lut, hist16, -1.0, 1.0, opts->stripe.band_rows, blobs, &otsu_th, &scratch);
+        if (out_otsu) *out_otsu = otsu_th;
+        regions.reserve(blobs.size());
+        for (const BlobStat& b : blobs) {
+            if (b.area < area_min) continue;
+            regions.push_back({ b.bbox, b.centroid });
+        }
+    } else {
+        // 限时模式下可只处理上一帧的芯片区域
+        DeadlineClock* dl = opts ? opts->deadline_clock : nullptr;
+        const Rect roi = dl ? dl->reusableRoi(src16.size()) : Rect();
+        DeadlineStep step(dl, DL_LABEL, DG_ROI_LABELLING, roi.area() > 0);
+        const Rect work = step.cheap() ? roi : Rect(0, 0, src16.cols, src16.rows);
+        DebugSink* dbg = opts ? opts->debug : nullptr;
+
+        Mat stretched = stretch16U(src16(work), low_v, high_v, scratch);
+        Mat enhanced  = gamma16U(stretched, static_cast<float>(gamma_v), scratch);
+        CHIP_DEBUG_PUBLISH(dbg, "stretch16", stretched);
+        CHIP_DEBUG_PUBLISH(dbg, "gamma16", enhanced);
+
+        Mat& view8 = scratch.view8; enhanced.convertTo(view8, CV_8U, 1.0/256.0);
+        CHIP_DEBUG_PUBLISH(dbg, "view8", view8);
+        Mat& bin8 = scratch.bin8;
+        const double otsu_th = threshold(view8, bin8, 0, 255, THRESH_BINARY | THRESH_OTSU);
+
+        if (out_otsu)  *out_otsu  = otsu_th;
+        CHIP_DEBUG_PUBLISH(dbg, "bin8", bin8);
 
+        Mat& labels = scratch.labels;
+        Mat& stats = scratch.stats;
+        Mat& centroids = scratch.centroids;
+        int nLabels = connectedComponentsWithStats(bin8, labels, stats, centroids, 8, CV_32S);
+
+        regions.reserve(std::max(0, nLabels - 1));
+        for (int i = 1; i < nLabels; ++i) {
+            const int area = stats.at<int>(i, CC_STAT_AREA);
+            if (area < area_min) continue;
+            const int x = stats.at<int>(i, CC_STAT_LEFT) + work.x;
+            const int y = stats.at<int>(i, CC_STAT_TOP) + work.y;
+            const int w = stats.at<int>(i, CC_STAT_WIDTH);
+            const int h = stats.at<int>(i, CC_STAT_HEIGHT);
+            const Point2f c(static_cast<float>(centroids.at<double>(i,0) + work.x),
+                            static_cast<float>(centroids.at<double>(i,1) + work.y));
+            regions.push_back({ Rect(x,y,w,h), c });
+        }
+
+    }
     const int N = static_cast<int>(regions.size());
     if (N == 0) return clusters;
 
@@ -11,13 +11,14 @@
 #include "MergeFilter_PG.h"
 #include "OutputInterface_PG.h"
 #include "ShapeDetectionAPI_PG.h"
+#include "OverlayRenderer.h"
+#include "RawFrameStore.h"
 
 using namespace std;
 using namespace cv;
 
 namespace {
 constexpr float kDyThresh  = 7.0f;
-constexpr int   kPtRadius  = 2;
 
 constexpr float kA_Up   = 50.0f;
 constexpr float kB_Down = 5.0f;
@@ -64,8 +65,8 @@ static Mat gamma16U(const Mat& src16, float gamma) {
     Mat out; f.convertTo(out, CV_16U, 65535.0);
     return out;
 }
-static void makeEnhancedBaseBGR(const Mat& src16, double low_pct, double high_pct, double gamma_v,
-                                Mat& out_bgr) {
+static void makeEnhancedBase8(const Mat& src16, double low_pct, double high_pct, double gamma_v,
+                              Mat& out8) {
     uint16_t a=0, b=65535;
     findPercentile16U(src16, low_pct, high_pct, a, b);
     Mat stretched       = stretch16U(src16, a, b);
@@ -73,14 +74,17 @@ static void makeEnhancedBaseBGR(const Mat& src16, double low_pct, double high_pc
     Mat eq16;
     Ptr<CLAHE> clahe = createCLAHE(2.0, Size(8,8));
     clahe->apply(stretched_gamma, eq16);
-    Mat eq8; eq16.convertTo(eq8, CV_8U, 1.0/256.0);
-    cvtColor(eq8, out_bgr, COLOR_GRAY2BGR);
+    eq16.convertTo(out8, CV_8U, 1.0/256.0);
 }
 }
 
 int main(int argc, char** argv) {
     string path = (argc >= 2) ? string(argv[1]) : string("../Img/PG/20250611-Q1DAY1-80u.png");
-    Mat src16 = imread(path, IMREAD_UNCHANGED);
+    // 预览缩放（相对整帧），默认同 OverlayParams
+    const double preview = (argc >= 3) ? atof(argv[2]) : OverlayParams().scale;
+    if (!(preview > 0)) { cerr << "预览缩放需 > 0： " << argv[2] << "\n"; return -1; }
+    RawFrameReader frame_reader;   // .chrf 容器时帧数据直接映射，需存活到处理结束
+    Mat src16 = loadFrame16(path, frame_reader);
     if (src16.empty()) { cerr << "读取失败： " << path << "\n"; return -1; }
     if (src16.type() != CV_16UC1) { cerr << "需要 CV_16UC1，当前 type=" << src16.type() << "\n"; return -1; }
 
@@ -91,7 +95,7 @@ int main(int argc, char** argv) {
     const float EPS       = 35.0f;
 
     double   otsu_th = 0.0;
-    uint16_t low_v   = 0, high_v = 21793;
+    uint16_t low_v   = 0, high_v = 0;
 
     auto clusters = findClustersPG(src16, low_pct, high_pct, gamma_v,
                                    area_min, EPS, &otsu_th, &low_v, &high_v);
@@ -103,25 +107,18 @@ int main(int argc, char** argv) {
         clusters, kept, anchors, kA_Up, kB_Down, kC_Left, kD_Right
     );
 
-    Mat canvas;
-    makeEnhancedBaseBGR(src16, low_pct, high_pct, gamma_v, canvas);
+    Mat base8;
+    makeEnhancedBase8(src16, low_pct, high_pct, gamma_v, base8);
 
-    const Scalar COL_GRID(255, 0, 255);
-    const Scalar COL_BOX (100,100,255);
-
-    for (const auto& g : kept) {
-        circle(canvas, g.pt, kPtRadius, COL_GRID, FILLED, LINE_AA);
-    }
+    // 网格点与合并窗口在渲染线程上按预览分辨率画（LINE_8）
+    vector<OverlayScene> scene(1);
+    for (const auto& g : kept) scene[0].grid.push_back(g.pt);
     for (const auto& mc : mergedFiltered) {
         if (!isFinitePtLocal(mc.anchor)) continue;
-        float xmin = mc.anchor.x - kC_Left;
-        float xmax = mc.anchor.x + kD_Right;
-        float ymin = mc.anchor.y - kA_Up;
-        float ymax = mc.anchor.y + kB_Down;
-        rectangle(canvas, Rect(Point(cvRound(xmin), cvRound(ymin)),
-                               Point(cvRound(xmax), cvRound(ymax))),
-                  COL_BOX, 1, LINE_AA);
+        scene[0].windows.push_back(Rect(Point(cvRound(mc.anchor.x - kC_Left), cvRound(mc.anchor.y - kA_Up)),
+                                        Point(cvRound(mc.anchor.x + kD_Right), cvRound(mc.anchor.y + kB_Down))));
     }
+    const Mat canvas = renderPreviews(base8, scene, preview)[0];
 
     SD_PositionArray_PG posArr;
     PerformShapeDetectionPG(
@@ -0,0 +1,307 @@
+#include "chipdetect.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+
+#include "PanelDetect.h"
+
+using namespace std;
+
+// 句柄背后的状态：参数、逐帧跟踪状态和复用的结果缓冲
+struct chipdetect_ctx {
+    ChipKind          kind = CHIP_STD;
+    ChipParams        prm;
+    SD_Options        opts;
+    PercentileTracker tracker;
+    DeadlineState     deadline;
+    DetectScratch     scratch;   // 前端中间图，逐帧复用
+    ChipResult        result;
+    string            error;
+};
+
+namespace {
+
+bool kindAvailable(ChipKind k)
+{
+    switch (k) {
+#ifdef CHIP_WITH_C5
+    case CHIP_C5:  return true;
+#endif
+#ifdef CHIP_WITH_4X
+    case CHIP_4X:  return true;
+#endif
+#ifdef CHIP_WITH_GMY
+    case CHIP_GMY: return true;
+#endif
+#ifdef CHIP_WITH_PG
+    case CHIP_PG:  return true;
+#endif
+#ifdef CHIP_WITH_STD
+    case CHIP_STD: return true;
+#endif
+    case CHIP_AUTO: return true;
+    default:        return false;
+    }
+}
+
+// 调用方结构体的 struct_size 可能比本库的小（旧头文件编译）或大（新头文件）：
+// 不得短于第一版带 struct_size 的布局；只读写双方都认识的前缀
+const size_t kParamsMinSize  = offsetof(chipdetect_params, right_d) + sizeof(float);
+const size_t kSummaryMinSize = offsetof(chipdetect_summary, degrade) + sizeof(int);
+
+bool readParams(const chipdetect_params* in, chipdetect_params& c)
+{
+    if (in->struct_size < kParamsMinSize) return false;
+    memset(&c, 0, sizeof(c));
+    memcpy(&c, in, std::min<size_t>(in->struct_size, sizeof(c)));
+    c.struct_size = (uint32_t)sizeof(c);
+    return true;
+}
+
+template <class T>
+void writeSized(const T& src, T* out)
+{
+    const uint32_t n = out->struct_size;
+    memcpy(out, &src, std::min<size_t>(n, sizeof(T)));
+    out->struct_size = n;
+}
+
+ChipParams fromC(const chipdetect_params& c)
+{
+    ChipParams p;
+    p.low_pct   = c.low_pct;
+    p.high_pct  = c.high_pct;
+    p.gamma_v   = c.gamma;
+    p.area_min  = c.area_min;
+    p.EPS       = c.eps;
+    p.dy_thresh = c.dy_thresh;
+    p.dx = c.dx; p.dy = c.dy; p.tol = c.tol;
+    p.up_a = c.up_a; p.down_b = c.down_b; p.left_c = c.left_c; p.right_d = c.right_d;
+    return p;
+}
+
+void toC(const ChipParams& p, chipdetect_params& c)
+{
+    c.low_pct   = p.low_pct;
+    c.high_pct  = p.high_pct;
+    c.gamma     = p.gamma_v;
+    c.area_min  = p.area_min;
+    c.eps       = p.EPS;
+    c.dy_thresh = p.dy_thresh;
+    c.dx = p.dx; c.dy = p.dy; c.tol = p.tol;
+    c.up_a = p.up_a; c.down_b = p.down_b; c.left_c = p.left_c; c.right_d = p.right_d;
+}
+
+int fail(chipdetect_ctx* ctx, int status, const char* what)
+{
+    // 错误串的分配也可能失败，bad_alloc 不能越过 C 接口
+    if (ctx) {
+        try { ctx->error = what; } catch (...) { ctx->error.clear(); }
+    }
+    return status;
+}
+
+void fillSummary(const ChipResult& r, chipdetect_summary& s)
+{
+    s = chipdetect_summary{};
+    s.struct_size = (uint32_t)sizeof(s);
+    s.kind       = (int)r.kind;
+    s.ok         = r.ok ? 1 : 0;
+    s.rejected   = r.report.rejected ? 1 : 0;
+    s.points     = (int)r.points.size();
+    s.slots      = r.slots;
+    s.well_rows  = (int)r.wells_per_row.size();
+    s.point_rows = r.point_rows;
+    s.point_cols = r.point_cols;
+    for (int w : r.wells_per_row) s.wells += w;
+    s.low_v      = r.report.low_v;
+    s.high_v     = r.report.high_v;
+    s.otsu_th    = r.report.otsu_th;
+    s.elapsed_ms = r.report.elapsed_ms;
+    s.degrade    = r.report.degrade;
+}
+
+}
+
+extern "C" {
+
+uint32_t chipdetect_abi_version(void)
+{
+    return CHIPDETECT_ABI_VERSION;
+}
+
+const char* chipdetect_status_string(int status)
+{
+    if (status >= 0) return "ok";
+    switch (status) {
+    case CHIPDETECT_E_ARG:       return "invalid argument";
+    case CHIPDETECT_E_KIND:      return "chip kind not available";
+    case CHIPDETECT_E_BUFFER:    return "point buffer too small";
+    case CHIPDETECT_E_NOT_FOUND: return "nothing detected";
+    case CHIPDETECT_E_INTERNAL:  return "internal error";
+    default:                     return "unknown status";
+    }
+}
+
+int chipdetect_default_params(int kind, chipdetect_params* out)
+{
+    if (!out || out->struct_size < kParamsMinSize) return CHIPDETECT_E_ARG;
+    if (kind < 0 || kind >= CHIP_KIND_COUNT || !kindAvailable((ChipKind)kind)) return CHIPDETECT_E_KIND;
+    chipdetect_params c{};
+    c.struct_size = (uint32_t)sizeof(c);
+    toC(chipDefaultParams((ChipKind)kind), c);
+    writeSized(c, out);
+    return CHIPDETECT_OK;
+}
+
+chipdetect_ctx* chipdetect_create(int kind, const chipdetect_params* params)
+{
+    if (kind < 0 || kind > CHIP_AUTO || !kindAvailable((ChipKind)kind)) return nullptr;
+    if (kind == CHIP_AUTO && params) return nullptr;   // 识别出的型号用各自默认参数
+    chipdetect_params c;
+    if (params && !readParams(params, c)) return nullptr;
+    chipdetect_ctx* ctx = new (std::nothrow) chipdetect_ctx;
+    if (!ctx) return nullptr;
+    ctx->kind = (ChipKind)kind;
+    ctx->prm  = params ? fromC(c) : chipDefaultParams(ctx->kind);
+    ctx->opts.scratch = &ctx->scratch;
+    return ctx;
+}
+
+void chipdetect_destroy(chipdetect_ctx* ctx)
+{
+    delete ctx;
+}
+
+int chipdetect_set_params(chipdetect_ctx* ctx, const chipdetect_params* params)
+{
+    if (!ctx || !params) return fail(ctx, CHIPDETECT_E_ARG, "null argument");
+    if (ctx->kind == CHIP_AUTO) return fail(ctx, CHIPDETECT_E_ARG, "auto context takes no parameter overrides");
+    chipdetect_params c;
+    if (!readParams(params, c)) return fail(ctx, CHIPDETECT_E_ARG, "params.struct_size not set");
+    ctx->prm = fromC(c);
+    return CHIPDETECT_OK;
+}
+
+int chipdetect_set_param(chipdetect_ctx* ctx, const char* name, double value)
+{
+    if (!ctx || !name) return fail(ctx, CHIPDETECT_E_ARG, "null argument");
+    if (ctx->kind == CHIP_AUTO) return fail(ctx, CHIPDETECT_E_ARG, "auto context takes no parameter overrides");
+    // name 要转成 std::string，分配失败同样不能抛出 C 接口
+    try {
+        if (!setChipParam(ctx->prm, name, value)) return fail(ctx, CHIPDETECT_E_ARG, "unknown parameter");
+    } catch (...) {
+        return fail(ctx, CHIPDETECT_E_INTERNAL, "out of memory");
+    }
+    return CHIPDETECT_OK;
+}
+
+int chipdetect_set_option(chipdetect_ctx* ctx, const char* name, double value)
+{
+    if (!ctx || !name) return fail(ctx, CHIPDETECT_E_ARG, "null argument");
+    try {
+        const string n = name;
+        const bool on = value != 0.0;
+        if (n == "track_percentile") {
+            ctx->opts.percentile_tracker = on ? &ctx->tracker : nullptr;
+        } else if (n == "budget_ms") {
+            ctx->opts.deadline.budget_ms = std::max(0.0, value);
+            ctx->opts.deadline.state     = value > 0.0 ? &ctx->deadline : nullptr;
+        } else if (n == "redetect") {
+            ctx->opts.redetect.enable = on;
+        } else if (n == "lattice") {
+            ctx->opts.lattice.enable = on;
+        } else if (n == "quality_gate") {
+            ctx->opts.quality_gate = on;
+        } else {
+            return fail(ctx, CHIPDETECT_E_ARG, "unknown option");
+        }
+    } catch (...) {
+        return fail(ctx, CHIPDETECT_E_INTERNAL, "out of memory");
+    }
+    return CHIPDETECT_OK;
+}
+
+void chipdetect_reset(chipdetect_ctx* ctx)
+{
+    if (!ctx) return;
+    ctx->tracker.reset();
+    ctx->deadline = DeadlineState{};
+}
+
+int chipdetect_detect(chipdetect_ctx* ctx,
+                      const uint16_t* data, int width, int height, size_t stride_bytes,
+                      chipdetect_point* points, int capacity,
+                      chipdetect_summary* summary)
+{
+    if (!ctx) return CHIPDETECT_E_ARG;
+    ctx->error.clear();
+    const size_t row_bytes = (size_t)std::max(0, width) * sizeof(uint16_t);
+    if (stride_bytes == 0) stride_bytes = row_bytes;
+    if (!data || width <= 0 || height <= 0 || stride_bytes < row_bytes || stride_bytes % sizeof(uint16_t) ||
+        capacity < 0 || (!points && capacity > 0))
+        return fail(ctx, CHIPDETECT_E_ARG, "invalid image or buffer");
+    if (summary && summary->struct_size < kSummaryMinSize)
+        return fail(ctx, CHIPDETECT_E_ARG, "summary.struct_size not set");
+
+    // C 调用方不能接 C++ 异常（OpenCV 出错时会抛 cv::Exception）
+    try {
+        const cv::Mat img(height, width, CV_16UC1, const_cast<uint16_t*>(data), stride_bytes);
+        const bool found = detectChip(ctx->kind, img, cv::Point(0, 0),
+                                      ctx->kind == CHIP_AUTO ? nullptr : &ctx->prm, &ctx->opts, ctx->result);
+        const ChipResult& r = ctx->result;
+        if (summary) {
+            chipdetect_summary full;
+            fillSummary(r, full);
+            writeSized(full, summary);
+        }
+        if (!found) {
+            if (r.kind != CHIP_AUTO && !kindAvailable(r.kind))
+                return fail(ctx, CHIPDETECT_E_KIND, "recognised chip kind is not built into this library");
+            return fail(ctx, CHIPDETECT_E_NOT_FOUND, r.report.rejected ? "frame rejected by quality gate"
+                                                                       : "no points detected");
+        }
+
+        const int n = (int)r.points.size();
+        if (!points && capacity == 0) return n;
+        if (capacity < n) return fail(ctx, CHIPDETECT_E_BUFFER, "point buffer too small");
+        for (int i = 0; i < n; ++i) {
+            const ChipPoint& q = r.points[i];
+            chipdetect_point& o = points[i];
+            o.wr = q.wr; o.wc = q.wc; o.pr = q.pr; o.pc = q.pc;
+            o.x = q.x; o.y = q.y;
+            o.measured = q.measured ? 1 : 0;
+        }
+        return n;
+    } catch (const std::exception& e) {
+        ctx->result = ChipResult{};
+        return fail(ctx, CHIPDETECT_E_INTERNAL, e.what());
+    } catch (...) {
+        ctx->result = ChipResult{};
+        return fail(ctx, CHIPDETECT_E_INTERNAL, "unknown exception");
+    }
+}
+
+int chipdetect_anchors(const chipdetect_ctx* ctx, float* xy, int capacity)
+{
+    if (!ctx || capacity < 0) return CHIPDETECT_E_ARG;
+    const auto& a = ctx->result.report.anchors;
+    const int n = (int)a.size();
+    if (!xy) return n;
+    if (capacity < n) return CHIPDETECT_E_BUFFER;
+    for (int i = 0; i < n; ++i) {
+        xy[2 * i]     = a[i].x;
+        xy[2 * i + 1] = a[i].y;
+    }
+    return n;
+}
+
+const char* chipdetect_last_error(const chipdetect_ctx* ctx)
+{
+    return ctx ? ctx->error.c_str() : "null context";
+}
+
+}
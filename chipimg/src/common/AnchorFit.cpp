@@ -0,0 +1,89 @@
+#include "AnchorFit.h"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <limits>
+
+using namespace cv;
+using namespace std;
+
+void RowLinearFit::add(int id, const Point2f& p)
+{
+    const double x = static_cast<float>(id);
+    n    += 1.0;
+    Sx   += x;     Sxx   += x * x;
+    Sy_x += p.x;   Sxy_x += x * p.x;
+    Sy_y += p.y;   Sxy_y += x * p.y;
+}
+
+bool RowLinearFit::predict(int query_id, Point2f& out) const
+{
+    if (n < 2.0) return false;
+    const double den = n * Sxx - Sx * Sx;
+    if (std::fabs(den) < 1e-12) return false;
+    const double xq = static_cast<float>(query_id);
+    const double ax = (n * Sxy_x - Sx * Sy_x) / den;
+    const double bx = (Sy_x - ax * Sx) / n;
+    const double ay = (n * Sxy_y - Sx * Sy_y) / den;
+    const double by = (Sy_y - ay * Sx) / n;
+    out = Point2f(static_cast<float>(ax * xq + bx), static_cast<float>(ay * xq + by));
+    return true;
+}
+
+int RowGroupScanner::scan(const std::vector<Point2f>& pts, float dy_thresh, float y_tie_eps,
+                          bool want_bottom)
+{
+    gb_ = 0; gs_ = 0;
+    const int n = static_cast<int>(pts.size());
+    if (n == 0) return 0;
+
+    order_.resize(n);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [&](int ia, int ib){
+        const Point2f& a = pts[ia];
+        const Point2f& b = pts[ib];
+        const bool tie = (y_tie_eps > 0.0f) ? (std::fabs(a.y - b.y) < y_tie_eps) : (a.y == b.y);
+        if (tie) return a.x < b.x;
+        return a.y < b.y;
+    });
+
+    float best_y = want_bottom ? -1e30f : +1e30f;
+    int cur_b = 0, cnt = 0;
+    double run_mean = 0.0, sum_y = 0.0;
+
+    auto close_group = [&](int b, int c, double sy) {
+        const float inv = 1.0f / static_cast<float>(c);
+        const float my  = static_cast<float>(sy * inv);
+        if (want_bottom ? (my > best_y) : (my < best_y)) {
+            best_y = my; gb_ = b; gs_ = c;
+        }
+    };
+
+    for (int k = 0; k < n; ++k) {
+        const float y = pts[order_[k]].y;
+        if (cnt == 0) {
+            cur_b = k; cnt = 1; run_mean = y; sum_y = y;
+            continue;
+        }
+        if (std::fabs(y - run_mean) <= dy_thresh) {
+            run_mean = (run_mean * cnt + y) / (cnt + 1);
+            sum_y += y;
+            ++cnt;
+        } else {
+            close_group(cur_b, cnt, sum_y);
+            cur_b = k; cnt = 1; run_mean = y; sum_y = y;
+        }
+    }
+    if (cnt > 0) close_group(cur_b, cnt, sum_y);
+    return gs_;
+}
+
+Point2f RowGroupScanner::mean(const std::vector<Point2f>& pts) const
+{
+    if (gs_ == 0) return Point2f(numeric_limits<float>::quiet_NaN(),
+                                 numeric_limits<float>::quiet_NaN());
+    double sx = 0.0, sy = 0.0;
+    for (const int* it = begin(); it != end(); ++it) { sx += pts[*it].x; sy += pts[*it].y; }
+    const float inv = 1.0f / static_cast<float>(gs_);
+    return Point2f(static_cast<float>(sx * inv), static_cast<float>(sy * inv));
+}
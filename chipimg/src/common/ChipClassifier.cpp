@@ -0,0 +1,192 @@
+#include "ChipClassifier.h"
+#include "GridKernel.h"
+#include "PercentileEstimator.h"
+#include "StageGraph.h"
+#include "StripedBlobs.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+// 通用增强参数，只用于提特征：高端百分位取得很小，拉伸上限落在斑点内，背景噪声压到 Otsu 阈值以下
+constexpr double kLowPct   = 0.005;
+constexpr double kHighPct  = 0.001;
+constexpr float  kGamma    = 1.3f;
+constexpr int    kBandRows = 256;
+constexpr int    kAreaMin  = 3;
+constexpr float  kLargeSpotArea = 60.f;
+
+// pitch 取 ShapeDetectionAPI_*.h 里 dx / dy 的默认值；std 按默认 6x3 点阵，靠斑点大小区分，不比间距
+const ChipProfile kProfiles[] = {
+    { CHIP_C5,  (float)GridLayoutC5::size,  9.0f,  9.0f, false },
+    { CHIP_4X,  (float)GridLayout4X::size,  9.5f,  9.5f, false },
+    { CHIP_GMY, (float)GridLayoutGMY::size, 7.0f,  7.0f, false },
+    { CHIP_PG,  (float)GridLayoutPG::size, 10.0f, 19.0f, false },
+    { CHIP_STD, 18.0f,                     30.0f, 30.0f, true  },
+};
+
+float median(vector<float>& v)
+{
+    if (v.empty()) return 0.f;
+    std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+    return v[v.size() / 2];
+}
+}
+
+const ChipProfile* chipProfiles(int* count)
+{
+    if (count) *count = (int)(sizeof(kProfiles) / sizeof(kProfiles[0]));
+    return kProfiles;
+}
+
+namespace {
+// 连通域 -> 孔数、孔内点数、点间距；f.low_v / high_v 由调用方填
+void featuresFromBlobs(const vector<BlobStat>& blobs, ChipFeatures& f)
+{
+    vector<Point2f> pts;
+    vector<float> areas;
+    for (const BlobStat& b : blobs) {
+        if (b.area < kAreaMin) continue;
+        pts.push_back(b.centroid);
+        areas.push_back((float)b.area);
+    }
+    f.blobs = (int)pts.size();
+    if (pts.empty()) return;
+    f.median_area = median(areas);
+
+    // 按中心距聚成孔：小斑点用流水线的 EPS，大斑点按斑点直径放大。
+    // 点按 eps 见方的格子分桶，只和本格及相邻 8 格比，不做全对比较
+    const float eps = std::max(35.f, 3.f * std::sqrt(f.median_area));
+    const int N = (int)pts.size();
+    vector<int> parent(N);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int x){ while (parent[x] != x) x = parent[x] = parent[parent[x]]; return x; };
+    auto cellKey = [](int cx, int cy){ return (long long)(((unsigned long long)(unsigned)cx << 32) | (unsigned)cy); };
+    unordered_map<long long, vector<int>> cells;
+    cells.reserve(N);
+    vector<int> cx(N), cy(N);
+    for (int i = 0; i < N; ++i) {
+        cx[i] = (int)std::floor(pts[i].x / eps);
+        cy[i] = (int)std::floor(pts[i].y / eps);
+        cells[cellKey(cx[i], cy[i])].push_back(i);
+    }
+    for (int i = 0; i < N; ++i)
+        for (int oy = -1; oy <= 1; ++oy)
+            for (int ox = -1; ox <= 1; ++ox) {
+                auto it = cells.find(cellKey(cx[i] + ox, cy[i] + oy));
+                if (it == cells.end()) continue;
+                for (int j : it->second) {
+                    if (j <= i) continue;
+                    const Point2f d = pts[i] - pts[j];
+                    if (d.x * d.x + d.y * d.y <= eps * eps) parent[find(i)] = find(j);
+                }
+            }
+    vector<vector<int>> groups(N);
+    for (int i = 0; i < N; ++i) groups[find(i)].push_back(i);
+
+    vector<float> counts, px, py;
+    for (const auto& g : groups) {
+        if (g.size() < 3) continue;
+        counts.push_back((float)g.size());
+        for (int i : g) {
+            float bx = FLT_MAX, by = FLT_MAX;
+            for (int j : g) {
+                if (j == i) continue;
+                const float dx = std::fabs(pts[j].x - pts[i].x), dy = std::fabs(pts[j].y - pts[i].y);
+                if (dy < 0.5f * dx) bx = std::min(bx, dx);
+                else if (dx < 0.5f * dy) by = std::min(by, dy);
+            }
+            if (bx < FLT_MAX) px.push_back(bx);
+            if (by < FLT_MAX) py.push_back(by);
+        }
+    }
+    f.clusters = (int)counts.size();
+    f.pts_per_cluster = median(counts);
+    f.pitch_x = median(px);
+    f.pitch_y = median(py);
+}
+
+bool classifyFeatures(ChipClass& out)
+{
+    const ChipFeatures& f = out.features;
+    if (f.blobs == 0) return false;
+
+    // 对数比距离：点数、横纵间距各一项；斑点大小不符直接加大惩罚
+    auto term = [](float v, float ref){ return (v > 0.f && ref > 0.f) ? std::fabs(std::log(v / ref)) : 1.f; };
+    const bool large = f.median_area >= kLargeSpotArea;
+
+    int n = 0;
+    const ChipProfile* prof = chipProfiles(&n);
+    float best = FLT_MAX, second = FLT_MAX;
+    for (int i = 0; i < n; ++i) {
+        const ChipProfile& p = prof[i];
+        float d = (p.large_spots != large) ? 4.f : 0.f;
+        d += term(f.pts_per_cluster, p.pts_per_well);
+        if (!p.large_spots) d += term(f.pitch_x, p.pitch_x) + term(f.pitch_y, p.pitch_y);
+        if (d < best) { second = best; best = d; out.kind = p.kind; }
+        else if (d < second) second = d;
+    }
+    out.score  = best;
+    out.margin = second - best;
+    return true;
+}
+}
+
+bool computeChipFeatures(const cv::Mat& src16, const uint32_t* hist16, ChipFeatures& f)
+{
+    f = ChipFeatures{};
+    if (src16.empty() || src16.type() != CV_16UC1) return false;
+
+    vector<uint32_t> own;
+    if (!hist16) {
+        own.assign(65536, 0u);
+        accumulateHistogram16U(src16, 0, src16.rows, own.data());
+        hist16 = own.data();
+    }
+    percentileFromHistogram16U(hist16, 1LL * src16.rows * src16.cols, kLowPct, kHighPct,
+                               f.low_v, f.high_v);
+
+    // 分带求连通域，不生成整帧中间图
+    vector<uint8_t> lut;
+    buildEnhanceLut8(f.low_v, f.high_v, kGamma, lut);
+    vector<BlobStat> blobs;
+    if (!stripedBlobs16U(src16, lut, hist16, -1.0, 1.0, kBandRows, blobs)) return false;
+    featuresFromBlobs(blobs, f);
+    return true;
+}
+
+bool computeChipFeatures(FrameStages& stages, ChipFeatures& f)
+{
+    f = ChipFeatures{};
+    const Mat& src16 = stages.frame();
+    if (src16.empty() || src16.type() != CV_16UC1) return false;
+    // 与单帧路径一样按 kBandRows 分带求连通域（结果与整帧路径略有差别，单独成一个阶段）
+    auto p = stages.percentiles(kLowPct, kHighPct);
+    auto bs = stages.cache().get<BlobSet>(stageKey("classify_blobs", p->low_v, p->high_v), [&]{
+        auto h = stages.histogram();
+        BlobSet b;
+        computeBlobSet(src16, p->low_v, p->high_v, kGamma, ENH_PLAIN, -1.0, 1.0, kBandRows, h->data(), b);
+        return b;
+    });
+    f.low_v  = bs->low_v;
+    f.high_v = bs->high_v;
+    featuresFromBlobs(bs->blobs, f);
+    return true;
+}
+
+bool classifyChip(const cv::Mat& src16, const uint32_t* hist16, ChipClass& out)
+{
+    out = ChipClass{};
+    return computeChipFeatures(src16, hist16, out.features) && classifyFeatures(out);
+}
+
+bool classifyChip(FrameStages& stages, ChipClass& out)
+{
+    out = ChipClass{};
+    return computeChipFeatures(stages, out.features) && classifyFeatures(out);
+}
@@ -0,0 +1,131 @@
+#include "ChipDispatch.h"
+#include "StdParams.h"
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* kChipKindNames[CHIP_KIND_COUNT] = { "C5", "4X", "GMY", "PG", "std" };
+
+const char* chipKindName(ChipKind k)
+{
+    if (k == CHIP_AUTO) return "auto";
+    return (k >= 0 && k < CHIP_KIND_COUNT) ? kChipKindNames[k] : "?";
+}
+
+bool parseChipKind(const char* s, ChipKind& k)
+{
+    if (!s) return false;
+    if (strcmp(s, "auto") == 0) { k = CHIP_AUTO; return true; }
+    for (int i = 0; i < CHIP_KIND_COUNT; ++i) {
+        const char* a = s;
+        const char* b = kChipKindNames[i];
+        while (*a && *b && tolower((unsigned char)*a) == tolower((unsigned char)*b)) { ++a; ++b; }
+        if (!*a && !*b) { k = (ChipKind)i; return true; }
+    }
+    return false;
+}
+
+ChipParams chipDefaultParams(ChipKind k)
+{
+    ChipParams p;
+    switch (k) {
+    case CHIP_C5:
+        p.low_pct = 0.0041; p.high_pct = 0.0379; p.gamma_v = 1.78; p.area_min = 6; p.EPS = 30.0f;
+        p.dy_thresh = 7.0f; p.dx = 9.0f; p.dy = 9.0f; p.tol = 3.0f;
+        p.up_a = 48.0f; p.down_b = 5.0f; p.left_c = 27.0f; p.right_d = 26.0f;
+        break;
+    case CHIP_4X:
+        p.low_pct = 0.02; p.high_pct = 0.0058; p.gamma_v = 1.2; p.area_min = 6; p.EPS = 30.0f;
+        p.dy_thresh = 7.0f; p.dx = 9.5f; p.dy = 9.5f; p.tol = 5.0f;
+        p.up_a = 5.0f; p.down_b = 48.0f; p.left_c = 28.0f; p.right_d = 28.0f;
+        break;
+    case CHIP_GMY:
+        p.low_pct = 0.001; p.high_pct = 0.010; p.gamma_v = 1.4; p.area_min = 5; p.EPS = 35.0f;
+        p.dy_thresh = 5.0f; p.dx = 7.0f; p.dy = 7.0f; p.tol = 4.0f;
+        p.up_a = 50.0f; p.down_b = 5.0f; p.left_c = 28.0f; p.right_d = 28.0f;
+        break;
+    case CHIP_PG:
+        p.low_pct = 0.013; p.high_pct = 0.023; p.gamma_v = 0.86; p.area_min = 6; p.EPS = 35.0f;
+        p.dy_thresh = 7.0f; p.dx = 10.0f; p.dy = 19.0f; p.tol = 4.0f;
+        p.up_a = 50.0f; p.down_b = 5.0f; p.left_c = 28.0f; p.right_d = 28.0f;
+        break;
+    case CHIP_STD:
+        p.low_pct = kStdLowPct; p.high_pct = kStdHighPct; p.gamma_v = kStdGamma; p.area_min = kStdAreaMin;
+        break;
+    default:
+        break;
+    }
+    return p;
+}
+
+EnhanceMode chipEnhanceMode(ChipKind k)
+{
+    return (k == CHIP_4X || k == CHIP_GMY) ? ENH_CLAHE : ENH_PLAIN;
+}
+
+namespace {
+struct ParamField {
+    const char* name;
+    double ChipParams::* d;
+    float  ChipParams::* f;
+    int    ChipParams::* i;
+};
+
+const ParamField kFields[] = {
+    { "low_pct",   &ChipParams::low_pct,  nullptr, nullptr },
+    { "high_pct",  &ChipParams::high_pct, nullptr, nullptr },
+    { "gamma",     &ChipParams::gamma_v,  nullptr, nullptr },
+    { "area_min",  nullptr, nullptr, &ChipParams::area_min },
+    { "eps",       nullptr, &ChipParams::EPS,       nullptr },
+    { "dy_thresh", nullptr, &ChipParams::dy_thresh, nullptr },
+    { "dx",        nullptr, &ChipParams::dx,        nullptr },
+    { "dy",        nullptr, &ChipParams::dy,        nullptr },
+    { "tol",       nullptr, &ChipParams::tol,       nullptr },
+    { "up_a",      nullptr, &ChipParams::up_a,      nullptr },
+    { "down_b",    nullptr, &ChipParams::down_b,    nullptr },
+    { "left_c",    nullptr, &ChipParams::left_c,    nullptr },
+    { "right_d",   nullptr, &ChipParams::right_d,   nullptr },
+};
+
+const ParamField* findField(const std::string& name)
+{
+    for (const auto& f : kFields) if (name == f.name) return &f;
+    return nullptr;
+}
+
+}
+
+bool setChipParam(ChipParams& p, const std::string& name, double v)
+{
+    const ParamField* f = findField(name);
+    if (!f) return false;
+    if (f->d) p.*(f->d) = v;
+    else if (f->f) p.*(f->f) = (float)v;
+    else p.*(f->i) = (int)std::lround(v);
+    return true;
+}
+
+bool getChipParam(const ChipParams& p, const std::string& name, double& v)
+{
+    const ParamField* f = findField(name);
+    if (!f) return false;
+    v = f->d ? p.*(f->d) : f->f ? (double)(p.*(f->f)) : (double)(p.*(f->i));
+    return true;
+}
+
+const std::vector<std::string>& chipParamNames()
+{
+    static const std::vector<std::string> names = []{
+        std::vector<std::string> n;
+        for (const auto& f : kFields) n.push_back(f.name);
+        return n;
+    }();
+    return names;
+}
+
+bool chipParamUsed(ChipKind k, const std::string& name)
+{
+    return findField(name) && k != CHIP_STD && k != CHIP_AUTO;
+}
@@ -0,0 +1,98 @@
+#include "DeadlineBudget.h"
+#include "DetectOptions.h"
+#include <algorithm>
+
+DeadlineClock::DeadlineClock(const DeadlineParams& p)
+    : p_(p), t0_(clock::now())
+{
+    for (double& m : measured_) m = -1.0;
+}
+
+double DeadlineClock::elapsedMs() const
+{
+    return std::chrono::duration<double, std::milli>(clock::now() - t0_).count();
+}
+
+bool DeadlineClock::shouldDegrade(DeadlineStage s, int shortcut, bool available)
+{
+    if (p_.budget_ms <= 0.0 || !available) return false;
+    // 没有历史时只看本帧已用时间：已经超了，剩下的能省则省
+    double predicted = elapsedMs();
+    if (p_.state)
+        for (int t = s; t < DL_STAGE_COUNT; ++t) predicted += p_.state->stage_ms[t];
+    if (predicted <= p_.budget_ms) return false;
+    shortcuts_ |= shortcut;
+    return true;
+}
+
+cv::Rect DeadlineClock::reusableRoi(const cv::Size& img_size) const
+{
+    if (!p_.state || p_.state->roi.area() <= 0) return cv::Rect();
+    const cv::Rect full(0, 0, img_size.width, img_size.height);
+    const cv::Rect r = p_.state->roi;
+    if ((r & full) != r || r == full) return cv::Rect();
+    return r;
+}
+
+bool DeadlineClock::latticeStale() const
+{
+    const DeadlineState* st = p_.state;
+    if (!st) return false;
+    return !st->lattice.valid || st->lattice_frame < 0 || st->last_over_budget ||
+           st->frames - st->lattice_frame >= std::max(1, p_.lattice_refit_frames);
+}
+
+void DeadlineClock::record(DeadlineStage s, double ms, bool cheap)
+{
+    if (s != DL_CLAHE) spent_ += ms;   // CLAHE 嵌在 DL_LABEL 内计时
+    if (!cheap) measured_[s] = (measured_[s] < 0.0 ? 0.0 : measured_[s]) + ms;
+}
+
+void DeadlineClock::finish(SD_Report* report)
+{
+    const double elapsed = elapsedMs();
+    const bool over = p_.budget_ms > 0.0 && elapsed > p_.budget_ms;
+    if (report) {
+        report->degrade     = shortcuts_;
+        report->elapsed_ms  = elapsed;
+        report->over_budget = over;
+    }
+
+    DeadlineState* st = p_.state;
+    if (!st) return;
+    if (measured_[DL_LABEL] > 0.0 && measured_[DL_CLAHE] > 0.0)
+        measured_[DL_LABEL] = std::max(0.0, measured_[DL_LABEL] - measured_[DL_CLAHE]);
+    measured_[DL_TAIL] = std::max(0.0, elapsed - spent_);
+    for (int s = 0; s < DL_STAGE_COUNT; ++s) {
+        if (measured_[s] < 0.0) continue;
+        double& e = st->stage_ms[s];
+        e = (e <= 0.0) ? measured_[s] : e + p_.ema_alpha * (measured_[s] - e);
+    }
+    if (roi_.area() > 0) st->roi = roi_;
+    if (has_lattice_ && lattice_.valid) {
+        st->lattice = lattice_;
+        st->anchor_offset = offset_;
+        st->lattice_frame = st->frames;
+    }
+    st->last_over_budget = over;
+    ++st->frames;
+    if (shortcuts_) ++st->degraded_frames;
+    if (over) ++st->over_budget_frames;
+}
+
+std::string degradeSummary(int shortcuts)
+{
+    static const struct { int bit; const char* name; } kNames[] = {
+        { DG_SAMPLED_PERCENTILE, "sampled_percentile" },
+        { DG_SKIP_CLAHE,         "skip_clahe" },
+        { DG_ROI_LABELLING,      "roi_labelling" },
+        { DG_LATTICE_ANCHORS,    "lattice_anchors" },
+    };
+    std::string s;
+    for (const auto& n : kNames) {
+        if (!(shortcuts & n.bit)) continue;
+        if (!s.empty()) s += '+';
+        s += n.name;
+    }
+    return s.empty() ? std::string("none") : s;
+}
@@ -0,0 +1,38 @@
+#include "DebugSink.h"
+#include <algorithm>
+
+DebugImageCollector::DebugImageCollector(std::vector<std::string> stages)
+    : stages_(std::move(stages)) {}
+
+bool DebugImageCollector::wants(const char* stage) const
+{
+    return stages_.empty() || std::find(stages_.begin(), stages_.end(), stage) != stages_.end();
+}
+
+void DebugImageCollector::publish(const char* stage, const cv::Mat& img)
+{
+    cv::Mat copy = img.clone();
+    std::lock_guard<std::mutex> lk(mtx_);
+    images_[stage] = copy;
+}
+
+cv::Mat DebugImageCollector::get(const std::string& stage) const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    auto it = images_.find(stage);
+    return it == images_.end() ? cv::Mat() : it->second;
+}
+
+std::vector<std::string> DebugImageCollector::names() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    std::vector<std::string> n;
+    for (const auto& kv : images_) n.push_back(kv.first);
+    return n;
+}
+
+void DebugImageCollector::clear()
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    images_.clear();
+}
@@ -0,0 +1,192 @@
+#include "FramePrefetch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#if defined(CHIP_HAVE_LIBPNG)
+#include <png.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+FrameBufferPool::FrameBufferPool(size_t max_cached) : st_(std::make_shared<State>())
+{
+    st_->max_cached = max_cached;
+}
+
+std::shared_ptr<cv::Mat> FrameBufferPool::acquire(int rows, int cols, int type)
+{
+    Mat m;
+    {
+        lock_guard<mutex> lk(st_->mtx);
+        auto it = std::find_if(st_->free.begin(), st_->free.end(), [&](const Mat& f){
+            // rows/cols 为 0 表示尺寸未知，任取同类型缓冲（解码时尺寸一致就直接复用）
+            if (f.type() != type) return false;
+            return (rows == 0 && cols == 0) || (f.rows == rows && f.cols == cols);
+        });
+        if (it != st_->free.end()) { m = *it; st_->free.erase(it); }
+    }
+    if (m.empty() && rows > 0 && cols > 0) m.create(rows, cols, type);
+
+    // 池对象先析构时 weak_ptr 失效，缓冲直接释放
+    weak_ptr<State> ws = st_;
+    return shared_ptr<Mat>(new Mat(m), [ws](Mat* p){
+        if (auto s = ws.lock()) {
+            lock_guard<mutex> lk(s->mtx);
+            if (s->free.size() < s->max_cached) s->free.push_back(*p);
+        }
+        delete p;
+    });
+}
+
+size_t FrameBufferPool::cached() const
+{
+    lock_guard<mutex> lk(st_->mtx);
+    return st_->free.size();
+}
+
+#if defined(CHIP_HAVE_LIBPNG)
+bool decodePng16Bands(const std::string& path, cv::Mat& dst16, int band_rows,
+                      const std::function<void(int, int)>& on_band)
+{
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    png_byte sig[8];
+    if (fread(sig, 1, 8, fp) != 8 || png_sig_cmp(sig, 0, 8) != 0) { fclose(fp); return false; }
+
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+    png_infop info = png ? png_create_info_struct(png) : nullptr;
+    if (!info) { png_destroy_read_struct(&png, nullptr, nullptr); fclose(fp); return false; }
+    if (setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        fclose(fp);
+        return false;
+    }
+
+    png_init_io(png, fp);
+    png_set_sig_bytes(png, 8);
+    png_read_info(png, info);
+    const png_uint_32 w = png_get_image_width(png, info);
+    const png_uint_32 h = png_get_image_height(png, info);
+    const int depth  = png_get_bit_depth(png, info);
+    const int ctype  = png_get_color_type(png, info);
+    const int interl = png_get_interlace_type(png, info);
+    if (depth != 16 || ctype != PNG_COLOR_TYPE_GRAY || interl != PNG_INTERLACE_NONE) {
+        png_destroy_read_struct(&png, &info, nullptr);
+        fclose(fp);
+        return false;
+    }
+    // PNG 为大端，转成主机小端
+    png_set_swap(png);
+    png_read_update_info(png, info);
+
+    if (dst16.rows != (int)h || dst16.cols != (int)w || dst16.type() != CV_16UC1)
+        dst16.create((int)h, (int)w, CV_16UC1);
+
+    const int band = std::max(1, band_rows);
+    int row0 = 0;
+    for (int r = 0; r < (int)h; ++r) {
+        png_read_row(png, dst16.ptr<png_byte>(r), nullptr);
+        if (r + 1 - row0 == band || r + 1 == (int)h) {
+            if (on_band) on_band(row0, r + 1 - row0);
+            row0 = r + 1;
+        }
+    }
+    png_read_end(png, nullptr);
+    png_destroy_read_struct(&png, &info, nullptr);
+    fclose(fp);
+    return true;
+}
+#else
+bool decodePng16Bands(const std::string&, cv::Mat&, int, const std::function<void(int, int)>&)
+{
+    return false;
+}
+#endif
+
+FramePrefetcher::FramePrefetcher(std::vector<std::string> paths, const PrefetchParams& p)
+    : paths_(std::move(paths)), p_(p), pool_((size_t)std::max(1, p.max_ahead))
+{
+    p_.workers   = std::max(1, p_.workers);
+    p_.max_ahead = std::max(1, p_.max_ahead);
+    for (int i = 0; i < p_.workers; ++i) threads_.emplace_back(&FramePrefetcher::worker, this);
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    {
+        lock_guard<mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+void FramePrefetcher::decodeOne(int idx, PrefetchedFrame& f)
+{
+    const auto t0 = chrono::steady_clock::now();
+    f.index = idx;
+    f.path  = paths_[idx];
+    if (p_.with_histogram) f.hist.assign(65536, 0u);
+
+    // 先试行带解码（缓冲来自池），每个行带解完就顺带统计直方图
+    auto buf = pool_.acquire(0, 0, CV_16UC1);
+    auto on_band = [&](int row0, int rows){
+        if (!p_.with_histogram) return;
+        for (int r = row0; r < row0 + rows; ++r) {
+            const uint16_t* q = buf->ptr<uint16_t>(r);
+            for (int c = 0; c < buf->cols; ++c) f.hist[q[c]]++;
+        }
+    };
+    bool ok = decodePng16Bands(f.path, *buf, p_.band_rows, on_band);
+    if (!ok) {
+        // 行带解码可能中途失败，已统计的部分作废；像素拷进池里的缓冲，池不会因此换成 imread 的分配
+        if (p_.with_histogram) std::fill(f.hist.begin(), f.hist.end(), 0u);
+        Mat m = imread(f.path, IMREAD_UNCHANGED);
+        if (!m.empty() && m.type() == CV_16UC1) {
+            m.copyTo(*buf);
+            on_band(0, m.rows);
+            ok = true;
+        }
+    }
+    if (ok) f.img = buf;
+    else    f.hist.clear();
+    f.decode_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+void FramePrefetcher::worker()
+{
+    for (;;) {
+        int idx;
+        {
+            unique_lock<mutex> lk(mtx_);
+            cv_.wait(lk, [&]{
+                return stop_ || next_issue_ >= (int)paths_.size() ||
+                       next_issue_ < next_take_ + p_.max_ahead;
+            });
+            if (stop_ || next_issue_ >= (int)paths_.size()) return;
+            idx = next_issue_++;
+        }
+        PrefetchedFrame f;
+        decodeOne(idx, f);
+        {
+            lock_guard<mutex> lk(mtx_);
+            ready_[idx] = std::move(f);
+        }
+        cv_.notify_all();
+    }
+}
+
+bool FramePrefetcher::next(PrefetchedFrame& out)
+{
+    unique_lock<mutex> lk(mtx_);
+    if (next_take_ >= (int)paths_.size()) return false;
+    cv_.wait(lk, [&]{ return ready_.count(next_take_) > 0; });
+    auto it = ready_.find(next_take_);
+    out = std::move(it->second);
+    ready_.erase(it);
+    ++next_take_;
+    lk.unlock();
+    cv_.notify_all();
+    return true;
+}
@@ -0,0 +1,127 @@
+#include "FrameQuality.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+struct LapAcc {
+    double    sum = 0.0, sq = 0.0;
+    long long n   = 0;
+    void add(const uint16_t* pu, const uint16_t* p, const uint16_t* pd, int cols, int s) {
+        for (int c = s; c + s < cols; c += s) {
+            const double lap = (double)pu[c] + pd[c] + p[c - s] + p[c + s] - 4.0 * p[c];
+            sum += lap;
+            sq  += lap * lap;
+            ++n;
+        }
+    }
+};
+
+// 直方图之后的部分：百分位、饱和、动态范围、前景比例与判定
+template <class CountT>
+void finishQuality(const CountT* hist, long long total, const LapAcc& lap,
+                   double low_pct, double high_pct, double gamma_v,
+                   const FrameQualityParams& qp,
+                   uint16_t& low_v, uint16_t& high_v, FrameQualityStats& qs)
+{
+    static const int BINS = 65536;
+    if (total == 0) {
+        low_v = 0; high_v = 65535;
+        qs.fail_mask = FQ_LOW_RANGE;
+        qs.rejected  = qp.reject;
+        return;
+    }
+    const long long low_count  = (long long)std::llround(total * low_pct);
+    const long long high_count = (long long)std::llround(total * (1.0 - high_pct));
+
+    long long acc = 0; int i = 0;
+    for (; i < BINS; ++i) { acc += hist[i]; if (acc >= low_count) break; }
+    low_v = (uint16_t)std::min(i, BINS - 1);
+
+    acc = 0;
+    for (i = BINS - 1; i >= 0; --i) { acc += hist[i]; if (acc >= (total - high_count)) break; }
+    high_v = (uint16_t)std::max(i, 0);
+
+    qs.dynamic_range = (int)high_v - (int)low_v;
+    if (low_v >= high_v) { low_v = 0; high_v = 65535; }
+
+    long long sat = 0;
+    for (int v = std::min(std::max(qp.saturation_level, 0), BINS - 1); v < BINS; ++v) sat += hist[v];
+    qs.saturated_frac = (double)sat / (double)total;
+
+    if (lap.n > 0) {
+        const double m = lap.sum / (double)lap.n;
+        qs.focus_var   = std::max(0.0, lap.sq / (double)lap.n - m * m);
+        qs.focus_score = std::sqrt(qs.focus_var) / (double)std::max(1, qs.dynamic_range);
+    }
+
+    // 前景阈值取拉伸+gamma 后 fg_level 处对应的原始灰度
+    const double g   = (gamma_v > 0.0) ? gamma_v : 1.0;
+    const double lvl = std::min(1.0, std::max(0.0, qp.fg_level));
+    const int fg_th  = (int)std::ceil(low_v + (high_v - low_v) * std::pow(lvl, 1.0 / g));
+    long long fg = 0;
+    for (int v = std::min(std::max(fg_th, 0), BINS - 1); v < BINS; ++v) fg += hist[v];
+    qs.fg_frac = (double)fg / (double)total;
+
+    int mask = FQ_OK;
+    if (qp.max_saturated_frac >= 0.0 && qs.saturated_frac > qp.max_saturated_frac) mask |= FQ_SATURATED;
+    if (qs.dynamic_range < qp.min_dynamic_range)                                    mask |= FQ_LOW_RANGE;
+    if (qp.min_focus > 0.0 && qs.focus_score < qp.min_focus)                        mask |= FQ_OUT_OF_FOCUS;
+    if (qp.expected_fg_frac >= 0.0 &&
+        std::fabs(qs.fg_frac - qp.expected_fg_frac) > qp.fg_frac_tol)               mask |= FQ_FG_MISMATCH;
+    qs.fail_mask = mask;
+    qs.rejected  = qp.reject && mask != FQ_OK;
+}
+
+}
+
+// 与各版本 findPercentile16U 相同的直方图遍历，同时在 focus_step 子采样网格上累计拉普拉斯方差，
+// 饱和比例、动态范围和前景比例都直接由直方图得到，不再额外读图。
+void findPercentile16UWithQuality(const Mat& img16,
+                                  double low_pct, double high_pct, double gamma_v,
+                                  const FrameQualityParams& qp,
+                                  uint16_t& low_v, uint16_t& high_v,
+                                  FrameQualityStats& qs)
+{
+    CV_Assert(img16.type() == CV_16UC1);
+    vector<int> hist(65536, 0);
+    qs = FrameQualityStats{};
+
+    const int s = std::max(1, qp.focus_step);
+    LapAcc lap;
+    for (int r = 0; r < img16.rows; ++r) {
+        const uint16_t* p = img16.ptr<uint16_t>(r);
+        for (int c = 0; c < img16.cols; ++c) hist[p[c]]++;
+
+        if (r % s != 0 || r < s || r + s >= img16.rows) continue;
+        lap.add(img16.ptr<uint16_t>(r - s), p, img16.ptr<uint16_t>(r + s), img16.cols, s);
+    }
+    finishQuality(hist.data(), 1LL * img16.rows * img16.cols, lap,
+                  low_pct, high_pct, gamma_v, qp, low_v, high_v, qs);
+}
+
+// 已有直方图：只剩子采样网格上的清晰度要读像素（约 3/focus_step 的行）
+void findPercentile16UWithQuality(const Mat& img16, const uint32_t* hist,
+                                  double low_pct, double high_pct, double gamma_v,
+                                  const FrameQualityParams& qp,
+                                  uint16_t& low_v, uint16_t& high_v,
+                                  FrameQualityStats& qs)
+{
+    if (!hist) {
+        findPercentile16UWithQuality(img16, low_pct, high_pct, gamma_v, qp, low_v, high_v, qs);
+        return;
+    }
+    CV_Assert(img16.type() == CV_16UC1);
+    qs = FrameQualityStats{};
+
+    const int s = std::max(1, qp.focus_step);
+    LapAcc lap;
+    for (int r = s; r + s < img16.rows; r += s)
+        lap.add(img16.ptr<uint16_t>(r - s), img16.ptr<uint16_t>(r), img16.ptr<uint16_t>(r + s), img16.cols, s);
+    finishQuality(hist, 1LL * img16.rows * img16.cols, lap,
+                  low_pct, high_pct, gamma_v, qp, low_v, high_v, qs);
+}
@@ -0,0 +1,132 @@
+#include "LatticeModel.h"
+#include "LocalRedetect.h"
+#include <random>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+// 设计矩阵行 [1, r, c]，x / y 两个方向共用同一组法方程
+struct Normal3 {
+    double A[3][3] = {};
+    double bx[3] = {}, by[3] = {};
+    void add(const LatticeSample& s, double w) {
+        const double f[3] = {1.0, (double)s.row, (double)s.col};
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) A[i][j] += w * f[i] * f[j];
+            bx[i] += w * f[i] * s.p.x;
+            by[i] += w * f[i] * s.p.y;
+        }
+    }
+};
+
+inline double det3(const double M[3][3]) {
+    return M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1])
+         - M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+         + M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+}
+
+bool solve3(const double A[3][3], const double b[3], double x[3]) {
+    const double d = det3(A);
+    if (std::fabs(d) < 1e-9) return false;
+    for (int k = 0; k < 3; ++k) {
+        double M[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j) M[i][j] = (j == k) ? b[i] : A[i][j];
+        x[k] = det3(M) / d;
+    }
+    return true;
+}
+
+bool solveModel(const Normal3& ne, LatticeModel& m) {
+    double sx[3], sy[3];
+    if (!solve3(ne.A, ne.bx, sx) || !solve3(ne.A, ne.by, sy)) return false;
+    m.origin  = Point2f((float)sx[0], (float)sy[0]);
+    m.row_vec = Point2f((float)sx[1], (float)sy[1]);
+    m.col_vec = Point2f((float)sx[2], (float)sy[2]);
+    return true;
+}
+
+inline float residual(const LatticeModel& m, const LatticeSample& s) {
+    const Point2f d = m.predict(s.row, s.col) - s.p;
+    return std::sqrt(d.x * d.x + d.y * d.y);
+}
+
+}
+
+int LatticeModel::nearestCol(int r, const Point2f& p) const {
+    const float n2 = col_vec.dot(col_vec);
+    if (n2 <= 1e-12f) return 0;
+    const Point2f d = p - origin - row_vec * (float)r;
+    return (int)std::lround(d.dot(col_vec) / n2);
+}
+
+bool fitLatticeModel(const std::vector<LatticeSample>& samples, const LatticeParams& p,
+                     LatticeModel& out, std::vector<char>* inlier_mask)
+{
+    out = LatticeModel{};
+    const int n = (int)samples.size();
+    out.samples = n;
+    if (inlier_mask) inlier_mask->assign(n, 0);
+    if (n < 3) return false;
+
+    // RANSAC：每次取 3 个 (r,c) 不共线的样本精确求解
+    std::mt19937 rng(p.seed);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    LatticeModel best;
+    int best_cnt = 0; double best_err = 1e30;
+    for (int it = 0; it < std::max(1, p.ransac_iters); ++it) {
+        const int a = pick(rng), b = pick(rng), c = pick(rng);
+        if (a == b || b == c || a == c) continue;
+        Normal3 ne;
+        ne.add(samples[a], 1.0); ne.add(samples[b], 1.0); ne.add(samples[c], 1.0);
+        LatticeModel m;
+        if (!solveModel(ne, m)) continue;
+        int cnt = 0; double err = 0.0;
+        for (const auto& s : samples) {
+            const float r = residual(m, s);
+            if (r <= p.inlier_tol) { ++cnt; err += r; }
+        }
+        if (cnt > best_cnt || (cnt == best_cnt && err < best_err)) {
+            best = m; best_cnt = cnt; best_err = err;
+        }
+    }
+    if (best_cnt < 3) return false;
+
+    // 内点上的 Huber IRLS：|res| <= delta 权重 1，否则 delta/|res|；RANSAC 外点权重 0
+    LatticeModel m = best;
+    for (int it = 0; it < std::max(0, p.irls_iters); ++it) {
+        Normal3 ne;
+        for (const auto& s : samples) {
+            const float r = residual(m, s);
+            if (r > p.inlier_tol) continue;
+            ne.add(s, (r <= p.huber_delta) ? 1.0 : p.huber_delta / r);
+        }
+        LatticeModel nm;
+        if (!solveModel(ne, nm)) break;
+        m = nm;
+    }
+
+    int cnt = 0; double se = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const float r = residual(m, samples[i]);
+        if (r > p.inlier_tol) continue;
+        ++cnt; se += (double)r * r;
+        if (inlier_mask) (*inlier_mask)[i] = 1;
+    }
+    m.samples = n;
+    m.inliers = cnt;
+    m.rms     = cnt ? (float)std::sqrt(se / cnt) : 0.f;
+    m.valid   = (cnt >= std::max(3, p.min_inliers));
+    out = m;
+    return m.valid;
+}
+
+cv::Rect latticeWellWindow(const LatticeModel& m, int r, int c,
+                           float up_a, float down_b, float left_c, float right_d,
+                           const cv::Size& img_size)
+{
+    if (!m.valid) return Rect();
+    return anchorWindowRect(m.predict(r, c), up_a, down_b, left_c, right_d, img_size);
+}
@@ -0,0 +1,72 @@
+#include "LocalRedetect.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+cv::Rect anchorWindowRect(const Point2f& anchor,
+                          float up_a, float down_b, float left_c, float right_d,
+                          const Size& img_size)
+{
+    if (!std::isfinite(anchor.x) || !std::isfinite(anchor.y)) return Rect();
+    const int x0 = cvFloor(anchor.x - left_c);
+    const int y0 = cvFloor(anchor.y - up_a);
+    const int x1 = cvCeil(anchor.x + right_d);
+    const int y1 = cvCeil(anchor.y + down_b);
+    Rect win(x0, y0, std::max(0, x1 - x0 + 1), std::max(0, y1 - y0 + 1));
+    return win & Rect(0, 0, img_size.width, img_size.height);
+}
+
+std::vector<cv::Point2f> redetectSpotsInWindow(const Mat& src16, const Rect& win,
+                                               const LocalRedetectParams& p,
+                                               const std::vector<cv::Point2f>& existing)
+{
+    vector<Point2f> found;
+    if (src16.empty() || src16.type() != CV_16UC1 || win.area() <= 0) return found;
+
+    const Mat roi = src16(win);
+    double mn = 0.0, mx = 0.0;
+    minMaxLoc(roi, &mn, &mx);
+    if (mx - mn < p.min_contrast) return found;
+
+    Mat bin8(roi.rows, roi.cols, CV_8UC1);
+    if (p.method == LRD_PERCENTILE) {
+        vector<uint16_t> vals; vals.reserve((size_t)roi.rows * roi.cols);
+        for (int r = 0; r < roi.rows; ++r) {
+            const uint16_t* q = roi.ptr<uint16_t>(r);
+            vals.insert(vals.end(), q, q + roi.cols);
+        }
+        const double keep = std::min(1.0, std::max(0.0, 1.0 - p.fg_pct));
+        const size_t k = std::min(vals.size() - 1, (size_t)(keep * (double)vals.size()));
+        std::nth_element(vals.begin(), vals.begin() + k, vals.end());
+        const uint16_t th = vals[k];
+        for (int r = 0; r < roi.rows; ++r) {
+            const uint16_t* q = roi.ptr<uint16_t>(r);
+            uchar* b = bin8.ptr<uchar>(r);
+            for (int c = 0; c < roi.cols; ++c) b[c] = (q[c] > th) ? 255 : 0;
+        }
+    } else {
+        const double alpha = 255.0 / (mx - mn);
+        Mat view8; roi.convertTo(view8, CV_8U, alpha, -mn * alpha);
+        threshold(view8, bin8, 0, 255, THRESH_BINARY | THRESH_OTSU);
+    }
+
+    Mat labels, stats, centroids;
+    const int nLabels = connectedComponentsWithStats(bin8, labels, stats, centroids, 8, CV_32S);
+    const float r2 = p.dedup_r * p.dedup_r;
+    for (int i = 1; i < nLabels; ++i) {
+        const int area = stats.at<int>(i, CC_STAT_AREA);
+        if (area < p.area_min) continue;
+        if (p.area_max > 0 && area > p.area_max) continue;
+        const Point2f c((float)centroids.at<double>(i, 0) + win.x,
+                        (float)centroids.at<double>(i, 1) + win.y);
+        bool dup = false;
+        for (const auto& e : existing) {
+            const float dx_ = e.x - c.x, dy_ = e.y - c.y;
+            if (dx_*dx_ + dy_*dy_ <= r2) { dup = true; break; }
+        }
+        if (!dup) found.push_back(c);
+    }
+    return found;
+}
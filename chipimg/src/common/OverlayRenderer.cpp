@@ -0,0 +1,246 @@
+#include "OverlayRenderer.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+constexpr int kGlyphPad = 1;
+
+const Scalar COL_BOX    (0, 255, 0);
+const Scalar COL_PTS    (255, 255, 0);
+const Scalar COL_ANCHOR (0, 0, 255);
+const Scalar COL_GRID   (255, 0, 255);
+const Scalar COL_MERGED (0, 255, 255);
+const Scalar COL_FITTED (0, 128, 255);
+const Scalar COL_WINBOX (100, 100, 255);
+const Scalar COL_TEXT   (255, 255, 255);
+
+// 缩到预览分辨率（INTER_AREA 在原位深上做）再转 8 位
+void previewBase8(const Mat& src, double scale, Mat& base8)
+{
+    const double k = src.type() == CV_16UC1 ? 1.0 / 256.0 : 1.0;
+    if (scale != 1.0) {
+        Mat small;
+        resize(src, small, Size(), scale, scale, INTER_AREA);
+        small.convertTo(base8, CV_8U, k);
+    } else {
+        src.convertTo(base8, CV_8U, k);
+    }
+}
+}
+
+GlyphCache::GlyphCache(double font_scale, int thickness)
+{
+    for (int c = 32; c < 127; ++c) {
+        const string s(1, (char)c);
+        int baseline = 0;
+        const Size sz = getTextSize(s, FONT_HERSHEY_SIMPLEX, font_scale, thickness, &baseline);
+        Glyph& g = glyphs_[c - 32];
+        g.advance = sz.width;
+        g.top = -(sz.height + kGlyphPad);
+        ascent_ = std::max(ascent_, sz.height);
+        if (c == ' ') continue;
+        g.mask = Mat(sz.height + baseline + 2 * kGlyphPad, sz.width + 2 * kGlyphPad, CV_8UC1, Scalar(0));
+        putText(g.mask, s, Point(kGlyphPad, kGlyphPad + sz.height), FONT_HERSHEY_SIMPLEX,
+                font_scale, Scalar(255), thickness, LINE_8);
+    }
+}
+
+void GlyphCache::draw(Mat& bgr, Point org, const char* text, const Scalar& color) const
+{
+    const Rect canvas(0, 0, bgr.cols, bgr.rows);
+    int x = org.x;
+    for (const char* p = text; *p; ++p) {
+        const int c = (unsigned char)*p;
+        const Glyph& g = glyphs_[(c >= 32 && c < 127) ? c - 32 : '?' - 32];
+        if (!g.mask.empty()) {
+            const Rect dst(x - kGlyphPad, org.y + g.top, g.mask.cols, g.mask.rows);
+            const Rect clip = dst & canvas;
+            if (clip.area() > 0)
+                bgr(clip).setTo(color, g.mask(Rect(clip.x - dst.x, clip.y - dst.y, clip.width, clip.height)));
+        }
+        x += g.advance;
+    }
+}
+
+const GlyphCache& overlayGlyphs()
+{
+    static const GlyphCache cache(0.38, 1);
+    return cache;
+}
+
+void fillOverlayScene(OverlayScene& s, const ChipResult& r, bool well_labels)
+{
+    s.boxes.push_back(r.roi);
+    int last_wr = -1, last_wc = -1;
+    for (const auto& q : r.points) {
+        const Point2f p(q.x, q.y);
+        (q.measured ? s.merged : s.fitted).push_back(p);
+        if (well_labels && (q.wr != last_wr || q.wc != last_wc)) {
+            s.labels.push_back({p, cv::format("%d,%d", q.wr, q.wc)});
+            last_wr = q.wr; last_wc = q.wc;
+        }
+    }
+    s.caption = cv::format("%s %s points=%d/%d", chipKindName(r.kind), r.ok ? "OK" : "FAIL",
+                           (int)r.points.size(), r.slots);
+}
+
+void renderOverlay(const Mat& base8, double scale, bool preview_ready,
+                   const OverlayScene& scene, const GlyphCache& glyphs, Mat& out_bgr)
+{
+    if (preview_ready || scale == 1.0) {
+        cvtColor(base8, out_bgr, COLOR_GRAY2BGR);
+    } else {
+        Mat small;
+        resize(base8, small, Size(), scale, scale, INTER_AREA);
+        cvtColor(small, out_bgr, COLOR_GRAY2BGR);
+    }
+
+    const float k = (float)scale;
+    auto P = [k](const Point2f& p){ return Point(cvRound(p.x * k), cvRound(p.y * k)); };
+    auto R = [k](const Rect& r){
+        return Rect(Point(cvRound(r.x * k), cvRound(r.y * k)),
+                    Point(cvRound((r.x + r.width) * k), cvRound((r.y + r.height) * k)));
+    };
+    const int rad   = std::max(1, cvRound(2 * scale));
+    const int cross = std::max(3, cvRound(7 * scale));
+
+    for (const auto& b : scene.boxes)   rectangle(out_bgr, R(b), COL_BOX, 1, LINE_8);
+    for (const auto& w : scene.windows) rectangle(out_bgr, R(w), COL_WINBOX, 1, LINE_8);
+    for (const auto& p : scene.spots)   circle(out_bgr, P(p), rad, COL_PTS, FILLED, LINE_8);
+    for (const auto& p : scene.grid)    circle(out_bgr, P(p), rad, COL_GRID, FILLED, LINE_8);
+    for (const auto& p : scene.merged)  circle(out_bgr, P(p), rad, COL_MERGED, FILLED, LINE_8);
+    for (const auto& p : scene.fitted)  circle(out_bgr, P(p), rad, COL_FITTED, FILLED, LINE_8);
+    for (const auto& a : scene.anchors) {
+        const Point c = P(a);
+        line(out_bgr, Point(c.x - cross, c.y), Point(c.x + cross, c.y), COL_ANCHOR, 1, LINE_8);
+        line(out_bgr, Point(c.x, c.y - cross), Point(c.x, c.y + cross), COL_ANCHOR, 1, LINE_8);
+    }
+    for (const auto& l : scene.labels)
+        glyphs.draw(out_bgr, P(l.first) + Point(3, -3), l.second, COL_TEXT);
+    if (!scene.caption.empty())
+        glyphs.draw(out_bgr, Point(4, 4 + glyphs.height()), scene.caption, COL_TEXT);
+}
+
+OverlayRenderer::OverlayRenderer(const OverlayParams& p)
+    : p_(p)
+{
+    thread_ = std::thread(&OverlayRenderer::worker, this);
+}
+
+OverlayRenderer::~OverlayRenderer()
+{
+    {
+        lock_guard<mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+bool OverlayRenderer::wants(long long index, bool qa_flag) const
+{
+    const OverlaySampling& s = p_.sampling;
+    if (qa_flag && s.on_qa) return true;
+    if (index < s.first_n) return true;
+    return s.every_n > 0 && index % s.every_n == 0;
+}
+
+bool OverlayRenderer::submit(long long index, const Mat& src, OverlayScene scene, bool qa_flag)
+{
+    if (src.empty() || (src.type() != CV_16UC1 && src.type() != CV_8UC1) || !wants(index, qa_flag)) return false;
+    {
+        lock_guard<mutex> lk(mtx_);
+        if ((int)queue_.size() >= std::max(1, p_.max_queue)) { ++dropped_; return false; }
+    }
+
+    // 检测线程上只缩小一次再转 8 位，之后 src 即可复用
+    Mat base8;
+    previewBase8(src, p_.scale, base8);
+    return enqueue(index, base8, std::move(scene));
+}
+
+bool OverlayRenderer::submitPreview(long long index, const Mat& base8, OverlayScene scene, bool qa_flag)
+{
+    if (base8.empty() || base8.type() != CV_8UC1 || !wants(index, qa_flag)) return false;
+    return enqueue(index, base8, std::move(scene));
+}
+
+bool OverlayRenderer::enqueue(long long index, const Mat& base8, OverlayScene scene)
+{
+    Job job;
+    job.index = index;
+    job.base8 = base8;
+    job.scene = std::move(scene);
+    {
+        lock_guard<mutex> lk(mtx_);
+        if ((int)queue_.size() >= std::max(1, p_.max_queue)) { ++dropped_; return false; }
+        queue_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void OverlayRenderer::flush()
+{
+    unique_lock<mutex> lk(mtx_);
+    idle_cv_.wait(lk, [&]{ return queue_.empty() && !busy_; });
+}
+
+void OverlayRenderer::worker()
+{
+    for (;;) {
+        Job job;
+        {
+            unique_lock<mutex> lk(mtx_);
+            cv_.wait(lk, [&]{ return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;   // stop_ 且已清空
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+        }
+
+        // 一张图画不出或写不下（sink 抛异常、磁盘满、OpenCV 出错）只记一次失败，渲染线程继续
+        bool ok = false;
+        try {
+            Mat bgr;
+            renderOverlay(job.base8, p_.scale, true, job.scene, glyphs_, bgr);
+            if (p_.sink) {
+                p_.sink(job.index, bgr);
+                ok = true;
+            } else {
+                ok = imwrite(p_.out_dir + "/" + p_.prefix + cv::format("_%06lld.png", job.index), bgr);
+            }
+        } catch (...) {
+            ok = false;
+        }
+        if (ok) ++rendered_;
+        else    ++failed_;
+
+        {
+            lock_guard<mutex> lk(mtx_);
+            busy_ = false;
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+std::vector<cv::Mat> renderPreviews(const Mat& base, const std::vector<OverlayScene>& scenes, double scale)
+{
+    vector<Mat> out(scenes.size());
+    if (base.empty() || (base.type() != CV_16UC1 && base.type() != CV_8UC1)) return out;
+    // 各 scene 共用一张底图，只缩小一次
+    Mat base8;
+    previewBase8(base, scale, base8);
+    OverlayParams p;
+    p.scale = scale;
+    p.sampling.first_n = (int)scenes.size();
+    p.max_queue = std::max(1, (int)scenes.size());
+    p.sink = [&out](long long i, const Mat& bgr) { out[(size_t)i] = bgr; };
+    OverlayRenderer ov(p);
+    for (size_t i = 0; i < scenes.size(); ++i) ov.submitPreview((long long)i, base8, scenes[i]);
+    ov.flush();
+    return out;
+}
@@ -0,0 +1,96 @@
+#include "PanelSegment.h"
+#include "PercentileEstimator.h"
+#include "StripedBlobs.h"
+#include <algorithm>
+
+using namespace cv;
+using namespace std;
+
+int segmentPanel(const cv::Mat& src16, const PanelSegmentParams& p,
+                 std::vector<cv::Rect>& chips, const uint32_t* hist16)
+{
+    chips.clear();
+    if (src16.empty() || src16.type() != CV_16UC1) return 0;
+
+    vector<uint32_t> own;
+    if (!hist16) {
+        own.assign(65536, 0u);
+        accumulateHistogram16U(src16, 0, src16.rows, own.data());
+        hist16 = own.data();
+    }
+    uint16_t lo = 0, th = 65535;
+    percentileFromHistogram16U(hist16, 1LL * src16.rows * src16.cols, 0.0, p.fg_pct, lo, th);
+
+    const int cell = std::max(1, p.cell);
+    const int step = std::max(1, p.sample);
+    const int gw = (src16.cols + cell - 1) / cell;
+    const int gh = (src16.rows + cell - 1) / cell;
+
+    Mat hits(gh, gw, CV_32S, Scalar(0));
+    for (int r = 0; r < src16.rows; r += step) {
+        const uint16_t* q = src16.ptr<uint16_t>(r);
+        int* h = hits.ptr<int>(r / cell);
+        for (int c = 0; c < src16.cols; c += step)
+            if (q[c] > th) h[c / cell]++;
+    }
+
+    Mat occ(gh, gw, CV_8U);
+    for (int r = 0; r < gh; ++r) {
+        const int* h = hits.ptr<int>(r);
+        uchar* o = occ.ptr<uchar>(r);
+        for (int c = 0; c < gw; ++c) o[c] = h[c] >= p.min_hits ? 255 : 0;
+    }
+
+    // 膨胀把间隔 <= merge_gap 的格子连起来，外接框只按原始占用格计算
+    Mat merged;
+    const int k = std::max(0, p.merge_gap) + 1;
+    dilate(occ, merged, getStructuringElement(MORPH_RECT, Size(k, k)));
+    Mat labels, stats, centroids;
+    const int n = connectedComponentsWithStats(merged, labels, stats, centroids, 8, CV_32S);
+
+    vector<Rect> boxes(n);
+    vector<bool> seen(n, false);
+    for (int r = 0; r < gh; ++r) {
+        const uchar* o = occ.ptr<uchar>(r);
+        const int* l = labels.ptr<int>(r);
+        for (int c = 0; c < gw; ++c) {
+            if (!o[c] || l[c] <= 0) continue;
+            const Rect rc(c, r, 1, 1);
+            boxes[l[c]] = seen[l[c]] ? (boxes[l[c]] | rc) : rc;
+            seen[l[c]] = true;
+        }
+    }
+
+    const Rect frame(0, 0, src16.cols, src16.rows);
+    for (int i = 1; i < n; ++i) {
+        if (!seen[i]) continue;
+        Rect px(boxes[i].x * cell - p.margin, boxes[i].y * cell - p.margin,
+                boxes[i].width * cell + 2 * p.margin, boxes[i].height * cell + 2 * p.margin);
+        px &= frame;
+        if (px.width < p.min_w || px.height < p.min_h) continue;
+        chips.push_back(px);
+    }
+
+    // 先按 y 中心分排，排内按 x
+    std::sort(chips.begin(), chips.end(), [](const Rect& a, const Rect& b){
+        return a.y + a.height * 0.5 < b.y + b.height * 0.5;
+    });
+    vector<vector<Rect>> rows;
+    for (const Rect& r : chips) {
+        const double cy = r.y + r.height * 0.5;
+        if (!rows.empty()) {
+            const Rect& ref = rows.back().front();
+            if (std::abs(cy - (ref.y + ref.height * 0.5)) < p.row_tol * ref.height) {
+                rows.back().push_back(r);
+                continue;
+            }
+        }
+        rows.push_back({r});
+    }
+    chips.clear();
+    for (auto& row : rows) {
+        std::sort(row.begin(), row.end(), [](const Rect& a, const Rect& b){ return a.x < b.x; });
+        chips.insert(chips.end(), row.begin(), row.end());
+    }
+    return (int)chips.size();
+}
@@ -0,0 +1,136 @@
+#include "PercentileEstimator.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+constexpr int BINS = 65536;
+
+template <class H>
+int lowAt(const H& hist, long long total, double frac) {
+    const long long target = (long long)std::llround(total * std::min(1.0, std::max(0.0, frac)));
+    long long acc = 0; int i = 0;
+    for (; i < BINS; ++i) { acc += hist[i]; if (acc >= target) break; }
+    return std::min(i, BINS - 1);
+}
+
+template <class H>
+int highAt(const H& hist, long long total, double frac) {
+    const long long keep = (long long)std::llround(total * (1.0 - std::min(1.0, std::max(0.0, frac))));
+    long long acc = 0; int i = BINS - 1;
+    for (; i >= 0; --i) { acc += hist[i]; if (acc >= (total - keep)) break; }
+    return std::max(i, 0);
+}
+}
+
+void computePercentile16U(const Mat& img16, double low_pct, double high_pct,
+                          uint16_t& low_v, uint16_t& high_v)
+{
+    CV_Assert(img16.type() == CV_16UC1);
+    vector<int> hist(BINS, 0);
+    for (int r = 0; r < img16.rows; ++r) {
+        const uint16_t* p = img16.ptr<uint16_t>(r);
+        for (int c = 0; c < img16.cols; ++c) hist[p[c]]++;
+    }
+    const long long total = 1LL * img16.rows * img16.cols;
+    low_v  = (uint16_t)lowAt(hist, total, low_pct);
+    high_v = (uint16_t)highAt(hist, total, high_pct);
+    if (low_v >= high_v) { low_v = 0; high_v = 65535; }
+}
+
+void percentileFromHistogram16U(const uint32_t* hist, long long total,
+                                double low_pct, double high_pct,
+                                uint16_t& low_v, uint16_t& high_v)
+{
+    low_v  = (uint16_t)lowAt(hist, total, low_pct);
+    high_v = (uint16_t)highAt(hist, total, high_pct);
+    if (low_v >= high_v) { low_v = 0; high_v = 65535; }
+}
+
+// 误差界用 DKW 不等式：n 个样本时经验分布与真实分布的偏差 <= eps（置信度 confidence），
+// 再把 [pct-eps, pct+eps] 映射回灰度。
+PercentileEstimate estimatePercentile16USampled(const Mat& img16,
+                                                double low_pct, double high_pct,
+                                                int stride, double confidence)
+{
+    CV_Assert(img16.type() == CV_16UC1);
+    PercentileEstimate est;
+    const int s = std::max(1, stride);
+
+    vector<int> hist(BINS, 0);
+    long long n = 0;
+    for (int r = s / 2; r < img16.rows; r += s) {
+        const uint16_t* p = img16.ptr<uint16_t>(r);
+        for (int c = (r / s) % s; c < img16.cols; c += s) { hist[p[c]]++; ++n; }
+    }
+    est.samples = n;
+    if (n == 0) return est;
+
+    const double delta = std::min(0.5, std::max(1e-9, 1.0 - confidence));
+    const double eps   = std::sqrt(std::log(2.0 / delta) / (2.0 * (double)n));
+
+    const int lo  = lowAt(hist, n, low_pct);
+    const int hi  = highAt(hist, n, high_pct);
+    const int lo0 = lowAt(hist, n, low_pct - eps),  lo1 = lowAt(hist, n, low_pct + eps);
+    const int hi0 = highAt(hist, n, high_pct + eps), hi1 = highAt(hist, n, high_pct - eps);
+
+    est.err_low  = (uint16_t)std::max(lo - lo0, lo1 - lo);
+    est.err_high = (uint16_t)std::max(hi - hi0, hi1 - hi);
+    est.low_v  = (uint16_t)lo;
+    est.high_v = (uint16_t)hi;
+    if (est.low_v >= est.high_v) { est.low_v = 0; est.high_v = 65535; }
+    return est;
+}
+
+PercentileTracker::PercentileTracker(const PercentileSampleParams& params)
+    : params_(params) {}
+
+void PercentileTracker::reset()
+{
+    primed_ = false;
+    since_exact_ = 0;
+}
+
+PercentileEstimate PercentileTracker::update(const Mat& img16, double low_pct, double high_pct)
+{
+    ++frames_;
+    if (low_pct != last_low_pct_ || high_pct != last_high_pct_) primed_ = false;
+
+    if (primed_ && since_exact_ < params_.max_skip) {
+        PercentileEstimate est = estimatePercentile16USampled(img16, low_pct, high_pct,
+                                                              params_.stride, params_.confidence);
+        const double range = std::max(1.0, ema_high_ - ema_low_);
+        const double tol_l = params_.drift_tol * range + est.err_low;
+        const double tol_h = params_.drift_tol * range + est.err_high;
+        if (est.samples > 0 &&
+            std::fabs(est.low_v  - ema_low_)  <= tol_l &&
+            std::fabs(est.high_v - ema_high_) <= tol_h) {
+            ema_low_  += params_.ema_alpha * (est.low_v  - ema_low_);
+            ema_high_ += params_.ema_alpha * (est.high_v - ema_high_);
+            const long lo = std::lround(ema_low_), hi = std::lround(ema_high_);
+            if (lo < hi) {
+                ++since_exact_;
+                est.low_v  = (uint16_t)lo;
+                est.high_v = (uint16_t)hi;
+                return est;
+            }
+        }
+    }
+
+    PercentileEstimate est;
+    computePercentile16U(img16, low_pct, high_pct, est.low_v, est.high_v);
+    est.samples = 1LL * img16.rows * img16.cols;
+    est.exact   = true;
+
+    ema_low_  = est.low_v;
+    ema_high_ = est.high_v;
+    last_low_pct_  = low_pct;
+    last_high_pct_ = high_pct;
+    primed_      = true;
+    since_exact_ = 0;
+    ++exact_frames_;
+    return est;
+}
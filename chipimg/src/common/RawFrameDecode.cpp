@@ -0,0 +1,115 @@
+#include "RawFrameDecode.h"
+#include <cstring>
+#include <algorithm>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+using namespace cv;
+
+namespace {
+
+inline void unpackRow12(const uint8_t* s, uint16_t* d, int w, int sh)
+{
+    int x = 0;
+#if defined(__SSSE3__)
+    // 每次 12 字节 -> 8 像素：先把每个像素所在的两字节拼成 16 位字 (hi<<8 | b1)，
+    // 偶数像素取 (w>>4)&0x0FF0 | w&0x000F，奇数像素取 (w>>4)&0x0FFF
+    const __m128i shuf  = _mm_setr_epi8(1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11);
+    const __m128i maskA = _mm_setr_epi16(0x0FF0, 0x0FFF, 0x0FF0, 0x0FFF, 0x0FF0, 0x0FFF, 0x0FF0, 0x0FFF);
+    const __m128i maskW = _mm_setr_epi16(0x000F, 0, 0x000F, 0, 0x000F, 0, 0x000F, 0);
+    // 最后一次 16 字节读取不能越过行尾：保证 3*(x/2)+16 <= 3*w/2
+    for (; x + 8 <= w && (size_t)(x / 2) * 3 + 16 <= (size_t)(w / 2) * 3; x += 8) {
+        const __m128i raw = _mm_loadu_si128((const __m128i*)(s + (x / 2) * 3));
+        const __m128i wv  = _mm_shuffle_epi8(raw, shuf);
+        __m128i v = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(wv, 4), maskA),
+                                 _mm_and_si128(wv, maskW));
+        if (sh) v = _mm_slli_epi16(v, sh);
+        _mm_storeu_si128((__m128i*)(d + x), v);
+    }
+#endif
+    for (; x + 1 < w; x += 2) {
+        const uint8_t* q = s + (x / 2) * 3;
+        d[x]     = (uint16_t)(((q[0] << 4) | (q[1] & 0x0F)) << sh);
+        d[x + 1] = (uint16_t)(((q[2] << 4) | (q[1] >> 4)) << sh);
+    }
+    if (x < w) {
+        const uint8_t* q = s + (x / 2) * 3;
+        d[x] = (uint16_t)(((q[0] << 4) | (q[1] & 0x0F)) << sh);
+    }
+}
+
+inline void unpackRow10p(const uint8_t* s, uint16_t* d, int w, int sh)
+{
+    int x = 0;
+    for (; x + 1 < w; x += 2) {
+        const uint8_t* q = s + (x / 2) * 3;
+        d[x]     = (uint16_t)(((q[0] << 2) | (q[1] & 0x03)) << sh);
+        d[x + 1] = (uint16_t)(((q[2] << 2) | ((q[1] >> 4) & 0x03)) << sh);
+    }
+    if (x < w) {
+        const uint8_t* q = s + (x / 2) * 3;
+        d[x] = (uint16_t)(((q[0] << 2) | (q[1] & 0x03)) << sh);
+    }
+}
+
+inline void copyRow16(const uint8_t* s, uint16_t* d, int w, int sh, uint16_t mask)
+{
+    if (!sh && mask == 0xFFFF) { std::memcpy(d, s, (size_t)w * 2); return; }
+    for (int x = 0; x < w; ++x) {
+        uint16_t v; std::memcpy(&v, s + 2 * x, 2);
+        d[x] = (uint16_t)((v & mask) << sh);
+    }
+}
+
+}
+
+size_t rawFrameMinStride(int width, int format)
+{
+    if (width <= 0) return 0;
+    switch (format) {
+    case RPF_MONO16:
+    case RPF_MONO10:        return (size_t)width * 2;
+    case RPF_MONO12_PACKED:
+    case RPF_MONO10_PACKED: return ((size_t)width * 3 + 1) / 2;
+    default:                return 0;
+    }
+}
+
+int rawFrameBitDepth(int format)
+{
+    switch (format) {
+    case RPF_MONO16:        return 16;
+    case RPF_MONO12_PACKED: return 12;
+    case RPF_MONO10:
+    case RPF_MONO10_PACKED: return 10;
+    default:                return 0;
+    }
+}
+
+bool unpackRawFrame16U(const RawFrameView& in, Mat& dst16, uint32_t* hist, bool msb_align)
+{
+    const size_t min_stride = rawFrameMinStride(in.width, in.format);
+    if (!in.data || in.height <= 0 || min_stride == 0) return false;
+    const size_t stride = in.stride ? in.stride : min_stride;
+    if (stride < min_stride) return false;
+
+    if (dst16.rows != in.height || dst16.cols != in.width || dst16.type() != CV_16UC1)
+        dst16.create(in.height, in.width, CV_16UC1);
+    if (hist) std::fill(hist, hist + 65536, 0u);
+
+    const int sh = msb_align ? 16 - rawFrameBitDepth(in.format) : 0;
+    for (int r = 0; r < in.height; ++r) {
+        const uint8_t* s = in.data + stride * (size_t)r;
+        uint16_t* d = dst16.ptr<uint16_t>(r);
+        switch (in.format) {
+        case RPF_MONO16:        copyRow16(s, d, in.width, 0, 0xFFFF); break;
+        case RPF_MONO10:        copyRow16(s, d, in.width, sh, 0x03FF); break;
+        case RPF_MONO12_PACKED: unpackRow12(s, d, in.width, sh); break;
+        case RPF_MONO10_PACKED: unpackRow10p(s, d, in.width, sh); break;
+        }
+        // 刚写出的一行还在 L1 里，直方图在这里顺带累加，不再单独扫整帧
+        if (hist) for (int x = 0; x < in.width; ++x) hist[d[x]]++;
+    }
+    return true;
+}
@@ -0,0 +1,255 @@
+#include "RawFrameStore.h"
+#include <cstring>
+#include <algorithm>
+#if defined(_WIN32)
+#include <fstream>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+constexpr size_t kAlign = 64;
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint8_t  reserved[56];
+};
+struct FrameHeader {
+    char     magic[4];
+    uint32_t header_size;
+    int32_t  width;
+    int32_t  height;
+    uint32_t stride;
+    uint32_t format;
+    uint32_t meta_len;
+    uint32_t reserved0;
+    uint64_t data_len;
+    int64_t  timestamp_us;
+    uint8_t  reserved[16];
+};
+#pragma pack(pop)
+static_assert(sizeof(FileHeader)  == kAlign, "FileHeader must be 64 bytes");
+static_assert(sizeof(FrameHeader) == kAlign, "FrameHeader must be 64 bytes");
+
+inline size_t padTo(size_t n) { return (n + kAlign - 1) / kAlign * kAlign; }
+
+bool writePad(FILE* fp, size_t n) {
+    static const uint8_t zeros[kAlign] = {};
+    return n == 0 || fwrite(zeros, 1, n, fp) == n;
+}
+
+// 校验 off 处的帧头（文件共 bytes 字节），给出元数据 / 像素偏移和下一帧的起点。
+// 头里的长度来自文件，先比较再相加，坏长度不能让偏移回绕；宽度或格式不认识的帧也算坏帧
+bool checkFrame(const FrameHeader& h, size_t off, size_t bytes,
+                size_t& meta_off, size_t& data_off, size_t& next)
+{
+    if (memcmp(h.magic, "FRM1", 4) != 0 || h.header_size < sizeof(FrameHeader)) return false;
+    if (h.header_size > bytes - off) return false;
+    meta_off = off + h.header_size;
+    if (padTo(h.meta_len) > bytes - meta_off) return false;
+    data_off = meta_off + padTo(h.meta_len);
+    if (data_off > bytes || h.data_len > bytes - data_off) return false;
+    next = data_off + padTo((size_t)h.data_len);
+    const size_t min_stride = rawFrameMinStride(h.width, (int)h.format);
+    return h.height > 0 && min_stride != 0 && h.stride >= min_stride &&
+           (uint64_t)h.stride * (uint64_t)h.height <= h.data_len;
+}
+
+}
+
+bool RawFrameWriter::open(const std::string& path, bool append)
+{
+    close();
+    if (append) {
+        if (FILE* f = fopen(path.c_str(), "r+b")) {
+            FileHeader h{};
+            if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, "CHRF", 4) != 0 ||
+                h.header_size < sizeof(FileHeader) || fseek(f, 0, SEEK_END) != 0) {
+                fclose(f);
+                return false;
+            }
+            // 上一个写端中途退出时尾帧可能不完整：截到最后一帧完整帧末尾再接着写，
+            // 否则读端停在残帧上，后面追加的帧都读不到（与 .chrr 的追加打开相同）
+            const long long file_end = (long long)ftell(f);
+            bool ok = file_end >= (long long)h.header_size;
+            size_t good_end = h.header_size;
+            FrameHeader fh;
+            size_t meta_off, data_off, next;
+            while (ok && (long long)(good_end + sizeof(fh)) <= file_end &&
+                   fseek(f, (long)good_end, SEEK_SET) == 0 && fread(&fh, sizeof(fh), 1, f) == 1 &&
+                   checkFrame(fh, good_end, (size_t)file_end, meta_off, data_off, next))
+                good_end = next;
+            // 末帧只缺尾部对齐填充时 good_end 会略超文件长度，截断即补零
+            if (ok && (long long)good_end != file_end) {
+                fflush(f);
+#if defined(_WIN32)
+                ok = _chsize_s(_fileno(f), (long long)good_end) == 0;
+#else
+                ok = ftruncate(fileno(f), (off_t)good_end) == 0;
+#endif
+            }
+            ok = ok && fseek(f, 0, SEEK_END) == 0;
+            if (!ok) { fclose(f); return false; }
+            fp_ = f;
+            return true;
+        }
+    }
+    fp_ = fopen(path.c_str(), "wb");
+    if (!fp_) return false;
+    FileHeader h{};
+    memcpy(h.magic, "CHRF", 4);
+    h.version     = kRawStoreVersion;
+    h.header_size = (uint16_t)sizeof(FileHeader);
+    if (fwrite(&h, sizeof(h), 1, fp_) != 1) { close(); return false; }
+    return true;
+}
+
+bool RawFrameWriter::append(const cv::Mat& img16, const std::string& meta, int64_t timestamp_us)
+{
+    if (img16.empty() || img16.type() != CV_16UC1) return false;
+    RawFrameView v;
+    v.data   = img16.data;
+    v.width  = img16.cols;
+    v.height = img16.rows;
+    v.stride = img16.step[0];
+    v.format = RPF_MONO16;
+    return appendRaw(v, meta, timestamp_us);
+}
+
+bool RawFrameWriter::appendRaw(const RawFrameView& frame, const std::string& meta, int64_t timestamp_us)
+{
+    if (!fp_) return false;
+    const size_t row_bytes = rawFrameMinStride(frame.width, frame.format);
+    if (!frame.data || frame.height <= 0 || row_bytes == 0) return false;
+    const size_t src_stride = frame.stride ? frame.stride : row_bytes;
+    if (src_stride < row_bytes) return false;
+
+    // 落盘时去掉源图的行填充，stride 总是紧密的
+    FrameHeader h{};
+    memcpy(h.magic, "FRM1", 4);
+    h.header_size  = (uint32_t)sizeof(FrameHeader);
+    h.width        = frame.width;
+    h.height       = frame.height;
+    h.stride       = (uint32_t)row_bytes;
+    h.format       = (uint32_t)frame.format;
+    h.meta_len     = (uint32_t)meta.size();
+    h.data_len     = (uint64_t)row_bytes * frame.height;
+    h.timestamp_us = timestamp_us;
+
+    bool ok = fwrite(&h, sizeof(h), 1, fp_) == 1;
+    if (ok && !meta.empty()) ok = fwrite(meta.data(), 1, meta.size(), fp_) == meta.size();
+    if (ok) ok = writePad(fp_, padTo(meta.size()) - meta.size());
+    if (ok && src_stride == row_bytes) {
+        ok = fwrite(frame.data, 1, (size_t)h.data_len, fp_) == h.data_len;
+    } else {
+        for (int r = 0; ok && r < frame.height; ++r)
+            ok = fwrite(frame.data + src_stride * (size_t)r, 1, row_bytes, fp_) == row_bytes;
+    }
+    if (ok) ok = writePad(fp_, padTo((size_t)h.data_len) - (size_t)h.data_len);
+    if (ok) ++frames_;
+    return ok;
+}
+
+void RawFrameWriter::close()
+{
+    if (fp_) { fclose(fp_); fp_ = nullptr; }
+    frames_ = 0;
+}
+
+bool RawFrameReader::open(const std::string& path)
+{
+    close();
+#if defined(_WIN32)
+    std::ifstream fs(path, std::ios::binary);
+    if (!fs) return false;
+    owned_.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+    base_  = owned_.data();
+    bytes_ = owned_.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(FileHeader)) { ::close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+    base_   = static_cast<const uint8_t*>(p);
+    bytes_  = (size_t)st.st_size;
+    mapped_ = true;
+#endif
+
+    if (bytes_ < sizeof(FileHeader)) { close(); return false; }
+    FileHeader fh;
+    memcpy(&fh, base_, sizeof(fh));
+    if (memcmp(fh.magic, "CHRF", 4) != 0 || fh.version > kRawStoreVersion || fh.header_size < sizeof(FileHeader)) {
+        close(); return false;
+    }
+
+    // 截断的尾帧（写到一半）直接忽略
+    size_t off = fh.header_size;
+    while (off + sizeof(FrameHeader) <= bytes_) {
+        FrameHeader h;
+        memcpy(&h, base_ + off, sizeof(h));
+        size_t meta_off, data_off, next;
+        if (!checkFrame(h, off, bytes_, meta_off, data_off, next)) break;
+
+        RawFrameEntry e;
+        e.view.data   = base_ + data_off;
+        e.view.width  = h.width;
+        e.view.height = h.height;
+        e.view.stride = h.stride;
+        e.view.format = (int)h.format;
+        e.meta.assign(reinterpret_cast<const char*>(base_ + meta_off), h.meta_len);
+        e.timestamp_us = h.timestamp_us;
+        frames_.push_back(std::move(e));
+        off = next;
+    }
+    return true;
+}
+
+void RawFrameReader::close()
+{
+#if !defined(_WIN32)
+    if (mapped_ && base_) munmap(const_cast<uint8_t*>(base_), bytes_);
+#endif
+    base_ = nullptr; bytes_ = 0; mapped_ = false;
+    owned_.clear(); owned_.shrink_to_fit();
+    frames_.clear();
+}
+
+cv::Mat RawFrameReader::mat16(int i) const
+{
+    if (i < 0 || i >= size()) return Mat();
+    const RawFrameView& v = frames_[i].view;
+    if (v.format != RPF_MONO16) return Mat();
+    return Mat(v.height, v.width, CV_16UC1, const_cast<uint8_t*>(v.data), v.stride);
+}
+
+bool RawFrameReader::decode16(int i, cv::Mat& dst, uint32_t* hist) const
+{
+    if (i < 0 || i >= size()) return false;
+    return unpackRawFrame16U(frames_[i].view, dst, hist);
+}
+
+cv::Mat loadFrame16(const std::string& path, RawFrameReader& reader, int index)
+{
+    const string ext = ".chrf";
+    if (path.size() < ext.size() || path.compare(path.size() - ext.size(), ext.size(), ext) != 0)
+        return imread(path, IMREAD_UNCHANGED);
+    if (!reader.open(path) || index < 0 || index >= reader.size()) return Mat();
+    Mat m = reader.mat16(index);
+    if (m.empty()) reader.decode16(index, m);
+    return m;
+}
@@ -0,0 +1,444 @@
+#include "ResultRecord.h"
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_size;
+    uint8_t  reserved[8];
+};
+struct RecordHeader {
+    uint32_t record_size;     // 含本头
+    uint16_t version;
+    uint16_t header_size;
+    uint64_t frame_id;
+    int64_t  timestamp_us;
+    int32_t  chip_index;
+    uint8_t  kind;
+    uint8_t  flags;           // RF_*
+    uint8_t  point_rows;
+    uint8_t  point_cols;
+    int32_t  roi[4];          // x y w h，整帧坐标
+    uint16_t well_rows;
+    uint16_t anchor_count;
+    uint32_t slots;
+    uint16_t low_v;
+    uint16_t high_v;
+    float    otsu_th;
+    float    elapsed_ms;
+    float    kind_margin;
+    uint16_t degrade;
+    uint16_t redetect_wells;
+    uint16_t redetect_recovered;
+    uint16_t lattice_replaced;
+    uint32_t spots;
+    uint32_t clusters;
+    uint32_t grid_keeps;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+static_assert(sizeof(FileHeader)   == 16, "FileHeader must be 16 bytes");
+static_assert(sizeof(RecordHeader) == 96, "RecordHeader must be 96 bytes");
+
+enum RecordFlag : uint8_t {
+    RF_OK          = 1 << 0,
+    RF_REJECTED    = 1 << 1,
+    RF_OVER_BUDGET = 1 << 2,
+    RF_AUTO_KIND   = 1 << 3
+};
+
+constexpr uint16_t kNoCoordV1 = 0xFFFF;             // 版本 1：u16，只能表示 ROI 右下方向
+constexpr int32_t  kNoCoord   = INT32_MIN;          // 版本 2 起：i32，ROI 外的坐标也能存
+
+inline uint16_t sat16(long v) { return (uint16_t)std::max(0L, std::min(65535L, v)); }
+
+// 相对 ROI 左上角的 1/4 像素（有符号）；非有限值或超出 i32 时为 kNoCoord
+inline int32_t packCoord(float v, int origin)
+{
+    if (!std::isfinite(v)) return kNoCoord;
+    const double q = std::round(((double)v - origin) * 4.0);
+    return (q <= (double)INT32_MIN || q > (double)INT32_MAX) ? kNoCoord : (int32_t)q;
+}
+inline float unpackCoord(int32_t q, int origin)
+{
+    return q == kNoCoord ? NAN : (float)(origin + q * 0.25);
+}
+inline float unpackCoordV1(uint16_t q, int origin)
+{
+    return q == kNoCoordV1 ? NAN : origin + q * 0.25f;
+}
+
+template <class T>
+void put(vector<uint8_t>& out, const T& v)
+{
+    const size_t n = out.size();
+    out.resize(n + sizeof(T));
+    memcpy(out.data() + n, &v, sizeof(T));
+}
+
+int totalWells(const vector<int>& wells_per_row)
+{
+    int n = 0;
+    for (int w : wells_per_row) n += std::max(0, w);
+    return n;
+}
+
+}
+
+void encodeResultRecord(const ChipResult& r, uint64_t frame_id, int64_t timestamp_us,
+                        std::vector<uint8_t>& out)
+{
+    const SD_Report& rep = r.report;
+    const int prn = std::min(r.point_rows, 255), pcn = std::min(r.point_cols, 255);
+    const int well_rows = std::min((int)r.wells_per_row.size(), 65535);
+    const vector<int> wpr(r.wells_per_row.begin(), r.wells_per_row.begin() + well_rows);
+    const int slots = totalWells(wpr) * prn * pcn;
+    const int anchors = std::min((int)rep.anchors.size(), 65535);
+
+    vector<int> well_base(well_rows + 1, 0);
+    for (int i = 0; i < well_rows; ++i) well_base[i + 1] = well_base[i] + std::max(0, wpr[i]);
+
+    // 有效点按格序排好，重复的格只留第一个；坐标存不下（非有限值）的点按无效格写，不冒充有效
+    vector<int> pt_of_slot(slots, -1);
+    for (int i = 0; i < (int)r.points.size(); ++i) {
+        const ChipPoint& q = r.points[i];
+        if (q.wr < 0 || q.wr >= well_rows || q.wc < 0 || q.wc >= wpr[q.wr] ||
+            q.pr < 0 || q.pr >= prn || q.pc < 0 || q.pc >= pcn) continue;
+        if (packCoord(q.x, r.roi.x) == kNoCoord || packCoord(q.y, r.roi.y) == kNoCoord) continue;
+        const int s = ((well_base[q.wr] + q.wc) * prn + q.pr) * pcn + q.pc;
+        if (pt_of_slot[s] < 0) pt_of_slot[s] = i;
+    }
+
+    const size_t start = out.size();
+    RecordHeader h{};
+    h.version       = kResultRecordVersion;
+    h.header_size   = (uint16_t)sizeof(RecordHeader);
+    h.frame_id      = frame_id;
+    h.timestamp_us  = timestamp_us;
+    h.chip_index    = r.chip_index;
+    h.kind          = (uint8_t)r.kind;
+    h.flags         = (r.ok ? RF_OK : 0) | (rep.rejected ? RF_REJECTED : 0) |
+                      (rep.over_budget ? RF_OVER_BUDGET : 0) | (r.auto_kind ? RF_AUTO_KIND : 0);
+    h.point_rows    = (uint8_t)prn;
+    h.point_cols    = (uint8_t)pcn;
+    h.roi[0] = r.roi.x; h.roi[1] = r.roi.y; h.roi[2] = r.roi.width; h.roi[3] = r.roi.height;
+    h.well_rows     = (uint16_t)well_rows;
+    h.anchor_count  = (uint16_t)anchors;
+    h.slots         = (uint32_t)slots;
+    h.low_v         = rep.low_v;
+    h.high_v        = rep.high_v;
+    h.otsu_th       = (float)rep.otsu_th;
+    h.elapsed_ms    = (float)rep.elapsed_ms;
+    h.kind_margin   = r.kind_margin;
+    h.degrade       = (uint16_t)rep.degrade;
+    h.redetect_wells     = sat16(rep.redetect_wells);
+    h.redetect_recovered = sat16(rep.redetect_recovered);
+    h.lattice_replaced   = sat16(rep.lattice_replaced);
+    h.spots         = (uint32_t)std::max(0, rep.spots);
+    h.clusters      = (uint32_t)std::max(0, rep.clusters);
+    h.grid_keeps    = (uint32_t)std::max(0, rep.grid_keeps);
+    put(out, h);
+
+    for (int w : wpr) put(out, sat16(w));
+    for (int i = 0; i < anchors; ++i) {
+        put(out, packCoord(rep.anchors[i].x, r.roi.x));
+        put(out, packCoord(rep.anchors[i].y, r.roi.y));
+    }
+
+    const size_t bits = ((size_t)slots + 7) / 8;
+    const size_t vb = out.size();
+    out.resize(vb + 2 * bits, 0);
+    for (int s = 0; s < slots; ++s) {
+        if (pt_of_slot[s] < 0) continue;
+        out[vb + s / 8] |= (uint8_t)(1u << (s % 8));
+        if (r.points[pt_of_slot[s]].measured) out[vb + bits + s / 8] |= (uint8_t)(1u << (s % 8));
+    }
+    for (int s = 0; s < slots; ++s) {
+        if (pt_of_slot[s] < 0) continue;
+        const ChipPoint& q = r.points[pt_of_slot[s]];
+        put(out, packCoord(q.x, r.roi.x));
+        put(out, packCoord(q.y, r.roi.y));
+    }
+
+    const uint32_t size = (uint32_t)(out.size() - start);
+    memcpy(out.data() + start, &size, sizeof(size));
+}
+
+bool decodeResultRecord(const uint8_t* data, size_t len, ResultRecord& rec)
+{
+    if (!data || len < sizeof(RecordHeader)) return false;
+    RecordHeader h;
+    memcpy(&h, data, sizeof(h));
+    if (h.record_size > len || h.header_size < sizeof(RecordHeader) || h.header_size > h.record_size)
+        return false;
+    if (h.kind >= CHIP_KIND_COUNT) return false;
+
+    const uint8_t* p   = data + h.header_size;
+    const uint8_t* end = data + h.record_size;
+    const size_t bits  = ((size_t)h.slots + 7) / 8;
+    auto take16 = [&](uint16_t& v) {
+        if (end - p < 2) return false;
+        memcpy(&v, p, 2); p += 2; return true;
+    };
+    // 坐标：版本 1 为 u16，之后为 i32
+    auto takeCoord = [&](int origin, float& v) {
+        if (h.version < 2) {
+            uint16_t q;
+            if (!take16(q)) return false;
+            v = unpackCoordV1(q, origin);
+            return true;
+        }
+        if (end - p < 4) return false;
+        int32_t q;
+        memcpy(&q, p, 4); p += 4;
+        v = unpackCoord(q, origin);
+        return true;
+    };
+
+    rec = ResultRecord{};
+    rec.frame_id     = h.frame_id;
+    rec.timestamp_us = h.timestamp_us;
+    ChipResult& c = rec.chip;
+    c.chip_index  = h.chip_index;
+    c.roi         = Rect(h.roi[0], h.roi[1], h.roi[2], h.roi[3]);
+    c.kind        = (ChipKind)h.kind;
+    c.ok          = (h.flags & RF_OK) != 0;
+    c.auto_kind   = (h.flags & RF_AUTO_KIND) != 0;
+    c.kind_margin = h.kind_margin;
+    c.point_rows  = h.point_rows;
+    c.point_cols  = h.point_cols;
+
+    SD_Report& rep = c.report;
+    rep.rejected           = (h.flags & RF_REJECTED) != 0;
+    rep.over_budget        = (h.flags & RF_OVER_BUDGET) != 0;
+    rep.low_v              = h.low_v;
+    rep.high_v             = h.high_v;
+    rep.otsu_th            = h.otsu_th;
+    rep.elapsed_ms         = h.elapsed_ms;
+    rep.degrade            = h.degrade;
+    rep.redetect_wells     = h.redetect_wells;
+    rep.redetect_recovered = h.redetect_recovered;
+    rep.lattice_replaced   = h.lattice_replaced;
+    rep.spots              = (int)h.spots;
+    rep.clusters           = (int)h.clusters;
+    rep.grid_keeps         = (int)h.grid_keeps;
+
+    c.wells_per_row.resize(h.well_rows);
+    for (auto& w : c.wells_per_row) {
+        uint16_t v;
+        if (!take16(v)) return false;
+        w = v;
+    }
+    if ((size_t)totalWells(c.wells_per_row) * h.point_rows * h.point_cols != h.slots) return false;
+    c.slots = (int)h.slots;
+
+    rep.anchors.resize(h.anchor_count);
+    for (auto& a : rep.anchors)
+        if (!takeCoord(c.roi.x, a.x) || !takeCoord(c.roi.y, a.y)) return false;
+
+    if ((size_t)(end - p) < 2 * bits) return false;
+    const uint8_t* valid    = p;
+    const uint8_t* measured = p + bits;
+    p += 2 * bits;
+
+    const int pcn = std::max(1, (int)h.point_cols), per_well = h.point_rows * h.point_cols;
+    int wr = 0, wc = 0, row_start = 0;
+    for (int s = 0; s < (int)h.slots; ++s) {
+        const int well = s / per_well;
+        while (wr < (int)c.wells_per_row.size() && well >= row_start + c.wells_per_row[wr]) {
+            row_start += c.wells_per_row[wr]; ++wr;
+        }
+        wc = well - row_start;
+        if (!(valid[s / 8] & (1u << (s % 8)))) continue;
+        ChipPoint q;
+        if (!takeCoord(c.roi.x, q.x) || !takeCoord(c.roi.y, q.y)) return false;
+        q.wr = wr; q.wc = wc;
+        q.pr = (s % per_well) / pcn;
+        q.pc = (s % per_well) % pcn;
+        q.measured = (measured[s / 8] & (1u << (s % 8))) != 0;
+        c.points.push_back(q);
+    }
+    return true;
+}
+
+bool ResultRecordWriter::open(const std::string& path, bool append)
+{
+    close();
+    if (append) {
+        if (FILE* f = fopen(path.c_str(), "r+b")) {
+            FileHeader h{};
+            if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, "CHRR", 4) != 0 ||
+                h.header_size < sizeof(FileHeader) || fseek(f, 0, SEEK_END) != 0) {
+                fclose(f);
+                return false;
+            }
+            // 上一个写端中途退出时尾记录可能不完整：截到最后一条完整记录末尾再接着写，
+            // 否则读端停在残记录上，后面追加的都读不到
+            const long long file_end = (long long)ftell(f);
+            long long good_end = h.header_size;
+            RecordHeader rh;
+            while (good_end + (long long)sizeof(rh) <= file_end && fseek(f, (long)good_end, SEEK_SET) == 0 &&
+                   fread(&rh, sizeof(rh), 1, f) == 1 && rh.record_size >= sizeof(RecordHeader) &&
+                   rh.header_size >= sizeof(RecordHeader) && rh.header_size <= rh.record_size &&
+                   good_end + (long long)rh.record_size <= file_end)
+                good_end += rh.record_size;
+            bool ok = good_end <= file_end;
+            if (ok && good_end < file_end) {
+                fflush(f);
+#if defined(_WIN32)
+                ok = _chsize_s(_fileno(f), good_end) == 0;
+#else
+                ok = ftruncate(fileno(f), (off_t)good_end) == 0;
+#endif
+            }
+            ok = ok && fseek(f, 0, SEEK_END) == 0;
+            if (!ok) { fclose(f); return false; }
+            fp_ = f;
+            return true;
+        }
+    }
+    fp_ = fopen(path.c_str(), "wb");
+    if (!fp_) return false;
+    FileHeader h{};
+    memcpy(h.magic, "CHRR", 4);
+    h.version     = kResultRecordVersion;
+    h.header_size = (uint16_t)sizeof(FileHeader);
+    if (fwrite(&h, sizeof(h), 1, fp_) != 1) { close(); return false; }
+    return true;
+}
+
+bool ResultRecordWriter::append(const ChipResult& r, uint64_t frame_id, int64_t timestamp_us)
+{
+    if (!fp_) return false;
+    encodeResultRecord(r, frame_id, timestamp_us, buf_);
+    ++records_;
+    return buf_.size() < flush_bytes || flush();
+}
+
+bool ResultRecordWriter::append(const std::vector<ChipResult>& rs, uint64_t frame_id, int64_t timestamp_us)
+{
+    if (!fp_) return false;
+    for (const auto& r : rs) encodeResultRecord(r, frame_id, timestamp_us, buf_);
+    records_ += (long long)rs.size();
+    return buf_.size() < flush_bytes || flush();
+}
+
+bool ResultRecordWriter::flush()
+{
+    if (!fp_) return false;
+    const bool ok = buf_.empty() || fwrite(buf_.data(), 1, buf_.size(), fp_) == buf_.size();
+    buf_.clear();
+    return fflush(fp_) == 0 && ok;
+}
+
+void ResultRecordWriter::close()
+{
+    if (fp_) { flush(); fclose(fp_); fp_ = nullptr; }
+    buf_.clear();
+    records_ = 0;
+}
+
+bool ResultRecordReader::open(const std::string& path)
+{
+    close();
+    fp_ = fopen(path.c_str(), "rb");
+    if (!fp_) return false;
+    FileHeader h{};
+    if (fread(&h, sizeof(h), 1, fp_) != 1 || memcmp(h.magic, "CHRR", 4) != 0 ||
+        h.header_size < sizeof(FileHeader) || fseek(fp_, h.header_size, SEEK_SET) != 0) {
+        close(); return false;
+    }
+    version_ = h.version;
+    end_ = h.header_size;   // 第一次 next 时取实际长度
+    return true;
+}
+
+bool ResultRecordReader::next(ResultRecord& rec)
+{
+    if (!fp_) return false;
+    const long long pos = (long long)ftell(fp_);
+    uint32_t size = 0;
+    if (pos < 0 || fread(&size, sizeof(size), 1, fp_) != 1 || size < sizeof(RecordHeader)) return false;
+    // size 来自文件：先和剩余字节数、单条上限比，坏长度不能触发大块分配。
+    // 文件可能还在被追加，超出已知长度时重新取一次
+    if (size > kMaxRecordBytes) return false;
+    if (pos + (long long)size > end_) {
+        if (fseek(fp_, 0, SEEK_END) != 0) return false;
+        end_ = (long long)ftell(fp_);
+        if (fseek(fp_, (long)(pos + (long long)sizeof(size)), SEEK_SET) != 0) return false;
+        if (pos + (long long)size > end_) return false;
+    }
+    buf_.resize(size);
+    memcpy(buf_.data(), &size, sizeof(size));
+    if (fread(buf_.data() + sizeof(size), 1, size - sizeof(size), fp_) != size - sizeof(size)) return false;
+    return decodeResultRecord(buf_.data(), buf_.size(), rec);
+}
+
+void ResultRecordReader::close()
+{
+    if (fp_) { fclose(fp_); fp_ = nullptr; }
+    version_ = 0;
+    end_ = 0;
+    buf_.clear();
+}
+
+void writeResultCsvHeader(TextBuffer& tb)
+{
+    tb.put("frame_id,chip,kind,wr,wc,pr,pc,x,y,valid,measured\n");
+}
+
+void writeResultCsv(TextBuffer& tb, const ResultRecord& rec)
+{
+    const ChipResult& c = rec.chip;
+    const char* kind = chipKindName(c.kind);
+    auto pt = c.points.begin();
+    for (int wr = 0; wr < (int)c.wells_per_row.size(); ++wr)
+    for (int wc = 0; wc < c.wells_per_row[wr]; ++wc)
+    for (int pr = 0; pr < c.point_rows; ++pr)
+    for (int pc = 0; pc < c.point_cols; ++pc) {
+        tb.putInt((long long)rec.frame_id).put(',').putInt(c.chip_index).put(',').put(kind).put(',')
+          .putInt(wr).put(',').putInt(wc).put(',').putInt(pr).put(',').putInt(pc).put(',');
+        // points 按格序排列（见 decodeResultRecord）
+        if (pt != c.points.end() && pt->wr == wr && pt->wc == wc && pt->pr == pr && pt->pc == pc) {
+            tb.putFixed(pt->x, 2, "").put(',').putFixed(pt->y, 2, "").put(",1,").put(pt->measured ? '1' : '0').put('\n');
+            ++pt;
+        } else {
+            tb.put(",,0,0\n");
+        }
+    }
+}
+
+void writeResultSummaryCsvHeader(TextBuffer& tb)
+{
+    tb.put("frame_id,timestamp_us,chip,kind,ok,rejected,roi_x,roi_y,roi_w,roi_h,wells,points,slots,"
+           "low_v,high_v,otsu_th,spots,clusters,grid_keeps,redetect_wells,redetect_recovered,"
+           "lattice_replaced,degrade,elapsed_ms,over_budget\n");
+}
+
+void writeResultSummaryCsv(TextBuffer& tb, const ResultRecord& rec)
+{
+    const ChipResult& c = rec.chip;
+    const SD_Report& r = c.report;
+    tb.putInt((long long)rec.frame_id).put(',').putInt(rec.timestamp_us).put(',').putInt(c.chip_index).put(',')
+      .put(chipKindName(c.kind)).put(',').put(c.ok ? '1' : '0').put(',').put(r.rejected ? '1' : '0').put(',')
+      .putInt(c.roi.x).put(',').putInt(c.roi.y).put(',').putInt(c.roi.width).put(',').putInt(c.roi.height).put(',')
+      .putInt(totalWells(c.wells_per_row)).put(',').putInt((long long)c.points.size()).put(',').putInt(c.slots).put(',')
+      .putInt(r.low_v).put(',').putInt(r.high_v).put(',').putFixed(r.otsu_th, 3).put(',')
+      .putInt(r.spots).put(',').putInt(r.clusters).put(',').putInt(r.grid_keeps).put(',')
+      .putInt(r.redetect_wells).put(',').putInt(r.redetect_recovered).put(',').putInt(r.lattice_replaced).put(',')
+      .putInt(r.degrade).put(',').putFixed(r.elapsed_ms, 3).put(',').put(r.over_budget ? '1' : '0').put('\n');
+}
@@ -0,0 +1,68 @@
+#include "ResultScore.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+
+using namespace std;
+
+ResultScore scoreChipResult(const ChipResult& r)
+{
+    ResultScore s;
+    if (r.slots <= 0 || r.points.empty()) return s;
+
+    // 按 (wr,wc,pr,pc) 建索引，找同孔内右邻 / 下邻
+    map<long long, const ChipPoint*> at;
+    set<pair<int,int>> wells;
+    auto key = [](int wr, int wc, int pr, int pc){
+        return (((long long)wr * 1024 + wc) * 1024 + pr) * 1024 + pc;
+    };
+    for (const auto& p : r.points) {
+        at[key(p.wr, p.wc, p.pr, p.pc)] = &p;
+        wells.insert({p.wr, p.wc});
+    }
+    s.wells = (int)wells.size();
+    s.completeness = std::min(1.f, (float)r.points.size() / (float)r.slots);
+
+    // 横向、纵向间距分开算（PG 的横纵点距不同）
+    vector<double> dh, dv;
+    for (const auto& p : r.points) {
+        auto rt = at.find(key(p.wr, p.wc, p.pr, p.pc + 1));
+        if (rt != at.end()) dh.push_back(std::hypot(rt->second->x - p.x, rt->second->y - p.y));
+        auto dn = at.find(key(p.wr, p.wc, p.pr + 1, p.pc));
+        if (dn != at.end()) dv.push_back(std::hypot(dn->second->x - p.x, dn->second->y - p.y));
+    }
+    auto cvOf = [](const vector<double>& d){
+        double m = 0, v = 0;
+        for (double x : d) m += x;
+        m /= d.size();
+        for (double x : d) v += (x - m) * (x - m);
+        return m > 0 ? std::sqrt(v / d.size()) / m : 1.0;
+    };
+    double cv = 0; int nc = 0;
+    if (dh.size() >= 2) { cv += cvOf(dh); ++nc; }
+    if (dv.size() >= 2) { cv += cvOf(dv); ++nc; }
+    s.regularity = nc ? (float)std::max(0.0, 1.0 - cv / nc) : 0.f;
+    s.score = s.completeness * s.regularity;
+    return s;
+}
+
+BatchScore scoreBatch(const std::vector<ResultScore>& per_image)
+{
+    BatchScore b;
+    if (per_image.empty()) return b;
+    map<int,int> hist;
+    for (const auto& s : per_image) {
+        b.score        += s.score;
+        b.completeness += s.completeness;
+        b.regularity   += s.regularity;
+        if (s.wells > 0) hist[s.wells]++;
+    }
+    const float n = (float)per_image.size();
+    b.score /= n; b.completeness /= n; b.regularity /= n;
+    int best = 0;
+    for (const auto& kv : hist) if (kv.second > best) { best = kv.second; b.modal_wells = kv.first; }
+    b.well_consistency = best / n;
+    b.score *= b.well_consistency;
+    return b;
+}
@@ -0,0 +1,356 @@
+#include "ShmRing.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+#if !defined(_WIN32)
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+#if !defined(_WIN32)
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "process-shared ring needs lock-free 64-bit atomics");
+
+// 共享内存里的环头。位置计数各占一条缓存行，避免读写两端互相抖动
+struct ShmRingHeader {
+    char     magic[4];          // 初始化完成后最后写入
+    uint16_t version;
+    uint16_t header_size;       // 槽区起点
+    uint32_t slots;
+    uint32_t reserved0;
+    uint64_t slot_bytes;        // 每槽负载字节数
+    uint64_t slot_stride;       // 元数据 + 负载
+    alignas(64) std::atomic<uint64_t> write_pos;
+    alignas(64) std::atomic<uint64_t> read_pos;
+    alignas(64) sem_t items;    // 已发布未读
+    sem_t spaces;               // 空槽
+};
+
+// 槽序号 seq：== pos 可写；== pos + 1 已发布可读；== pos + slots 已归还（下一轮可写）
+struct ShmSlotMeta {
+    std::atomic<uint64_t> seq;
+    uint64_t bytes;
+    uint8_t  reserved[48];
+};
+static_assert(sizeof(ShmSlotMeta) == 64, "ShmSlotMeta must be 64 bytes");
+
+namespace {
+
+const char kMagic[4] = {'C', 'H', 'S', 'R'};
+
+size_t align64(size_t n) { return (n + 63) & ~(size_t)63; }
+
+string shmName(const string& name)
+{
+    return name.empty() || name[0] == '/' ? name : "/" + name;
+}
+
+ShmSlotMeta* slotMeta(ShmRingHeader* h, uint64_t pos)
+{
+    uint8_t* base = reinterpret_cast<uint8_t*>(h) + h->header_size;
+    return reinterpret_cast<ShmSlotMeta*>(base + (pos % h->slots) * h->slot_stride);
+}
+
+// timeout_ms < 0 一直等；被信号打断时重试
+bool semWait(sem_t* s, int timeout_ms)
+{
+    if (timeout_ms == 0) {
+        while (sem_trywait(s) != 0) if (errno != EINTR) return false;
+        return true;
+    }
+    if (timeout_ms < 0) {
+        while (sem_wait(s) != 0) if (errno != EINTR) return false;
+        return true;
+    }
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) { ts.tv_sec += 1; ts.tv_nsec -= 1000000000L; }
+    while (sem_timedwait(s, &ts) != 0) if (errno != EINTR) return false;
+    return true;
+}
+
+// 拿到信号量后，pos 处的槽可能还没轮到（对端乱序归还 / 发布），在超时范围内让一让再看；
+// timeout_ms == 0 不等
+bool waitTurn(int timeout_ms, chrono::steady_clock::time_point deadline, int& spins)
+{
+    if (timeout_ms == 0) return false;
+    if (timeout_ms > 0 && chrono::steady_clock::now() >= deadline) return false;
+    if (++spins < 64) std::this_thread::yield();
+    else std::this_thread::sleep_for(chrono::microseconds(50));
+    return true;
+}
+
+}
+
+bool ShmRing::create(const std::string& name, uint32_t slots, size_t slot_bytes)
+{
+    close();
+    if (slots == 0 || slot_bytes == 0) return false;
+    const string n = shmName(name);
+    shm_unlink(n.c_str());
+    const int fd = shm_open(n.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+
+    const size_t hsize  = align64(sizeof(ShmRingHeader));
+    const size_t stride = sizeof(ShmSlotMeta) + align64(slot_bytes);
+    const size_t total  = hsize + stride * slots;
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)total) == 0)
+        p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { shm_unlink(n.c_str()); return false; }
+
+    // ftruncate 出来的内存全为 0，magic 为空，打开方会等到初始化完成
+    ShmRingHeader* h = static_cast<ShmRingHeader*>(p);
+    h->version     = kShmRingVersion;
+    h->header_size = (uint16_t)hsize;
+    h->slots       = slots;
+    h->slot_bytes  = align64(slot_bytes);
+    h->slot_stride = stride;
+    new (&h->write_pos) std::atomic<uint64_t>(0);
+    new (&h->read_pos) std::atomic<uint64_t>(0);
+    if (sem_init(&h->items, 1, 0) != 0 || sem_init(&h->spaces, 1, slots) != 0) {
+        munmap(p, total);
+        shm_unlink(n.c_str());
+        return false;
+    }
+    for (uint32_t i = 0; i < slots; ++i) {
+        ShmSlotMeta* m = slotMeta(h, i);
+        new (&m->seq) std::atomic<uint64_t>(i);
+        m->bytes = 0;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(h->magic, kMagic, sizeof(kMagic));
+
+    hdr_ = h;
+    map_bytes_ = total;
+    name_ = n;
+    return true;
+}
+
+bool ShmRing::open(const std::string& name)
+{
+    close();
+    const string n = shmName(name);
+    const int fd = shm_open(n.c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmRingHeader)) { ::close(fd); return false; }
+    const size_t total = (size_t)st.st_size;
+    void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    ShmRingHeader* h = static_cast<ShmRingHeader*>(p);
+    const bool ready = memcmp(h->magic, kMagic, sizeof(kMagic)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!ready || h->version != kShmRingVersion || h->slots == 0 ||
+        h->header_size + h->slot_stride * (uint64_t)h->slots > total) {
+        munmap(p, total);
+        return false;
+    }
+    hdr_ = h;
+    map_bytes_ = total;
+    name_ = n;
+    return true;
+}
+
+void ShmRing::close()
+{
+    if (hdr_) munmap(hdr_, map_bytes_);
+    hdr_ = nullptr;
+    map_bytes_ = 0;
+    name_.clear();
+}
+
+bool ShmRing::remove(const std::string& name)
+{
+    return shm_unlink(shmName(name).c_str()) == 0;
+}
+
+uint32_t ShmRing::slots() const     { return hdr_ ? hdr_->slots : 0; }
+size_t   ShmRing::slotBytes() const { return hdr_ ? (size_t)hdr_->slot_bytes : 0; }
+uint64_t ShmRing::writePos() const  { return hdr_ ? hdr_->write_pos.load(std::memory_order_relaxed) : 0; }
+uint64_t ShmRing::readPos() const   { return hdr_ ? hdr_->read_pos.load(std::memory_order_relaxed) : 0; }
+
+bool ShmRing::beginWrite(Slot& s, int timeout_ms)
+{
+    const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(std::max(0, timeout_ms));
+    if (!hdr_ || !semWait(&hdr_->spaces, timeout_ms)) return false;
+    // 拿到空位后认领 write_pos 处的槽；读端乱序归还时该槽可能还没空出来，
+    // 超时则把空位还回去，不让写端（采集线程）被一帧慢检测拖住
+    uint64_t pos = hdr_->write_pos.load(std::memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        ShmSlotMeta* m = slotMeta(hdr_, pos);
+        const int64_t dif = (int64_t)(m->seq.load(std::memory_order_acquire) - pos);
+        if (dif == 0) {
+            if (hdr_->write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                s.meta = m;
+                break;
+            }
+        } else if (dif < 0) {
+            if (!waitTurn(timeout_ms, deadline, spins)) {
+                sem_post(&hdr_->spaces);
+                return false;
+            }
+            pos = hdr_->write_pos.load(std::memory_order_relaxed);
+        } else {
+            pos = hdr_->write_pos.load(std::memory_order_relaxed);
+        }
+    }
+    s.pos      = pos;
+    s.data     = reinterpret_cast<uint8_t*>(s.meta) + sizeof(ShmSlotMeta);
+    s.capacity = (size_t)hdr_->slot_bytes;
+    s.bytes    = 0;
+    return true;
+}
+
+void ShmRing::commitWrite(Slot& s, size_t bytes)
+{
+    if (!hdr_ || !s.meta) return;
+    s.meta->bytes = std::min(bytes, s.capacity);
+    s.meta->seq.store(s.pos + 1, std::memory_order_release);
+    sem_post(&hdr_->items);
+    s.meta = nullptr;
+    s.data = nullptr;
+}
+
+bool ShmRing::beginRead(Slot& s, int timeout_ms)
+{
+    const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(std::max(0, timeout_ms));
+    if (!hdr_ || !semWait(&hdr_->items, timeout_ms)) return false;
+    // 多个写端可能乱序发布，read_pos 处的槽尚未发布时同样在超时范围内等
+    uint64_t pos = hdr_->read_pos.load(std::memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        ShmSlotMeta* m = slotMeta(hdr_, pos);
+        const int64_t dif = (int64_t)(m->seq.load(std::memory_order_acquire) - (pos + 1));
+        if (dif == 0) {
+            if (hdr_->read_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                s.meta = m;
+                break;
+            }
+        } else if (dif < 0) {
+            if (!waitTurn(timeout_ms, deadline, spins)) {
+                sem_post(&hdr_->items);
+                return false;
+            }
+            pos = hdr_->read_pos.load(std::memory_order_relaxed);
+        } else {
+            pos = hdr_->read_pos.load(std::memory_order_relaxed);
+        }
+    }
+    s.pos      = pos;
+    s.data     = reinterpret_cast<uint8_t*>(s.meta) + sizeof(ShmSlotMeta);
+    s.capacity = (size_t)hdr_->slot_bytes;
+    s.bytes    = (size_t)s.meta->bytes;
+    return true;
+}
+
+void ShmRing::endRead(Slot& s)
+{
+    if (!hdr_ || !s.meta) return;
+    s.meta->seq.store(s.pos + hdr_->slots, std::memory_order_release);
+    sem_post(&hdr_->spaces);
+    s.meta = nullptr;
+    s.data = nullptr;
+}
+
+#else
+
+struct ShmRingHeader {};
+struct ShmSlotMeta {};
+
+bool ShmRing::create(const std::string&, uint32_t, size_t) { return false; }
+bool ShmRing::open(const std::string&) { return false; }
+void ShmRing::close() {}
+bool ShmRing::remove(const std::string&) { return false; }
+uint32_t ShmRing::slots() const     { return 0; }
+size_t   ShmRing::slotBytes() const { return 0; }
+uint64_t ShmRing::writePos() const  { return 0; }
+uint64_t ShmRing::readPos() const   { return 0; }
+bool ShmRing::beginWrite(Slot&, int) { return false; }
+void ShmRing::commitWrite(Slot&, size_t) {}
+bool ShmRing::beginRead(Slot&, int) { return false; }
+void ShmRing::endRead(Slot&) {}
+
+#endif
+
+int64_t shmNowUs()
+{
+    // steady_clock 在 Linux 上即 CLOCK_MONOTONIC，同机各进程同一时基
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t shmFrameSlotBytes(int max_w, int max_h)
+{
+    return sizeof(ShmFrameHeader) + (size_t)std::max(0, max_w) * sizeof(uint16_t) * (size_t)std::max(0, max_h);
+}
+
+cv::Mat shmFrameMat(const ShmRing::Slot& s)
+{
+    if (!s.data || s.bytes < sizeof(ShmFrameHeader)) return Mat();
+    const ShmFrameHeader* h = shmFrameHeader(s);
+    const size_t row = (size_t)std::max(0, h->width) * sizeof(uint16_t);
+    if (h->width <= 0 || h->height <= 0 || h->stride < row || h->stride % 2 ||
+        sizeof(ShmFrameHeader) + (size_t)h->stride * (size_t)h->height > s.bytes)
+        return Mat();
+    return Mat(h->height, h->width, CV_16UC1, shmFramePixels(s), h->stride);
+}
+
+bool shmPutFrame(ShmRing::Slot& s, const cv::Mat& img16, uint64_t frame_id, int64_t timestamp_us, int kind)
+{
+    if (!s.data || img16.empty() || img16.type() != CV_16UC1) return false;
+    const size_t row = (size_t)img16.cols * sizeof(uint16_t);
+    const size_t need = sizeof(ShmFrameHeader) + row * (size_t)img16.rows;
+    if (need > s.capacity) return false;
+    ShmFrameHeader* h = shmFrameHeader(s);
+    memset(h, 0, sizeof(*h));
+    h->frame_id     = frame_id;
+    h->timestamp_us = timestamp_us;
+    h->width        = img16.cols;
+    h->height       = img16.rows;
+    h->stride       = (uint32_t)row;
+    h->kind         = kind;
+    uint8_t* dst = reinterpret_cast<uint8_t*>(shmFramePixels(s));
+    for (int y = 0; y < img16.rows; ++y)
+        memcpy(dst + row * (size_t)y, img16.ptr(y), row);
+    s.bytes = need;
+    return true;
+}
+
+bool postShmResult(ShmRing& ring, const ChipResult& r, uint64_t frame_id, int64_t timestamp_us,
+                   std::vector<uint8_t>& scratch, int timeout_ms)
+{
+    scratch.clear();
+    encodeResultRecord(r, frame_id, timestamp_us, scratch);
+    if (scratch.size() > ring.slotBytes()) return false;
+    ShmRing::Slot s;
+    if (!ring.beginWrite(s, timeout_ms)) return false;
+    memcpy(s.data, scratch.data(), scratch.size());
+    ring.commitWrite(s, scratch.size());
+    return true;
+}
+
+bool takeShmResult(ShmRing& ring, ResultRecord& rec, int timeout_ms)
+{
+    ShmRing::Slot s;
+    if (!ring.beginRead(s, timeout_ms)) return false;
+    const bool ok = decodeResultRecord(s.data, s.bytes, rec);
+    ring.endRead(s);
+    return ok;
+}
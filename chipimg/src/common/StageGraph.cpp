@@ -0,0 +1,161 @@
+#include "StageGraph.h"
+#include "PercentileEstimator.h"
+#include <algorithm>
+#include <thread>
+
+using namespace cv;
+using namespace std;
+
+void StageCache::clear()
+{
+    lock_guard<mutex> lk(mtx_);
+    map_.clear();
+}
+
+size_t StageCache::erasePrefix(const std::string& prefix)
+{
+    lock_guard<mutex> lk(mtx_);
+    size_t n = 0;
+    for (auto it = map_.begin(); it != map_.end(); ) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) { it = map_.erase(it); ++n; }
+        else ++it;
+    }
+    return n;
+}
+
+size_t StageCache::size() const
+{
+    lock_guard<mutex> lk(mtx_);
+    return map_.size();
+}
+
+void runParallel(int n, int workers, const std::function<void(int)>& fn)
+{
+    if (n <= 0) return;
+    int nw = workers > 0 ? workers : (int)std::thread::hardware_concurrency();
+    nw = std::max(1, std::min(nw, n));
+    atomic<int> next{0};
+    auto work = [&]{
+        for (int i; (i = next.fetch_add(1)) < n; ) fn(i);
+    };
+    vector<thread> pool;
+    for (int t = 1; t < nw; ++t) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+}
+
+static Mat stretch16U(const Mat& src16, uint16_t a, uint16_t b) {
+    if (a >= b) return src16.clone();
+    Mat f, dst16;
+    src16.convertTo(f, CV_32F);
+    f = (f - (float)a) * (65535.0f / (float)(b - a));
+    threshold(f, f, 65535.0, 65535.0, THRESH_TRUNC);
+    threshold(f, f, 0.0, 0.0, THRESH_TOZERO);
+    f.convertTo(dst16, CV_16U);
+    return dst16;
+}
+
+static Mat gamma16U(const Mat& src16, float gamma) {
+    Mat f; src16.convertTo(f, CV_32F, 1.0/65535.0);
+    pow(f, gamma, f);
+    Mat out; f.convertTo(out, CV_16U, 65535.0);
+    return out;
+}
+
+void computeBlobSet(const cv::Mat& src16, uint16_t low_v, uint16_t high_v, double gamma,
+                    EnhanceMode mode, double th, double otsu_scale, int band_rows,
+                    const uint32_t* hist16, BlobSet& out)
+{
+    out = BlobSet{};
+    out.low_v = low_v;
+    out.high_v = high_v;
+    if (src16.empty() || src16.type() != CV_16UC1) return;
+
+    if (mode == ENH_PLAIN && band_rows > 0 && (hist16 || th >= 0.0)) {
+        vector<uint8_t> lut;
+        buildEnhanceLut8(low_v, high_v, (float)gamma, lut);
+        stripedBlobs16U(src16, lut, hist16, th, otsu_scale, band_rows, out.blobs, &out.otsu);
+        return;
+    }
+
+    // 与各型号 findClusters* 的整帧路径逐步相同
+    Mat enhanced = gamma16U(stretch16U(src16, low_v, high_v), (float)gamma);
+    if (mode == ENH_CLAHE) {
+        Mat eq16;
+        Ptr<CLAHE> clahe = createCLAHE(2.0, Size(8,8));
+        clahe->apply(enhanced, eq16);
+        enhanced = eq16;
+    }
+    Mat view8; enhanced.convertTo(view8, CV_8U, 1.0/256.0);
+    Mat bin8;
+    if (th < 0.0) {
+        th = threshold(view8, bin8, 0, 255, THRESH_BINARY | THRESH_OTSU);
+        if (otsu_scale != 1.0) {
+            th = std::max(0.0, std::min(255.0, th * otsu_scale));
+            threshold(view8, bin8, th, 255, THRESH_BINARY);
+        }
+    } else {
+        threshold(view8, bin8, th, 255, THRESH_BINARY);
+    }
+    out.otsu = th;
+
+    Mat labels, stats, centroids;
+    const int n = connectedComponentsWithStats(bin8, labels, stats, centroids, 8, CV_32S);
+    out.blobs.reserve(std::max(0, n - 1));
+    for (int i = 1; i < n; ++i) {
+        BlobStat b;
+        b.area = stats.at<int>(i, CC_STAT_AREA);
+        b.bbox = Rect(stats.at<int>(i, CC_STAT_LEFT), stats.at<int>(i, CC_STAT_TOP),
+                      stats.at<int>(i, CC_STAT_WIDTH), stats.at<int>(i, CC_STAT_HEIGHT));
+        b.centroid = Point2f((float)centroids.at<double>(i, 0), (float)centroids.at<double>(i, 1));
+        out.blobs.push_back(b);
+    }
+}
+
+FrameStages::FrameStages(const cv::Mat& src16, std::shared_ptr<StageCache> cache, int band_rows,
+                         const uint32_t* hist16)
+    : src16_(src16), cache_(cache ? cache : std::make_shared<StageCache>()), band_rows_(band_rows),
+      hist16_(hist16)
+{
+}
+
+std::shared_ptr<const std::vector<uint32_t>> FrameStages::histogram()
+{
+    return cache_->get<vector<uint32_t>>(stageKey("hist"), [&]{
+        if (hist16_) return vector<uint32_t>(hist16_, hist16_ + 65536);
+        vector<uint32_t> h(65536, 0u);
+        if (!src16_.empty() && src16_.type() == CV_16UC1)
+            accumulateHistogram16U(src16_, 0, src16_.rows, h.data());
+        return h;
+    });
+}
+
+std::shared_ptr<const PercentilePair> FrameStages::percentiles(double low_pct, double high_pct)
+{
+    return cache_->get<PercentilePair>(stageKey("pct", low_pct, high_pct), [&]{
+        auto h = histogram();
+        PercentilePair p;
+        percentileFromHistogram16U(h->data(), 1LL * src16_.rows * src16_.cols,
+                                   low_pct, high_pct, p.low_v, p.high_v);
+        return p;
+    });
+}
+
+std::shared_ptr<const BlobSet> FrameStages::blobs(double low_pct, double high_pct, double gamma,
+                                                  EnhanceMode mode, double th, double otsu_scale)
+{
+    // key 用百分位换算后的拉伸区间：不同百分位落到同一区间时共用结果
+    auto p = percentiles(low_pct, high_pct);
+    return cache_->get<BlobSet>(stageKey("blobs", p->low_v, p->high_v, gamma, (int)mode, th, otsu_scale), [&]{
+        auto h = histogram();
+        BlobSet b;
+        computeBlobSet(src16_, p->low_v, p->high_v, gamma, mode, th, otsu_scale, band_rows_, h->data(), b);
+        return b;
+    });
+}
+
+void FrameStages::releaseBlobs(double low_pct, double high_pct, double gamma)
+{
+    auto p = percentiles(low_pct, high_pct);
+    cache_->erasePrefix(stageKey("blobs", p->low_v, p->high_v, gamma) + "|");
+}
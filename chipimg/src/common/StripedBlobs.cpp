@@ -0,0 +1,168 @@
+#include "StripedBlobs.h"
+#include "DetectScratch.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+using namespace cv;
+using namespace std;
+
+void accumulateHistogram16U(const cv::Mat& src16, int row0, int rows, uint32_t* hist)
+{
+    CV_Assert(src16.type() == CV_16UC1);
+    const int r1 = std::min(src16.rows, row0 + rows);
+    for (int r = std::max(0, row0); r < r1; ++r) {
+        const uint16_t* p = src16.ptr<uint16_t>(r);
+        for (int c = 0; c < src16.cols; ++c) hist[p[c]]++;
+    }
+}
+
+void buildEnhanceLut8(uint16_t a, uint16_t b, float gamma, std::vector<uint8_t>& lut)
+{
+    lut.resize(65536);
+    const float k = (a < b) ? 65535.0f / (float)(b - a) : 1.0f;
+    for (int v = 0; v < 65536; ++v) {
+        int s = v;
+        if (a < b) {
+            float f = ((float)v - (float)a) * k;
+            f = std::min(f, 65535.0f);
+            if (!(f > 0.0f)) f = 0.0f;
+            s = saturate_cast<uint16_t>(f);
+        }
+        const float g = std::pow((float)(s * (1.0 / 65535.0)), gamma);
+        const uint16_t e = saturate_cast<uint16_t>(g * 65535.0);
+        lut[v] = saturate_cast<uchar>(e * (1.0 / 256.0));
+    }
+}
+
+double otsuThreshold8(const uint64_t* hist256)
+{
+    double N = 0.0, mu = 0.0;
+    for (int i = 0; i < 256; ++i) { N += (double)hist256[i]; mu += i * (double)hist256[i]; }
+    if (N <= 0.0) return 0.0;
+    mu /= N;
+
+    double q1 = 0.0, mu1 = 0.0, max_sigma = 0.0, max_val = 0.0;
+    for (int i = 0; i < 256; ++i) {
+        const double p_i = hist256[i] / N;
+        mu1 *= q1;
+        q1 += p_i;
+        const double q2 = 1.0 - q1;
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1.0 - FLT_EPSILON) continue;
+        mu1 = (mu1 + i * p_i) / q1;
+        const double mu2 = (mu - q1 * mu1) / q2;
+        const double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > max_sigma) { max_sigma = sigma; max_val = i; }
+    }
+    return max_val;
+}
+
+namespace {
+struct Piece {
+    int    area = 0;
+    Rect   bbox;
+    double sx = 0.0, sy = 0.0;
+};
+}
+
+bool stripedBlobs16U(const cv::Mat& src16, const std::vector<uint8_t>& lut,
+                     const uint32_t* hist16, double th, double otsu_scale,
+                     int band_rows, std::vector<BlobStat>& out, double* out_th,
+                     DetectScratch* scratch)
+{
+    out.clear();
+    if (src16.empty() || src16.type() != CV_16UC1 || lut.size() != 65536) return false;
+
+    if (th < 0.0) {
+        if (!hist16) return false;
+        uint64_t h8[256] = {0};
+        for (int v = 0; v < 65536; ++v) h8[lut[v]] += hist16[v];
+        th = otsuThreshold8(h8);
+        if (otsu_scale != 1.0) th = std::max(0.0, std::min(255.0, th * otsu_scale));
+    }
+    if (out_th) *out_th = th;
+
+    // 前景：lut 值 > th
+    uint8_t fg[256];
+    for (int i = 0; i < 256; ++i) fg[i] = (i > th) ? 255 : 0;
+
+    const int W = src16.cols;
+    const int band = std::max(1, band_rows);
+
+    vector<Piece> pieces;
+    vector<int>   parent;
+    auto find = [&](int x){
+        while (parent[x] != x) { parent[x] = parent[parent[x]]; x = parent[x]; }
+        return x;
+    };
+    auto unite = [&](int x, int y){
+        x = find(x); y = find(y);
+        if (x == y) return;
+        if (y < x) std::swap(x, y);
+        parent[y] = x;   // 根取编号小的，即光栅序靠前的
+    };
+
+    Mat local_bin, local_labels, stats, centroids;
+    Mat& bin    = scratch ? scratch->band_bin    : local_bin;
+    Mat& labels = scratch ? scratch->band_labels : local_labels;
+    vector<int> prev_last(W, -1), cur_last(W, -1);
+    for (int r0 = 0; r0 < src16.rows; r0 += band) {
+        const int rows = std::min(band, src16.rows - r0);
+        bin.create(rows, W, CV_8U);
+        for (int r = 0; r < rows; ++r) {
+            const uint16_t* p = src16.ptr<uint16_t>(r0 + r);
+            uchar* q = bin.ptr<uchar>(r);
+            for (int c = 0; c < W; ++c) q[c] = fg[lut[p[c]]];
+        }
+
+        const int n = connectedComponentsWithStats(bin, labels, stats, centroids, 8, CV_32S);
+        const int base = (int)pieces.size() - 1;   // 带内标签 l -> 全局 base + l
+        for (int l = 1; l < n; ++l) {
+            Piece pc;
+            pc.area = stats.at<int>(l, CC_STAT_AREA);
+            pc.bbox = Rect(stats.at<int>(l, CC_STAT_LEFT), stats.at<int>(l, CC_STAT_TOP) + r0,
+                           stats.at<int>(l, CC_STAT_WIDTH), stats.at<int>(l, CC_STAT_HEIGHT));
+            pc.sx = centroids.at<double>(l, 0) * pc.area;
+            pc.sy = (centroids.at<double>(l, 1) + r0) * pc.area;
+            pieces.push_back(pc);
+            parent.push_back((int)parent.size());
+        }
+
+        // 缝：本带首行与上一带末行做 8 邻接合并
+        if (r0 > 0) {
+            const int* f = labels.ptr<int>(0);
+            for (int c = 0; c < W; ++c) {
+                if (f[c] <= 0) continue;
+                for (int dc = -1; dc <= 1; ++dc) {
+                    const int cc = c + dc;
+                    if (cc < 0 || cc >= W || prev_last[cc] < 0) continue;
+                    unite(base + f[c], prev_last[cc]);
+                }
+            }
+        }
+        const int* l = labels.ptr<int>(rows - 1);
+        for (int c = 0; c < W; ++c) cur_last[c] = l[c] > 0 ? base + l[c] : -1;
+        std::swap(prev_last, cur_last);
+    }
+
+    // 按根合并；根是分量里编号最小的片段，遍历顺序即光栅序
+    vector<int> slot(pieces.size(), -1);
+    vector<double> sx, sy;
+    for (int i = 0; i < (int)pieces.size(); ++i) {
+        const int r = find(i);
+        if (slot[r] < 0) {
+            slot[r] = (int)out.size();
+            out.push_back(BlobStat{0, pieces[i].bbox, Point2f()});
+            sx.push_back(0.0); sy.push_back(0.0);
+        }
+        BlobStat& b = out[slot[r]];
+        if (b.area > 0) b.bbox |= pieces[i].bbox;
+        b.area += pieces[i].area;
+        sx[slot[r]] += pieces[i].sx;
+        sy[slot[r]] += pieces[i].sy;
+    }
+    for (size_t k = 0; k < out.size(); ++k)
+        out[k].centroid = Point2f((float)(sx[k] / out[k].area), (float)(sy[k] / out[k].area));
+    return true;
+}
@@ -0,0 +1,149 @@
+#include "TextWriter.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+TextBuffer& TextBuffer::put(const char* s)
+{
+    return put(s, strlen(s));
+}
+
+TextBuffer& TextBuffer::putInt(long long v)
+{
+    char tmp[24];
+    const auto r = std::to_chars(tmp, tmp + sizeof(tmp), v);
+    return put(tmp, (size_t)(r.ptr - tmp));
+}
+
+TextBuffer& TextBuffer::putFixed(double v, int decimals, const char* nan_text)
+{
+    static const long long kPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000,
+                                       10000000, 100000000, 1000000000};
+    if (!std::isfinite(v)) return put(nan_text);
+    decimals = std::max(0, std::min(9, decimals));
+    const long long scale = kPow10[decimals];
+    const double a = std::fabs(v) * (double)scale;
+    if (a >= 9.0e18) {   // 超出定点范围（实际坐标不会出现）
+        char tmp[64];
+        const int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+        return put(tmp, (size_t)std::max(0, std::min(n, (int)sizeof(tmp) - 1)));
+    }
+    const long long q = llround(a);
+    if (v < 0 && q) put('-');
+    putInt(q / scale);
+    long long frac = q % scale;
+    if (!frac) return *this;
+    char d[9];
+    for (int i = decimals - 1; i >= 0; --i) { d[i] = (char)('0' + frac % 10); frac /= 10; }
+    int n = decimals;
+    while (n > 0 && d[n - 1] == '0') --n;
+    return put('.').put(d, (size_t)n);
+}
+
+bool TextBuffer::writeTo(std::FILE* fp) const
+{
+    return fp && (buf_.empty() || fwrite(buf_.data(), 1, buf_.size(), fp) == buf_.size());
+}
+
+bool TextResultWriter::open(const std::string& path, bool append)
+{
+    close();
+    fp_ = fopen(path.c_str(), append ? "ab" : "wb");
+    owned_ = fp_ != nullptr;
+    return owned_;
+}
+
+void TextResultWriter::attach(std::FILE* fp)
+{
+    close();
+    fp_ = fp;
+    owned_ = false;
+}
+
+bool TextResultWriter::write(const TextBuffer& tb)
+{
+    lock_guard<mutex> lk(mtx_);
+    if (!fp_) return false;
+    bool ok = true;
+    if (pending_.size() + tb.size() > chunk_bytes) ok = flushLocked();
+    // 单块就超过 chunk_bytes 的直接写，不再拷一遍
+    if (tb.size() >= chunk_bytes) return tb.writeTo(fp_) && ok;
+    pending_.insert(pending_.end(), tb.data(), tb.data() + tb.size());
+    return ok;
+}
+
+bool TextResultWriter::flushLocked()
+{
+    if (!fp_) return false;
+    const bool ok = pending_.empty() || fwrite(pending_.data(), 1, pending_.size(), fp_) == pending_.size();
+    pending_.clear();
+    return ok;
+}
+
+bool TextResultWriter::flush()
+{
+    lock_guard<mutex> lk(mtx_);
+    const bool ok = flushLocked();
+    return fp_ && fflush(fp_) == 0 && ok;
+}
+
+void TextResultWriter::close()
+{
+    flush();
+    lock_guard<mutex> lk(mtx_);
+    if (fp_ && owned_) fclose(fp_);
+    fp_ = nullptr;
+    owned_ = false;
+    pending_.clear();
+}
+
+bool parseTextFormat(const char* s, TextFormat& f)
+{
+    if (!s) return false;
+    if (strcmp(s, "text") == 0) { f = TF_TEXT; return true; }
+    if (strcmp(s, "csv")  == 0) { f = TF_CSV;  return true; }
+    if (strcmp(s, "json") == 0) { f = TF_JSON; return true; }
+    return false;
+}
+
+void putPositionCsvHeader(TextBuffer& tb) { tb.put("frame,wr,wc,pr,pc,x,y,valid\n"); }
+void putBoxCsvHeader(TextBuffer& tb)      { tb.put("frame,i,x0,y0,x1,y1\n"); }
+void putCircleCsvHeader(TextBuffer& tb)   { tb.put("frame,i,x,y,r\n"); }
+void putChipCsvHeader(TextBuffer& tb)     { tb.put("frame,chip,kind,wr,wc,pr,pc,x,y,measured\n"); }
+
+void formatChipResult(TextBuffer& tb, TextFormat f, const ChipResult& r, long long frame)
+{
+    const char* kind = chipKindName(r.kind);
+    if (f == TF_TEXT) {
+        tb.put("Chip ").putInt(r.chip_index).put(" [").put(kind).put(r.auto_kind ? " auto" : "")
+          .put("] roi=(").putInt(r.roi.x).put(',').putInt(r.roi.y).put(' ')
+          .putInt(r.roi.width).put('x').putInt(r.roi.height).put(") ")
+          .put(r.ok ? "OK" : "FAIL").put("  points=").putInt((long long)r.points.size()).put('\n');
+        for (const auto& q : r.points) {
+            tb.put("  W(").putInt(q.wr).put(',').putInt(q.wc).put(") P(").putInt(q.pr).put(',').putInt(q.pc)
+              .put("): (").putFixed(q.x).put(", ").putFixed(q.y).put(')')
+              .put(q.measured ? "" : " [F]").put('\n');
+        }
+    } else if (f == TF_CSV) {
+        for (const auto& q : r.points) {
+            tb.putInt(frame).put(',').putInt(r.chip_index).put(',').put(kind).put(',')
+              .putInt(q.wr).put(',').putInt(q.wc).put(',').putInt(q.pr).put(',').putInt(q.pc).put(',')
+              .putFixed(q.x).put(',').putFixed(q.y).put(',').put(q.measured ? '1' : '0').put('\n');
+        }
+    } else {
+        tb.put("{\"frame\":").putInt(frame).put(",\"chip\":").putInt(r.chip_index)
+          .put(",\"kind\":\"").put(kind).put("\",\"ok\":").put(r.ok ? "true" : "false")
+          .put(",\"roi\":[").putInt(r.roi.x).put(',').putInt(r.roi.y).put(',')
+          .putInt(r.roi.width).put(',').putInt(r.roi.height).put("],\"points\":[");
+        for (size_t i = 0; i < r.points.size(); ++i) {
+            const auto& q = r.points[i];
+            tb.put(i ? ",[" : "[").putInt(q.wr).put(',').putInt(q.wc).put(',').putInt(q.pr).put(',')
+              .putInt(q.pc).put(',').putFixed(q.x, 2, "null").put(',').putFixed(q.y, 2, "null").put(',')
+              .put(q.measured ? '1' : '0').put(']');
+        }
+        tb.put("]}\n");
+    }
+}
@@ -0,0 +1,111 @@
+#include "TuneViewer.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+TuneStage firstDirtyStage(const ChipParams& a, const ChipParams& b)
+{
+    if (a.low_pct != b.low_pct || a.high_pct != b.high_pct || a.gamma_v != b.gamma_v) return TS_BLOBS;
+    if (a.area_min != b.area_min || a.EPS != b.EPS) return TS_CLUSTERS;
+    if (a.dy_thresh != b.dy_thresh) return TS_ANCHORS;
+    if (a.dx != b.dx || a.dy != b.dy || a.tol != b.tol) return TS_GRIDS;
+    if (a.up_a != b.up_a || a.down_b != b.down_b || a.left_c != b.left_c || a.right_d != b.right_d) return TS_MERGE;
+    return TS_DONE;
+}
+
+namespace {
+// 滑条只有整数位置：值 = 位置 / scale
+struct Slider {
+    const char* name;
+    double      scale;
+    int         max_pos;
+};
+
+const Slider kSliders[] = {
+    { "low_pct",   1e4,  500 },
+    { "high_pct",  1e4, 2000 },
+    { "gamma",     100,  400 },
+    { "area_min",    1,  500 },
+    { "eps",         1,  200 },
+    { "dy_thresh",  10,  300 },
+    { "dx",         10,  500 },
+    { "dy",         10,  500 },
+    { "tol",        10,  200 },
+    { "up_a",        1,  200 },
+    { "down_b",      1,  200 },
+    { "left_c",      1,  200 },
+    { "right_d",     1,  200 },
+};
+
+void printParams(const ChipParams& p)
+{
+    printf("low_pct=%.4f high_pct=%.4f gamma_v=%.2f area_min=%d EPS=%.1f\n"
+           "dy_thresh=%.1f dx=%.1f dy=%.1f tol=%.1f\n"
+           "up_a=%.1f down_b=%.1f left_c=%.1f right_d=%.1f\n",
+           p.low_pct, p.high_pct, p.gamma_v, p.area_min, p.EPS,
+           p.dy_thresh, p.dx, p.dy, p.tol,
+           p.up_a, p.down_b, p.left_c, p.right_d);
+    fflush(stdout);
+}
+}
+
+ChipParams runTuneViewer(TunePipeline& pipe, const cv::Mat& src16, const ChipParams& init,
+                         const std::string& title)
+{
+    const string ctrl = title + " | params";
+    namedWindow(title, WINDOW_AUTOSIZE);
+    namedWindow(ctrl, WINDOW_NORMAL);
+    for (const auto& s : kSliders) {
+        double v = 0;
+        getChipParam(init, s.name, v);
+        createTrackbar(s.name, ctrl, nullptr, s.max_pos);
+        setTrackbarPos(s.name, ctrl, std::min(s.max_pos, std::max(0, (int)std::lround(v * s.scale))));
+    }
+
+    // 底图只转一次，每次重画前拷贝
+    Mat view8; src16.convertTo(view8, CV_8U, 1.0 / 256.0);
+    Mat base;  cvtColor(view8, base, COLOR_GRAY2BGR);
+    Mat canvas;
+
+    // 滑条位置取整后可能与 init 有出入，以滑条为准
+    ChipParams cur = init;
+    for (const auto& s : kSliders)
+        setChipParam(cur, s.name, getTrackbarPos(s.name, ctrl) / s.scale);
+    pipe.update(cur, TS_BLOBS);
+
+    bool redraw = true;
+    for (;;) {
+        if (redraw) {
+            base.copyTo(canvas);
+            pipe.draw(canvas, cur);
+            const string status = cv::format("merged=%d | ms blobs=%.1f clusters=%.1f anchors=%.1f grids=%.1f merge=%.1f",
+                                             pipe.mergedPoints(),
+                                             pipe.stage_ms[TS_BLOBS], pipe.stage_ms[TS_CLUSTERS],
+                                             pipe.stage_ms[TS_ANCHORS], pipe.stage_ms[TS_GRIDS],
+                                             pipe.stage_ms[TS_MERGE]);
+            putText(canvas, status, Point(8, 20), FONT_HERSHEY_SIMPLEX, 0.5, Scalar(255, 255, 255), 1, LINE_AA);
+            imshow(title, canvas);
+            redraw = false;
+        }
+
+        const int key = waitKey(30);
+        if (key == 27 || key == 'q') break;
+        if (key == 13 || key == 10) printParams(cur);
+
+        ChipParams next = cur;
+        for (const auto& s : kSliders)
+            setChipParam(next, s.name, getTrackbarPos(s.name, ctrl) / s.scale);
+        if (next.low_pct + next.high_pct >= 1.0) continue;   // 上下两端裁掉的比例合计超过整幅，等松手
+        const TuneStage from = firstDirtyStage(cur, next);
+        if (from == TS_DONE) continue;
+        cur = next;
+        pipe.update(cur, from);
+        redraw = true;
+    }
+    destroyWindow(ctrl);
+    destroyWindow(title);
+    return cur;
+}
@@ -0,0 +1,177 @@
+#include "AsyncDetect.h"
+#include <algorithm>
+#include <exception>
+#include "DetectService.h"
+#include "PanelDetect.h"
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+double msBetween(chrono::steady_clock::time_point t0, chrono::steady_clock::time_point t1)
+{
+    return chrono::duration<double, milli>(t1 - t0).count();
+}
+
+}
+
+AsyncDetector::AsyncDetector(const AsyncParams& p, Callback on_complete)
+    : p_(p), cb_(std::move(on_complete))
+{
+    p_.max_in_flight = std::max(1, p_.max_in_flight);
+    int n = p_.workers > 0 ? p_.workers : (int)std::thread::hardware_concurrency();
+    n = std::max(1, n);
+    for (int i = 0; i < n; ++i) threads_.emplace_back(&AsyncDetector::run, this);
+}
+
+AsyncDetector::~AsyncDetector()
+{
+    drain();
+    {
+        lock_guard<mutex> lk(mtx_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    space_cv_.notify_all();
+    done_cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+uint64_t AsyncDetector::submit(const cv::Mat& frame16, ChipKind kind, const ChipParams* params, int timeout_ms)
+{
+    if (frame16.empty() || frame16.type() != CV_16UC1 || kind < 0 || kind > CHIP_AUTO) return 0;
+    if (kind == CHIP_AUTO && params) return 0;   // 同 detectChip：auto 不接受参数覆盖
+    Job job;
+    job.kind = kind;
+    job.custom_params = params != nullptr;
+    if (params) job.params = *params;
+    // 复制在锁外、占票号之前：复制失败（抛 bad_alloc）时不会留下一个永远交付不了的票号
+    job.frame = p_.copy_frames ? frame16.clone() : frame16;
+
+    unique_lock<mutex> lk(mtx_);
+    const auto has_space = [&]{ return stop_ || in_flight_ < p_.max_in_flight; };
+    if (timeout_ms < 0) space_cv_.wait(lk, has_space);
+    else if (!space_cv_.wait_for(lk, chrono::milliseconds(timeout_ms), has_space)) return 0;
+    if (stop_) return 0;
+    ++in_flight_;
+    ++unfinished_;
+    job.ticket = next_ticket_++;
+    job.submitted = Clock::now();
+    const uint64_t ticket = job.ticket;
+    queue_.push_back(std::move(job));
+    lk.unlock();
+    work_cv_.notify_one();
+    return ticket;
+}
+
+uint64_t AsyncDetector::submit(const cv::Mat& frame16, const std::string& profile, int timeout_ms)
+{
+    ChipKind kind;
+    ChipParams params;
+    bool custom = false;
+    if (!parseChipProfile(profile, kind, params, custom)) return 0;
+    return submit(frame16, kind, custom ? &params : nullptr, timeout_ms);
+}
+
+bool AsyncDetector::poll(AsyncResult& out, int timeout_ms)
+{
+    unique_lock<mutex> lk(mtx_);
+    if (cb_) return false;
+    const auto ready = [&]{ return !done_.empty() && done_.begin()->first == next_deliver_; };
+    if (timeout_ms < 0) done_cv_.wait(lk, ready);
+    else if (!done_cv_.wait_for(lk, chrono::milliseconds(timeout_ms), ready)) return false;
+    auto it = done_.begin();
+    out = std::move(it->second);
+    done_.erase(it);
+    ++next_deliver_;
+    --in_flight_;
+    lk.unlock();
+    space_cv_.notify_one();
+    return true;
+}
+
+void AsyncDetector::drain()
+{
+    unique_lock<mutex> lk(mtx_);
+    done_cv_.wait(lk, [&]{ return unfinished_ == 0 && (!cb_ || (in_flight_ == 0 && !delivering_)); });
+}
+
+int AsyncDetector::inFlight() const
+{
+    lock_guard<mutex> lk(mtx_);
+    return in_flight_;
+}
+
+void AsyncDetector::complete(AsyncResult&& r)
+{
+    unique_lock<mutex> lk(mtx_);
+    --unfinished_;
+    done_.emplace(r.ticket, std::move(r));
+    if (!cb_) {
+        lk.unlock();
+        done_cv_.notify_all();
+        return;
+    }
+    // 同一时刻只有一个线程在交付；别的线程完成的结果由它顺带按序交付
+    if (delivering_) return;
+    delivering_ = true;
+    while (!done_.empty() && done_.begin()->first == next_deliver_) {
+        auto it = done_.begin();
+        AsyncResult res = std::move(it->second);
+        done_.erase(it);
+        ++next_deliver_;
+        // 回调前先腾出在途名额：回调里再 submit 不会等自己占着的那一格
+        --in_flight_;
+        lk.unlock();
+        space_cv_.notify_one();
+        // 回调抛出的异常不能带出去：否则 delivering_ 卡住，之后的结果再也交付不了，工作线程也没了
+        try {
+            cb_(res);
+        } catch (...) {
+        }
+        lk.lock();
+    }
+    delivering_ = false;
+    lk.unlock();
+    done_cv_.notify_all();
+}
+
+void AsyncDetector::run()
+{
+    ChipWorkerContext ctx;
+    if (p_.warm_up) ctx.warmUp();
+
+    for (;;) {
+        Job job;
+        {
+            unique_lock<mutex> lk(mtx_);
+            work_cv_.wait(lk, [&]{ return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        AsyncResult r;
+        r.ticket = job.ticket;
+        const Clock::time_point t0 = Clock::now();
+        r.wait_ms = msBetween(job.submitted, t0);
+        ChipWorkerContext::Kind& c = ctx[job.kind];
+        try {
+            r.found = detectChip(job.kind, job.frame, Point(0, 0), job.custom_params ? &job.params : nullptr,
+                                 &c.opts, c.result);
+            r.chip = c.result;
+        } catch (const std::exception& e) {
+            r.chip = ChipResult{};
+            r.chip.kind = job.kind;
+            r.error = e.what();
+        } catch (...) {
+            r.chip = ChipResult{};
+            r.chip.kind = job.kind;
+            r.error = "unknown exception";
+        }
+        r.run_ms = msBetween(t0, Clock::now());
+        job.frame.release();   // 先放掉帧，采集端的缓冲可以早点回收
+        complete(std::move(r));
+    }
+}
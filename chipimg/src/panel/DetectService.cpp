@@ -0,0 +1,377 @@
+#include "DetectService.h"
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include "PanelDetect.h"
+#include "RawFrameStore.h"
+#include "ShmRing.h"
+#include "TextWriter.h"
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace cv;
+using namespace std;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+double msSince(Clock::time_point t0, Clock::time_point t1)
+{
+    return chrono::duration<double, milli>(t1 - t0).count();
+}
+
+struct WorkerState {
+    ChipWorkerContext ctx;
+    TextBuffer        tb;
+};
+
+void putJsonString(TextBuffer& tb, const string& s)
+{
+    tb.put('"');
+    for (char c : s) {
+        if (c == '"' || c == '\\') tb.put('\\').put(c);
+        else if ((unsigned char)c < 0x20) tb.put(' ');
+        else tb.put(c);
+    }
+    tb.put('"');
+}
+
+double percentile(vector<double>& v, double q)
+{
+    if (v.empty()) return 0.0;
+    const size_t k = std::min(v.size() - 1, (size_t)(q * (double)(v.size() - 1) + 0.5));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+}
+
+bool parseChipProfile(const std::string& s, ChipKind& kind, ChipParams& params, bool& custom)
+{
+    stringstream ss(s);
+    string tok;
+    if (!getline(ss, tok, ',') || !parseChipKind(tok.c_str(), kind)) return false;
+    custom = false;
+    if (kind != CHIP_AUTO) params = chipDefaultParams(kind);
+    while (getline(ss, tok, ',')) {
+        const size_t eq = tok.find('=');
+        if (eq == string::npos || kind == CHIP_AUTO) return false;   // auto 用识别出的型号的默认参数
+        char* end = nullptr;
+        const double v = strtod(tok.c_str() + eq + 1, &end);
+        if (end == tok.c_str() + eq + 1 || *end) return false;
+        if (!setChipParam(params, tok.substr(0, eq), v)) return false;
+        custom = true;
+    }
+    return true;
+}
+
+ServiceCommand parseServiceRequest(const std::string& line, ServiceJob& job, std::string& err)
+{
+    size_t b = line.find_first_not_of(" \t\r");
+    size_t e = line.find_last_not_of(" \t\r");
+    if (b == string::npos) { err = "empty request"; return SC_INVALID; }
+    const string t = line.substr(b, e - b + 1);
+    if (t == "stats") return SC_STATS;
+    if (t == "quit")  return SC_QUIT;
+
+    // <id> <profile> <source>，source 取行尾余下部分（路径可含空格）
+    const size_t s1 = t.find_first_of(" \t");
+    const size_t p0 = s1 == string::npos ? string::npos : t.find_first_not_of(" \t", s1);
+    const size_t s2 = p0 == string::npos ? string::npos : t.find_first_of(" \t", p0);
+    const size_t r0 = s2 == string::npos ? string::npos : t.find_first_not_of(" \t", s2);
+    char* end = nullptr;
+    const string id = t.substr(0, s1);
+    job.id = strtoll(id.c_str(), &end, 10);
+    if (end == id.c_str() || *end) { job.id = -1; err = "bad job id"; return SC_INVALID; }
+    if (r0 == string::npos) { err = "expected: <id> <profile> <source>"; return SC_INVALID; }
+    if (!parseChipProfile(t.substr(p0, s2 - p0), job.kind, job.params, job.custom_params)) {
+        err = "bad chip profile"; return SC_INVALID;
+    }
+    job.source = t.substr(r0);
+    return SC_JOB;
+}
+
+cv::Mat loadServiceFrame(const std::string& source, std::shared_ptr<void>& keep, std::string& err)
+{
+    keep.reset();
+    if (source.compare(0, 4, "shm:") != 0) {
+        auto rd = make_shared<RawFrameReader>();
+        Mat m = loadFrame16(source, *rd);
+        if (m.empty()) { err = "cannot read " + source; return Mat(); }
+        if (m.type() != CV_16UC1) { err = "not 16-bit single channel: " + source; return Mat(); }
+        keep = rd;   // .chrf 的 Mono16 帧直接指向映射区
+        return m;
+    }
+#if defined(_WIN32)
+    err = "shm sources are not supported on this platform";
+    return Mat();
+#else
+    // shm:<name>:<w>x<h>[:<stride>[:<offset>]]
+    vector<string> f;
+    {
+        stringstream ss(source.substr(4));
+        string tok;
+        while (getline(ss, tok, ':')) f.push_back(tok);
+    }
+    int w = 0, h = 0;
+    if (f.size() < 2 || f.size() > 4 || sscanf(f[1].c_str(), "%dx%d", &w, &h) != 2 || w <= 0 || h <= 0) {
+        err = "expected shm:<name>:<w>x<h>[:<stride>[:<offset>]]";
+        return Mat();
+    }
+    const size_t stride = f.size() > 2 ? strtoull(f[2].c_str(), nullptr, 10) : (size_t)w * 2;
+    const size_t offset = f.size() > 3 ? strtoull(f[3].c_str(), nullptr, 10) : 0;
+    if (stride < (size_t)w * 2 || stride % 2) { err = "bad stride"; return Mat(); }
+
+    const string name = f[0].empty() || f[0][0] == '/' ? f[0] : "/" + f[0];
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) { err = "cannot open shared memory " + name; return Mat(); }
+    struct stat st{};
+    const size_t need = offset + stride * (size_t)h;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < need) {
+        ::close(fd);
+        err = "shared memory object smaller than frame";
+        return Mat();
+    }
+    void* p = mmap(nullptr, need, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { err = "mmap failed"; return Mat(); }
+    keep = shared_ptr<void>(p, [need](void* q){ munmap(q, need); });
+    return Mat(h, w, CV_16UC1, static_cast<uint8_t*>(p) + offset, stride);
+#endif
+}
+
+void formatServiceStats(std::string& out, const ServiceStats& s)
+{
+    TextBuffer tb(512);
+    tb.put("{\"status\":\"stats\",\"submitted\":").putInt(s.submitted)
+      .put(",\"completed\":").putInt(s.completed).put(",\"failed\":").putInt(s.failed)
+      .put(",\"rejected\":").putInt(s.rejected).put(",\"queue_depth\":").putInt(s.queue_depth)
+      .put(",\"max_queue_depth\":").putInt(s.max_queue_depth).put(",\"busy_workers\":").putInt(s.busy_workers)
+      .put(",\"workers\":").putInt(s.workers)
+      .put(",\"latency_ms\":{\"mean\":").putFixed(s.latency_mean_ms, 3).put(",\"p50\":").putFixed(s.latency_p50_ms, 3)
+      .put(",\"p95\":").putFixed(s.latency_p95_ms, 3).put(",\"p99\":").putFixed(s.latency_p99_ms, 3)
+      .put("},\"wait_mean_ms\":").putFixed(s.wait_mean_ms, 3).put("}\n");
+    out.assign(tb.data(), tb.size());
+}
+
+void formatServiceError(std::string& out, long long id, const char* status, const std::string& msg)
+{
+    TextBuffer tb(256);
+    tb.put("{\"frame\":").putInt(id).put(",\"status\":\"").put(status).put("\",\"error\":");
+    putJsonString(tb, msg);
+    tb.put("}\n");
+    out.assign(tb.data(), tb.size());
+}
+
+DetectService::DetectService(const ServiceParams& p)
+    : p_(p)
+{
+    p_.max_queue = std::max(1, p_.max_queue);
+    p_.latency_window = std::max(1, p_.latency_window);
+    int n = p_.workers > 0 ? p_.workers : (int)std::thread::hardware_concurrency();
+    n = std::max(1, n);
+    st_.workers = n;
+    lat_ring_.assign(p_.latency_window, 0.0);
+    wait_ring_.assign(p_.latency_window, 0.0);
+    for (int i = 0; i < n; ++i) threads_.emplace_back(&DetectService::run, this);
+}
+
+DetectService::~DetectService()
+{
+    {
+        lock_guard<mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    space_cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+bool DetectService::submit(ServiceJob job)
+{
+    job.enqueued = Clock::now();   // 含因背压阻塞的时间
+    unique_lock<mutex> lk(mtx_);
+    if (stop_) return false;
+    if ((int)queue_.size() >= p_.max_queue) {
+        if (!p_.block_when_full) { ++st_.rejected; return false; }
+        space_cv_.wait(lk, [&]{ return stop_ || (int)queue_.size() < p_.max_queue; });
+        if (stop_) return false;
+    }
+    queue_.push_back(std::move(job));
+    ++st_.submitted;
+    st_.max_queue_depth = std::max(st_.max_queue_depth, (int)queue_.size());
+    lk.unlock();
+    cv_.notify_one();
+    return true;
+}
+
+void DetectService::drain()
+{
+    unique_lock<mutex> lk(mtx_);
+    idle_cv_.wait(lk, [&]{ return queue_.empty() && busy_ == 0; });
+}
+
+ServiceStats DetectService::stats() const
+{
+    vector<double> lat, wait;
+    ServiceStats s;
+    {
+        lock_guard<mutex> lk(mtx_);
+        s = st_;
+        s.queue_depth  = (int)queue_.size();
+        s.busy_workers = busy_;
+        const size_t n = std::min(lat_count_, lat_ring_.size());
+        lat.assign(lat_ring_.begin(), lat_ring_.begin() + n);
+        wait.assign(wait_ring_.begin(), wait_ring_.begin() + n);
+    }
+    if (!lat.empty()) {
+        double sum = 0, wsum = 0;
+        for (double v : lat)  sum += v;
+        for (double v : wait) wsum += v;
+        s.latency_mean_ms = sum / lat.size();
+        s.wait_mean_ms    = wsum / wait.size();
+        s.latency_p50_ms  = percentile(lat, 0.50);
+        s.latency_p95_ms  = percentile(lat, 0.95);
+        s.latency_p99_ms  = percentile(lat, 0.99);
+    }
+    return s;
+}
+
+void DetectService::finishJob(double total_ms, double wait_ms, bool ok)
+{
+    {
+        lock_guard<mutex> lk(mtx_);
+        const size_t i = lat_count_++ % lat_ring_.size();
+        lat_ring_[i]  = total_ms;
+        wait_ring_[i] = wait_ms;
+        ++st_.completed;
+        if (!ok) ++st_.failed;
+        --busy_;
+    }
+    idle_cv_.notify_all();
+}
+
+void DetectService::run()
+{
+    WorkerState w;
+    if (p_.warm_up) w.ctx.warmUp();
+
+    for (;;) {
+        ServiceJob job;
+        {
+            unique_lock<mutex> lk(mtx_);
+            cv_.wait(lk, [&]{ return stop_ || !queue_.empty(); });
+            if (queue_.empty()) return;   // stop_ 且已清空
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            ++busy_;
+        }
+        space_cv_.notify_one();
+
+        const Clock::time_point t0 = Clock::now();
+        const double wait_ms = msSince(job.enqueued, t0);
+        string line, err;
+        bool ok = false;
+        // 单个坏作业（OpenCV 异常、内存不足）只回 error，不能带倒整个服务
+        try {
+            shared_ptr<void> keep;
+            const Mat img = loadServiceFrame(job.source, keep, err);
+            if (img.empty()) {
+                formatServiceError(line, job.id, "error", err);
+            } else {
+                ChipWorkerContext::Kind& c = w.ctx[job.kind];
+                ok = detectChip(job.kind, img, Point(0, 0), job.custom_params ? &job.params : nullptr,
+                                &c.opts, c.result);
+                const double run_ms = msSince(t0, Clock::now());
+                // 在 formatChipResult 的对象末尾补字段
+                w.tb.clear();
+                formatChipResult(w.tb, TF_JSON, c.result, job.id);
+                w.tb.truncate(w.tb.size() - 2);
+                w.tb.put(",\"status\":\"").put(ok ? "ok" : "not_found").put("\",\"wait_ms\":").putFixed(wait_ms, 3)
+                    .put(",\"run_ms\":").putFixed(run_ms, 3).put("}\n");
+                line.assign(w.tb.data(), w.tb.size());
+            }
+        } catch (const std::exception& e) {
+            ok = false;
+            formatServiceError(line, job.id, "error", e.what());
+        } catch (...) {
+            ok = false;
+            formatServiceError(line, job.id, "error", "unknown exception");
+        }
+        if (job.reply) job.reply(line);
+        finishJob(msSince(job.enqueued, Clock::now()), wait_ms, ok);
+    }
+}
+
+bool runRingService(const RingServiceParams& p, const std::atomic<bool>& stop, RingServiceStats* stats)
+{
+    ShmRing frames, results;
+    const Clock::time_point t_open = Clock::now();
+    while (!frames.open(p.frame_ring) || !results.open(p.result_ring)) {
+        if (stop || msSince(t_open, Clock::now()) > p.open_wait_ms) return false;
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+
+    int n = p.workers > 0 ? p.workers : (int)std::thread::hardware_concurrency();
+    n = std::max(1, n);
+    std::atomic<long long> n_frames(0), n_failed(0), n_dropped(0), run_us(0);
+
+    const auto worker = [&]{
+        WorkerState w;
+        if (p.warm_up) w.ctx.warmUp();
+        vector<uint8_t> scratch;
+        ShmRing::Slot s;
+        while (!stop) {
+            // 定时醒来看 stop
+            if (!frames.beginRead(s, 200)) continue;
+            const Clock::time_point t0 = Clock::now();
+            const ShmFrameHeader h = *shmFrameHeader(s);
+            const ChipKind kind = h.kind >= 0 && h.kind <= CHIP_AUTO ? (ChipKind)h.kind : CHIP_AUTO;
+            ChipWorkerContext::Kind& c = w.ctx[kind];
+            bool ok = false;
+            try {
+                const Mat img = shmFrameMat(s);
+                if (img.empty()) {
+                    c.result = ChipResult{};
+                    c.result.kind = kind;
+                } else {
+                    ok = detectChip(kind, img, Point(0, 0), &c.opts, c.result);
+                }
+            } catch (...) {
+                // 坏帧按未检出回报；槽照常归还
+                ok = false;
+                c.result = ChipResult{};
+                c.result.kind = kind;
+            }
+            // 结果里没有指向帧的引用，先还槽让采集端尽早复用
+            frames.endRead(s);
+            run_us += (long long)(msSince(t0, Clock::now()) * 1000.0);
+            ++n_frames;
+            if (!ok) ++n_failed;
+            bool posted = false;
+            try {
+                posted = postShmResult(results, c.result, h.frame_id, h.timestamp_us, scratch, p.result_wait_ms);
+            } catch (...) {
+                posted = false;   // 编码时内存不足，按丢弃计
+            }
+            if (!posted) ++n_dropped;
+        }
+    };
+    vector<thread> threads;
+    for (int i = 1; i < n; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+
+    if (stats) {
+        stats->frames  = n_frames;
+        stats->failed  = n_failed;
+        stats->dropped = n_dropped;
+        stats->run_mean_ms = n_frames ? run_us / 1000.0 / n_frames : 0.0;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#include "MultiDetect.h"
+#include "ChipClassifier.h"
+#include "PanelDetect.h"
+
+using namespace cv;
+using namespace std;
+
+std::vector<ChipResult> detectMulti(FrameStages& stages, const std::vector<DetectRequest>& reqs,
+                                    int workers, const SD_Options* opts)
+{
+    vector<ChipResult> results(reqs.size());
+    const Mat& src16 = stages.frame();
+    if (src16.empty() || src16.type() != CV_16UC1) return results;
+
+    runParallel((int)reqs.size(), workers, [&](int i){
+        DetectRequest r = reqs[i];
+        auto hist = stages.histogram();
+        if (r.kind == CHIP_AUTO) {
+            ChipClass cls;
+            if (!classifyChip(stages, cls)) { results[i].kind = CHIP_AUTO; return; }
+            r = defaultRequest(cls.kind);
+            results[i].auto_kind = true;
+            results[i].kind_margin = cls.margin;
+        }
+        auto bs = stages.blobs(r.params.low_pct, r.params.high_pct, r.params.gamma_v,
+                               chipEnhanceMode(r.kind));
+
+        SD_Options o = opts ? *opts : SD_Options{};
+        o.percentile_tracker = nullptr;
+        o.deadline.state = nullptr;
+        o.scratch = nullptr;
+        o.histogram     = hist->data();
+        o.preset_low_v  = bs->low_v;
+        o.preset_high_v = bs->high_v;
+        o.blobs         = &bs->blobs;
+        o.blobs_otsu    = bs->otsu;
+
+        const bool auto_kind = results[i].auto_kind;
+        const float margin   = results[i].kind_margin;
+        detectChip(r.kind, src16, Point(0, 0), &r.params, &o, results[i]);
+        results[i].auto_kind   = auto_kind;
+        results[i].kind_margin = margin;
+        results[i].roi = Rect(0, 0, src16.cols, src16.rows);
+    });
+    return results;
+}
+
+std::vector<ChipResult> detectMulti(const cv::Mat& src16, const std::vector<DetectRequest>& reqs,
+                                    int workers, const SD_Options* opts)
+{
+    FrameStages stages(src16, nullptr, (opts && opts->stripe.enable) ? opts->stripe.band_rows : 0);
+    return detectMulti(stages, reqs, workers, opts);
+}
@@ -0,0 +1,105 @@
+#include "PanelDetect.h"
+#include "ChipClassifier.h"
+
+using namespace cv;
+using namespace std;
+
+bool detectChip(ChipKind kind, const cv::Mat& roi16, cv::Point offset,
+                const SD_Options* opts, ChipResult& out)
+{
+    return detectChip(kind, roi16, offset, nullptr, opts, out);
+}
+
+bool detectChip(ChipKind kind, const cv::Mat& roi16, cv::Point offset,
+                const ChipParams* prm, const SD_Options* opts, ChipResult& out)
+{
+    if (kind == CHIP_AUTO) {
+        // 参数覆盖是按型号调的，识别前对不上号：auto 不接受，不能悄悄丢掉
+        ChipClass cls;
+        if (prm || roi16.empty() || roi16.type() != CV_16UC1) {
+            out = ChipResult{};
+            out.kind = CHIP_AUTO;
+            return false;
+        }
+        // 识别与所选流水线共用一份阶段缓存：直方图只算一次，流水线的连通域直接交给它（同 detectMulti）
+        FrameStages stages(roi16, nullptr, (opts && opts->stripe.enable) ? opts->stripe.band_rows : 0,
+                           opts ? opts->histogram : nullptr);
+        if (!classifyChip(stages, cls)) {
+            out = ChipResult{};
+            out.kind = CHIP_AUTO;
+            return false;
+        }
+        auto hist = stages.histogram();
+        SD_Options o = opts ? *opts : SD_Options{};
+        o.histogram = hist->data();
+        std::shared_ptr<const BlobSet> bs;
+        // 跟踪百分位或调用方已给连通域时，前端仍按这些选项走
+        if (!o.blobs && !o.percentile_tracker) {
+            const ChipParams p = chipDefaultParams(cls.kind);
+            bs = stages.blobs(p.low_pct, p.high_pct, p.gamma_v, chipEnhanceMode(cls.kind));
+            o.preset_low_v  = bs->low_v;
+            o.preset_high_v = bs->high_v;
+            o.blobs         = &bs->blobs;
+            o.blobs_otsu    = bs->otsu;
+        }
+        const bool ok = detectChip(cls.kind, roi16, offset, nullptr, &o, out);
+        out.auto_kind = true;
+        out.kind_margin = cls.margin;
+        return ok;
+    }
+    const ChipParams p = prm ? *prm : chipDefaultParams(kind);
+    switch (kind) {
+#ifdef CHIP_WITH_C5
+    case CHIP_C5:  return detectChipC5(roi16, offset, p, opts, out);
+#endif
+#ifdef CHIP_WITH_4X
+    case CHIP_4X:  return detectChip4X(roi16, offset, p, opts, out);
+#endif
+#ifdef CHIP_WITH_GMY
+    case CHIP_GMY: return detectChipGMY(roi16, offset, p, opts, out);
+#endif
+#ifdef CHIP_WITH_PG
+    case CHIP_PG:  return detectChipPG(roi16, offset, p, opts, out);
+#endif
+#ifdef CHIP_WITH_STD
+    case CHIP_STD: return detectChipStd(roi16, offset, p, opts, out);
+#endif
+    default:
+        out = ChipResult{};
+        out.kind = kind;
+        return false;
+    }
+}
+
+// 预热：每个型号在空白帧上走一遍，OpenCV 的惰性初始化和各阶段的首次分配都在这里发生
+void ChipWorkerContext::warmUp()
+{
+    const Mat blank(256, 256, CV_16UC1, Scalar(0));
+    for (int k = 0; k < CHIP_KIND_COUNT; ++k)
+        detectChip((ChipKind)k, blank, Point(0, 0), &kinds[k].opts, kinds[k].result);
+}
+
+std::vector<ChipResult> detectPanel(const cv::Mat& src16, ChipKind kind,
+                                    const PanelDetectParams& p, const SD_Options* opts)
+{
+    vector<ChipResult> results;
+    if (src16.empty() || src16.type() != CV_16UC1) return results;
+
+    vector<Rect> chips;
+    segmentPanel(src16, p.segment, chips, opts ? opts->histogram : nullptr);
+    results.resize(chips.size());
+
+    SD_Options chip_opts = opts ? *opts : SD_Options{};
+    chip_opts.histogram = nullptr;
+    chip_opts.percentile_tracker = nullptr;
+    chip_opts.deadline.state = nullptr;   // 各芯片并行，跨帧状态和中间图缓冲不能共用
+    chip_opts.scratch = nullptr;
+
+    runParallel((int)chips.size(), p.workers, [&](int i){
+        ChipResult& r = results[i];
+        detectChip(kind, src16(chips[i]), chips[i].tl(), &chip_opts, r);
+        r.chip_index = i;
+        r.roi = chips[i];
+    });
+    return results;
+}
@@ -0,0 +1,110 @@
+#include "ParamSweep.h"
+#include "MultiDetect.h"
+#include "PanelDetect.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <unordered_set>
+
+using namespace cv;
+using namespace std;
+
+namespace {
+vector<double> rangeValues(const SweepRange& r)
+{
+    vector<double> v;
+    if (r.step <= 0 || r.hi <= r.lo) { v.push_back(r.lo); return v; }
+    const int n = (int)std::floor((r.hi - r.lo) / r.step + 1e-9) + 1;
+    for (int k = 0; k < n; ++k) v.push_back(r.lo + k * r.step);
+    return v;
+}
+}
+
+std::vector<SweepEntry> runSweep(const std::vector<cv::Mat>& frames, const SweepSpec& spec,
+                                 const SD_Options* opts)
+{
+    vector<SweepEntry> out;
+    if (frames.empty()) return out;
+
+    // 展开网格
+    vector<vector<double>> axes;
+    for (const auto& r : spec.ranges) axes.push_back(rangeValues(r));
+    long long total = 1;
+    for (const auto& a : axes) total *= (long long)a.size();
+
+    vector<long long> picks;
+    if (spec.random > 0 && spec.random < total) {
+        std::mt19937_64 rng(spec.seed);
+        std::uniform_int_distribution<long long> U(0, total - 1);
+        // 网格可能远大于抽样数，不展开全排列；抽中过的编号记在哈希集合里去重，抽取顺序与种子对应不变
+        unordered_set<long long> seen;
+        seen.reserve((size_t)spec.random * 2);
+        picks.reserve((size_t)spec.random);
+        while ((int)picks.size() < spec.random) {
+            const long long k = U(rng);
+            if (seen.insert(k).second) picks.push_back(k);
+        }
+    } else {
+        for (long long k = 0; k < total; ++k) picks.push_back(k);
+    }
+
+    vector<ChipParams> sets;
+    sets.reserve(picks.size());
+    for (long long k : picks) {
+        ChipParams p = spec.base;
+        for (size_t a = 0; a < axes.size(); ++a) {
+            setChipParam(p, spec.ranges[a].name, axes[a][k % axes[a].size()]);
+            k /= (long long)axes[a].size();
+        }
+        sets.push_back(p);
+    }
+    // 上游参数相同的组排在一起，同一阶段结果被连续复用，少等待
+    std::stable_sort(sets.begin(), sets.end(), [](const ChipParams& a, const ChipParams& b){
+        return std::tie(a.low_pct, a.high_pct, a.gamma_v) < std::tie(b.low_pct, b.high_pct, b.gamma_v);
+    });
+
+    // 上游参数相同的一段为一组；某帧上一组的作业全部做完就丢掉该帧这组的连通域，
+    // 缓存里只留正在跑的几组，不随扫描组数增长
+    vector<int> group(sets.size(), 0);
+    vector<int> group_first(1, 0);
+    for (size_t si = 1; si < sets.size(); ++si) {
+        const ChipParams& a = sets[si - 1];
+        const ChipParams& b = sets[si];
+        const bool same = a.low_pct == b.low_pct && a.high_pct == b.high_pct && a.gamma_v == b.gamma_v;
+        group[si] = group[si - 1] + (same ? 0 : 1);
+        if (!same) group_first.push_back((int)si);
+    }
+    group_first.push_back((int)sets.size());
+
+    const int band = (opts && opts->stripe.enable) ? opts->stripe.band_rows : 0;
+    vector<unique_ptr<FrameStages>> stages;
+    for (const auto& f : frames) stages.emplace_back(new FrameStages(f, nullptr, band));
+
+    const int NI = (int)frames.size();
+    const int NG = (int)group_first.size() - 1;
+    unique_ptr<atomic<int>[]> left(new atomic<int>[(size_t)NG * NI]);
+    for (int g = 0; g < NG; ++g)
+        for (int ii = 0; ii < NI; ++ii) left[(size_t)g * NI + ii] = group_first[g + 1] - group_first[g];
+
+    vector<ResultScore> scores(sets.size() * NI);
+    runParallel((int)scores.size(), spec.workers, [&](int t){
+        const int si = t / NI, ii = t % NI;
+        const vector<ChipResult> r = detectMulti(*stages[ii], { DetectRequest{ spec.kind, sets[si] } }, 1, opts);
+        scores[t] = scoreChipResult(r[0]);
+        if (--left[(size_t)group[si] * NI + ii] == 0)
+            stages[ii]->releaseBlobs(sets[si].low_pct, sets[si].high_pct, sets[si].gamma_v);
+    });
+
+    out.resize(sets.size());
+    for (size_t si = 0; si < sets.size(); ++si) {
+        out[si].params = sets[si];
+        out[si].score = scoreBatch(vector<ResultScore>(scores.begin() + si * NI, scores.begin() + (si + 1) * NI));
+    }
+    std::stable_sort(out.begin(), out.end(), [](const SweepEntry& a, const SweepEntry& b){
+        return a.score.score > b.score.score;
+    });
+    return out;
+}
@@ -0,0 +1,22 @@
+#include "TuneViewer.h"
+
+std::unique_ptr<TunePipeline> makeTunePipeline(ChipKind kind, FrameStages& stages, const SD_Options* opts)
+{
+    switch (kind) {
+#ifdef CHIP_WITH_C5
+    case CHIP_C5:  return makeTunePipelineC5(stages, opts);
+#endif
+#ifdef CHIP_WITH_4X
+    case CHIP_4X:  return makeTunePipeline4X(stages, opts);
+#endif
+#ifdef CHIP_WITH_GMY
+    case CHIP_GMY: return makeTunePipelineGMY(stages, opts);
+#endif
+#ifdef CHIP_WITH_PG
+    case CHIP_PG:  return makeTunePipelinePG(stages, opts);
+#endif
+    default:
+        (void)stages; (void)opts;
+        return nullptr;
+    }
+}
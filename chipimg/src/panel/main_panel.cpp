@@ -0,0 +1,88 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <vector>
+
+#include "PanelDetect.h"
+#include "OverlayRenderer.h"
+#include "RawFrameStore.h"
+#include "ResultRecord.h"
+#include "TextWriter.h"
+
+using namespace std;
+using namespace cv;
+
+// 多芯片拼板：分割芯片并按型号并行检测，每个芯片输出一段
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <16bit_panel_image> <C5|4X|GMY|PG|std|auto> [workers] [merge_gap_cells]"
+             << " [-o overlay_dir] [-s overlay_scale] [-b results.chrr] [-t text|csv|json]\n";
+        return 1;
+    }
+    ChipKind kind;
+    if (!parseChipKind(argv[2], kind)) { cerr << "❌ Unknown chip type: " << argv[2] << "\n"; return 1; }
+
+    RawFrameReader frame_reader;
+    Mat src16 = loadFrame16(argv[1], frame_reader);
+    if (src16.empty() || src16.type() != CV_16UC1) { cerr << "❌ Must be CV_16UC1: " << argv[1] << "\n"; return 2; }
+
+    OverlayParams ov;
+    string overlay_dir, record_path;
+    TextFormat text_fmt = TF_TEXT;
+    vector<string> pos;
+    for (int i = 3; i < argc; ++i) {
+        const string a = argv[i];
+        if (a == "-o" && i + 1 < argc)      overlay_dir = argv[++i];
+        else if (a == "-s" && i + 1 < argc) {
+            ov.scale = atof(argv[++i]);
+            if (!(ov.scale > 0)) { cerr << "❌ Overlay scale must be > 0: " << argv[i] << "\n"; return 1; }
+        }
+        else if (a == "-b" && i + 1 < argc) record_path = argv[++i];
+        else if (a == "-t" && i + 1 < argc) {
+            if (!parseTextFormat(argv[++i], text_fmt)) { cerr << "❌ Unknown text format: " << argv[i] << "\n"; return 1; }
+        }
+        else pos.push_back(a);
+    }
+    PanelDetectParams p;
+    if (pos.size() >= 1) p.workers = atoi(pos[0].c_str());
+    if (pos.size() >= 2) p.segment.merge_gap = atoi(pos[1].c_str());
+
+    const double t0 = (double)getTickCount();
+    vector<ChipResult> res = detectPanel(src16, kind, p);
+    const double ms = ((double)getTickCount() - t0) * 1000.0 / getTickFrequency();
+
+    // csv / json 只输出结果本身，摘要走 stderr
+    (text_fmt == TF_TEXT ? cout : cerr) << "芯片数: " << res.size() << "  用时 " << ms << " ms\n";
+    TextBuffer tb;
+    if (text_fmt == TF_CSV) putChipCsvHeader(tb);
+    for (const auto& r : res) formatChipResult(tb, text_fmt, r);
+    tb.writeTo(stdout);
+
+    // 结果记录追加到 .chrr（result2csv 可转 CSV）
+    if (!record_path.empty()) {
+        ResultRecordWriter rw;
+        if (!rw.open(record_path, true) || !rw.append(res, 0) || !rw.flush())
+            cerr << "❌ 结果记录写入失败: " << record_path << "\n";
+    }
+
+    // 叠加图在后台线程画；有芯片失败时按 QA 标记输出
+    if (!overlay_dir.empty()) {
+        ov.out_dir = overlay_dir;
+        ov.prefix  = "panel";
+        ov.sampling.first_n = 1;
+        OverlayRenderer renderer(ov);
+        OverlayScene scene;
+        bool qa = false;
+        for (const auto& r : res) {
+            fillOverlayScene(scene, r);
+            qa = qa || !r.ok;
+        }
+        scene.caption = cv::format("%d chips  %.1f ms", (int)res.size(), ms);
+        renderer.submit(0, src16, std::move(scene), qa);
+        renderer.flush();
+        cout << "叠加图: " << overlay_dir << "/panel_000000.png\n";
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include "ChipDispatch.h"
+#include "OutputInterface_std.h"
+
+// 按编译期布局（WellRow x WellCol x PointRow x PointCol）检测；std 的参数为编译期常量，prm 不参与
+bool detectChipStd(const cv::Mat& roi16, cv::Point offset, const ChipParams& prm, const SD_Options* opts, ChipResult& out)
+{
+    (void)prm;
+    out.kind = CHIP_STD;
+    out.points.clear();
+    out.slots = 0;
+    out.wells_per_row.clear();
+    out.point_rows = out.point_cols = 0;
+    out.report = SD_Report{};
+    out.ok = false;
+
+    const StdLayout L = kStdBuildLayout;
+    std::vector<_POINTPOSITIONINFO> pos(stdLayoutCount(L));
+    if (!PerformShapeDetectionROI(roi16, L, pos.data(), opts, &out.report)) return false;
+    out.slots = stdLayoutCount(L);
+    out.wells_per_row.assign(L.well_rows, L.well_cols);
+    out.point_rows = L.point_rows;
+    out.point_cols = L.point_cols;
+    for (auto& a : out.report.anchors) a += cv::Point2f(offset);
+
+    for (int wr = 0; wr < L.well_rows; ++wr)
+    for (int wc = 0; wc < L.well_cols; ++wc)
+    for (int pr = 0; pr < L.point_rows; ++pr)
+    for (int pc = 0; pc < L.point_cols; ++pc) {
+        const auto& p = pos[stdLayoutIndex(L, wr, wc, pr, pc)];
+        if (!p.valid) continue;
+        ChipPoint q;
+        q.wr = wr; q.wc = wc; q.pr = pr; q.pc = pc;
+        q.x = p.x + offset.x;
+        q.y = p.y + offset.y;
+        q.measured = p.measured;
+        out.points.push_back(q);
+    }
+    out.ok = !out.report.rejected && !out.points.empty();
+    return out.ok;
+}
@@ -1,4 +1,5 @@
 #include "OutputInterface_std.h"
+#include "StdParams.h"
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <vector>
@@ -8,17 +9,18 @@
 #include <unordered_map>
 #include <limits>
 #include <iostream>
+#include <cstdio>
 
 using namespace cv;
 using std::vector;
 
-static constexpr double kLowPct        = 0.0046;
-static constexpr double kHighPct       = 0.0087;
-static constexpr double kGamma         = 1.33;
+static constexpr double kLowPct        = kStdLowPct;
+static constexpr double kHighPct       = kStdHighPct;
+static constexpr double kGamma         = kStdGamma;
 static constexpr bool   kDoOtsu        = true;
 static constexpr double kOtsuScale     = 1.0;
 
-static constexpr int    kAreaMin       = 100;
+static constexpr int    kAreaMin       = kStdAreaMin;
 static constexpr int    kAreaMax       = 500;
 static constexpr float  kEPS_L1        = 30.f;
 static constexpr float  kEPS_L2        = 100.f;
@@ -90,19 +92,20 @@ static void findPercentile16U(const Mat& img16, double low_pct, double high_pct,
     if(low_v>=high_v){ low_v=0; high_v=65535; }
 }
 
-static Mat stretch16U(const Mat& src16, uint16_t a, uint16_t b){
-    if(a>=b) return src16.clone();
-    Mat f,dst16; src16.convertTo(f,CV_32F);
+// 结果写进 s.stretched16，浮点中间图用 s.f32（见 DetectScratch.h）
+static const Mat& stretch16U(const Mat& src16, uint16_t a, uint16_t b, DetectScratch& s){
+    if(a>=b){ src16.copyTo(s.stretched16); return s.stretched16; }
+    Mat& f=s.f32; src16.convertTo(f,CV_32F);
     f=(f-(float)a)*(65535.f/(float)(b-a));
     threshold(f,f,65535.0,65535.0,THRESH_TRUNC);
     threshold(f,f,0.0,0.0,THRESH_TOZERO);
-    f.convertTo(dst16,CV_16U);
-    return dst16;
+    f.convertTo(s.stretched16,CV_16U);
+    return s.stretched16;
 }
 
-static Mat gamma16U(const Mat& src16, float gamma){
-    Mat f; src16.convertTo(f,CV_32F,1.0/65535.0);
-    pow(f,gamma,f); Mat out; f.convertTo(out,CV_16U,65535.0); return out;
+static const Mat& gamma16U(const Mat& src16, float gamma, DetectScratch& s){
+    Mat& f=s.f32; src16.convertTo(f,CV_32F,1.0/65535.0);
+    pow(f,gamma,f); f.convertTo(s.enhanced16,CV_16U,65535.0); return s.enhanced16;
 }
 
 static vector<int> assignColsByX(const vector<Point2f>& pts){
@@ -120,26 +123,38 @@ static vector<int> assignColsByX(const vector<Point2f>& pts){
     return col;
 }
 
-static vector<int> assignRowsByY(const vector<Point2f>& pts,const vector<int>& col){
+// 孔内点阵维度：PR/PC 非 0 时为编译期常量（常用布局的快速路径），为 0 时取运行期的 pr_/pc_
+template <int PR, int PC>
+struct PointDims {
+    static constexpr int kMaxR = PR ? PR : kStdMaxPointRow;
+    static constexpr int kMaxC = PC ? PC : kStdMaxPointCol;
+    int pr_ = PR, pc_ = PC;
+    int pr() const { return PR ? PR : pr_; }
+    int pc() const { return PC ? PC : pc_; }
+};
+
+template <class D>
+static vector<int> assignRowsByY(const D& dm, const vector<Point2f>& pts,const vector<int>& col){
+    const int prows=dm.pr(), pcols=dm.pc();
     int N=(int)pts.size(); vector<int> row(N,0);
-    for(int c=0;c<PointCol;++c){
+    for(int c=0;c<pcols;++c){
         vector<int> idc; for(int i=0;i<N;++i) if(col[i]==c) idc.push_back(i);
         if(idc.empty()) continue;
         std::sort(idc.begin(),idc.end(),[&](int a,int b){ return pts[a].y<pts[b].y; });
         int cr=0; float last_y=pts[idc.front()].y; row[idc.front()]=cr;
         for(size_t k=1;k<idc.size();++k){ int i=idc[k]; float y=pts[i].y;
-            if((y-last_y)>kRowGapEps && cr+1<PointRow) cr++;
+            if((y-last_y)>kRowGapEps && cr+1<prows) cr++;
             row[i]=cr; last_y=y;
         }
-        for(int i:idc) if(row[i]>=PointRow) row[i]=PointRow-1;
+        for(int i:idc) if(row[i]>=prows) row[i]=prows-1;
     }
     return row;
 }
 
-static int pickAnchorThirdCol(const vector<Point2f>& pts,
+static int pickAnchorThirdCol(int point_cols, const vector<Point2f>& pts,
                               const vector<int>& col, const vector<int>& row)
 {
-    int target_col = PointCol - 1;
+    int target_col = point_cols - 1;
     auto better = [&](int a, int b){
         if (col[a] != col[b]) return col[a] > col[b];
         if (row[a] != row[b]) return row[a] > row[b];
@@ -170,40 +185,47 @@ static bool mean_excl(const vector<float>& v,int self,float &out){
     for(int i=0;i<(int)v.size();++i){ if(i==self) continue; if(std::isfinite(v[i])){ s+=v[i]; n++; } }
     if(!n) return false; out=(float)(s/n); return true;
 }
-static void fixAnchorsRowOnly(vector<Point2f>& anchors,
-                              const vector<Point2f>& centers_l2){
-    vector<int> id(centers_l2.size()); std::iota(id.begin(),id.end(),0);
+
+// 按 y 排序后平均切成 well_rows 段，每段按 x 排序；row_begin[r] 为第 r 行在 order 中的起点
+static vector<int> sortWellIndex(const vector<Point2f>& centers_l2, int well_rows, vector<int>& row_begin){
+    int N=(int)centers_l2.size();
+    vector<int> id(N); std::iota(id.begin(),id.end(),0);
     std::sort(id.begin(),id.end(),[&](int a,int b){
         const auto&A=centers_l2[a],&B=centers_l2[b];
         return (A.y==B.y)?(A.x<B.x):(A.y<B.y);
     });
-    int half=(int)id.size()/2;
-    vector<int> row0(id.begin(),id.begin()+half), row1(id.begin()+half,id.end());
-    auto sortx=[&](vector<int>& t){
-        std::sort(t.begin(),t.end(),[&](int a,int b){
+    well_rows=std::max(1,well_rows);
+    row_begin.assign(well_rows+1,0);
+    for(int r=0;r<=well_rows;++r) row_begin[r]=(int)((long long)N*r/well_rows);
+    for(int r=0;r<well_rows;++r){
+        std::sort(id.begin()+row_begin[r],id.begin()+row_begin[r+1],[&](int a,int b){
             const auto& A = centers_l2[a];
             const auto& B = centers_l2[b];
             return (A.x == B.x) ? (A.y < B.y) : (A.x < B.x);
         });
-    };
-    sortx(row0); sortx(row1);
-
-    auto process_row = [&](const vector<int>& row_idx){
-        if(row_idx.size()<=1) return;
-        vector<float> yvals; yvals.reserve(row_idx.size());
-        for(size_t k=0;k<row_idx.size();++k) yvals.push_back(anchors[row_idx[k]].y);
-        for(size_t k=0;k<row_idx.size();++k){
-            int aidx=row_idx[k]; float selfy=anchors[aidx].y, med=0.f;
-            if(!median_excl(yvals,(int)k,med)) continue;
+    }
+    return id;
+}
+
+static void fixAnchorsRowOnly(vector<Point2f>& anchors, const vector<int>& order,
+                              const vector<int>& row_begin){
+    auto process_row = [&](int b, int e){
+        if(e-b<=1) return;
+        vector<float> yvals; yvals.reserve(e-b);
+        for(int k=b;k<e;++k) yvals.push_back(anchors[order[k]].y);
+        for(int k=b;k<e;++k){
+            int aidx=order[k]; float selfy=anchors[aidx].y, med=0.f;
+            if(!median_excl(yvals,k-b,med)) continue;
             if(!std::isfinite(selfy)||!std::isfinite(med)) continue;
             if(std::fabs(selfy-med)<=kRowAlignYTol) continue;
-            float mean_y=0.f; if(mean_excl(yvals,(int)k,mean_y)&&std::isfinite(mean_y)) anchors[aidx].y=mean_y;
+            float mean_y=0.f; if(mean_excl(yvals,k-b,mean_y)&&std::isfinite(mean_y)) anchors[aidx].y=mean_y;
         }
     };
-    process_row(row0); process_row(row1);
+    for(int r=0;r+1<(int)row_begin.size();++r) process_row(row_begin[r], row_begin[r+1]);
 }
 
-struct Grid { Point2f p[PointRow][PointCol]; bool m[PointRow][PointCol]; };
+template <class D>
+struct Grid { Point2f p[D::kMaxR][D::kMaxC]; bool m[D::kMaxR][D::kMaxC]; };
 
 static float estimate_row_step(const vector<Point2f>& col_pts, const vector<Point2f>& all_pts){
     vector<float> d;
@@ -221,15 +243,18 @@ static float estimate_row_step(const vector<Point2f>& col_pts, const vector<Poin
     }
     float s=median1(d); if(!std::isfinite(s)||s<=0.f) s=25.f; return s;
 }
-static inline int row_from_y(float y,float y_anchor,float step){
-    float r = (float)(PointRow-1) - (y_anchor - y)/step;
+static inline int row_from_y(int point_rows,float y,float y_anchor,float step){
+    float r = (float)(point_rows-1) - (y_anchor - y)/step;
     int   ri = (int)lroundf(r);
-    return std::max(0,std::min(PointRow-1,ri));
+    return std::max(0,std::min(point_rows-1,ri));
 }
 
-static Grid fitGridAddLeft(const vector<Point2f>& pts, const Point2f& anchor){
-    Grid out{};
-    for(int r=0;r<PointRow;++r) for(int c=0;c<PointCol;++c){
+// 锚点所在的两列为实测列（最右两列），其余列按 kShift_Col1 向左外推
+template <class D>
+static Grid<D> fitGridAddLeft(const D& dm, const vector<Point2f>& pts, const Point2f& anchor){
+    const int prows=dm.pr(), pcols=dm.pc();
+    Grid<D> out{};
+    for(int r=0;r<prows;++r) for(int c=0;c<pcols;++c){
         out.p[r][c] = Point2f(std::numeric_limits<float>::quiet_NaN(),
                               std::numeric_limits<float>::quiet_NaN());
         out.m[r][c] = false;
@@ -258,109 +283,172 @@ static Grid fitGridAddLeft(const vector<Point2f>& pts, const Point2f& anchor){
 
     auto place = [&](const vector<Point2f>& v, int newC){
         for (auto &p: v){
-            int r = row_from_y(p.y, anchor.y, step);
+            int r = row_from_y(prows, p.y, anchor.y, step);
             if (!out.m[r][newC]) { out.p[r][newC] = p; out.m[r][newC] = true; }
             else{
-                float ytar = anchor.y - ((float)(PointRow-1 - r))*step;
+                float ytar = anchor.y - ((float)(prows-1 - r))*step;
                 float oldd = std::fabs(out.p[r][newC].y - ytar);
                 float newd = std::fabs(p.y - ytar);
                 if (newd < oldd) out.p[r][newC] = p;
             }
         }
     };
-    if (PointCol >= 3){
-        place(old0, 1);
-        place(old1, 2);
+    if (pcols >= 3){
+        place(old0, pcols-2);
+        place(old1, pcols-1);
     }else{
         place(old0, 0);
-        if (PointCol >= 2) place(old1, 1);
+        if (pcols >= 2) place(old1, 1);
     }
 
     float x_new2 = std::isfinite(x_old1) ? x_old1 : anchor.x;
     float x_new1 = std::isfinite(x_old0) ? x_old0 : (x_new2 - kShift_Col2);
-    float x_new0 = x_new1 - kShift_Col1;
 
     auto fill_col = [&](int c, float xc){
         if (!std::isfinite(xc)) return;
-        for (int r=0; r<PointRow; ++r){
+        for (int r=0; r<prows; ++r){
             if (!out.m[r][c]){
-                float y = anchor.y - ((float)(PointRow-1 - r))*step;
+                float y = anchor.y - ((float)(prows-1 - r))*step;
                 out.p[r][c] = Point2f(xc, y);
             }
         }
     };
-    if (PointCol >= 3){
-        fill_col(0, x_new0);
-        fill_col(1, x_new1);
-        fill_col(2, x_new2);
+    if (pcols >= 3){
+        for (int c=0; c<pcols-2; ++c) fill_col(c, x_new1 - (float)(pcols-2-c)*kShift_Col1);
+        fill_col(pcols-2, x_new1);
+        fill_col(pcols-1, x_new2);
     }else{
         fill_col(0, x_new1);
-        if (PointCol >= 2) fill_col(1, x_new2);
+        if (pcols >= 2) fill_col(1, x_new2);
     }
 
     return out;
 }
 
-static vector<int> sortWellIndex2x8(const vector<Point2f>& centers_l2){
-    int N=(int)centers_l2.size();
-    vector<int> id(N); std::iota(id.begin(),id.end(),0);
-    std::sort(id.begin(),id.end(),[&](int a,int b){
-        const auto&A=centers_l2[a],&B=centers_l2[b];
-        return (A.y==B.y)?(A.x<B.x):(A.y<B.y);
-    });
-    int half=N/2; vector<int> row0(id.begin(),id.begin()+half), row1(id.begin()+half,id.end());
-    auto sortx=[&](vector<int>& t){
-        std::sort(t.begin(),t.end(),[&](int a,int b){
-            const auto& A = centers_l2[a];
-            const auto& B = centers_l2[b];
-            return (A.x == B.x) ? (A.y < B.y) : (A.x < B.x);
-        });
-    };
-    sortx(row0); sortx(row1);
-    vector<int> order; order.reserve(N);
-    order.insert(order.end(), row0.begin(), row0.end());
-    order.insert(order.end(), row1.begin(), row1.end());
-    return order;
-}
-
+// out 为行主序 [well_rows][well_cols][point_rows][point_cols]
+template <class D>
 static void CoreDetect(
-    const Mat& src16,
-    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol])
+    const Mat& src16, const StdLayout& L, const D& dm,
+    _POINTPOSITIONINFO* out,
+    const SD_Options* opts, SD_Report* report)
 {
-    uint16_t a=0,b=0; findPercentile16U(src16, kLowPct, kHighPct, a, b);
-    Mat stretched16 = stretch16U(src16, a, b);
-    Mat enhanced16  = gamma16U(stretched16, (float)kGamma);
-    Mat view8; enhanced16.convertTo(view8, CV_8U, 1.0/256.0);
-
-    Mat bin8;
-    if(kDoOtsu){
-        double otsu_th = threshold(view8, bin8, 0, 255, THRESH_BINARY|THRESH_OTSU);
-        if(kOtsuScale!=1.0){
-            otsu_th = std::max(0.0, std::min(255.0, otsu_th*kOtsuScale));
-            threshold(view8, bin8, otsu_th, 255, THRESH_BINARY);
+    const int wrows=L.well_rows, wcols=L.well_cols;
+    const int prows=dm.pr(), pcols=dm.pc();
+    std::fill(out, out + stdLayoutCount(L), _POINTPOSITIONINFO{});
+
+    if(report) *report = SD_Report{};
+    // 中间图写进调用方给的复用缓冲，没有就用本次的临时缓冲
+    DetectScratch local_scratch;
+    DetectScratch& scratch = (opts && opts->scratch) ? *opts->scratch : local_scratch;
+    // 限时模式：std 的锚点不走晶格，只降级百分位与连通域两步
+    DeadlineClock clk(opts ? opts->deadline : DeadlineParams{});
+    DeadlineClock* dl = (opts && opts->deadline.budget_ms>0.0) ? &clk : nullptr;
+    uint16_t a = opts ? opts->preset_low_v  : 0;
+    uint16_t b = opts ? opts->preset_high_v : 0;
+    bool use_fixed = (a<b);
+    if(!use_fixed && opts && opts->percentile_tracker){
+        const PercentileEstimate pe = opts->percentile_tracker->update(src16, kLowPct, kHighPct);
+        if(report) report->percentile = pe;
+        a=pe.low_v; b=pe.high_v; use_fixed=true;
+    }
+    const bool precomputed = opts && opts->blobs;
+    const bool striped = opts && opts->stripe.enable && !precomputed;
+    const uint32_t* hist16 = opts ? opts->histogram : nullptr;
+    if(striped && !hist16){
+        scratch.hist16.assign(65536, 0u);
+        for(int r0=0; r0<src16.rows; r0+=std::max(1, opts->stripe.band_rows))
+            accumulateHistogram16U(src16, r0, opts->stripe.band_rows, scratch.hist16.data());
+        hist16 = scratch.hist16.data();
+    }
+    if(opts && opts->quality_gate){
+        uint16_t qa=0, qb=65535;
+        FrameQualityStats qs;
+        findPercentile16UWithQuality(src16, hist16, kLowPct, kHighPct, kGamma, opts->quality, qa, qb, qs);
+        if(!use_fixed){ a=qa; b=qb; }
+        if(report){ report->quality = qs; report->rejected = qs.rejected; }
+        if(qs.rejected){ if(dl) dl->finish(report); return; }
+    }else if(!use_fixed && hist16){
+        percentileFromHistogram16U(hist16, 1LL*src16.rows*src16.cols, kLowPct, kHighPct, a, b);
+    }else if(!use_fixed){
+        DeadlineStep step(dl, DL_PERCENTILE, DG_SAMPLED_PERCENTILE);
+        if(step.cheap()){
+            const PercentileEstimate pe = estimatePercentile16USampled(src16, kLowPct, kHighPct, opts->deadline.sample_stride);
+            if(report) report->percentile = pe;
+            a=pe.low_v; b=pe.high_v;
+        }else{
+            findPercentile16U(src16, kLowPct, kHighPct, a, b);
         }
-    }else{
-        threshold(view8, bin8, 128, 255, THRESH_BINARY);
     }
-
-    Mat labels, stats, centroids;
-    int nLabels = connectedComponentsWithStats(bin8, labels, stats, centroids, 8, CV_32S);
+    if(report){ report->low_v=a; report->high_v=b; if(precomputed) report->otsu_th=opts->blobs_otsu; }
     struct Region { Point2f c; int area; };
-    vector<Region> regions; regions.reserve(std::max(0, nLabels-1));
-    for(int lbl=1; lbl<nLabels; ++lbl){
-        int area = stats.at<int>(lbl, CC_STAT_AREA);
-        if(area<kAreaMin || area>kAreaMax) continue;
-        float cx=(float)centroids.at<double>(lbl,0);
-        float cy=(float)centroids.at<double>(lbl,1);
-        regions.push_back({Point2f(cx,cy), area});
+    vector<Region> regions;
+    if(precomputed){
+        regions.reserve(opts->blobs->size());
+        for(const BlobStat& bs : *opts->blobs){
+            if(bs.area<kAreaMin || bs.area>kAreaMax) continue;
+            regions.push_back({bs.centroid, bs.area});
+        }
+    }else if(striped){
+        // 分带：逐像素链折成查找表，连通域逐带求再跨缝合并
+        vector<uint8_t>& lut=scratch.lut; buildEnhanceLut8(a, b, (float)kGamma, lut);
+        vector<BlobStat> blobs;
+        stripedBlobs16U(src16, lut, hist16, kDoOtsu ? -1.0 : 128.0, kOtsuScale, opts->stripe.band_rows, blobs, nullptr, &scratch);
+        regions.reserve(blobs.size());
+        for(const BlobStat& bs : blobs){
+            if(bs.area<kAreaMin || bs.area>kAreaMax) continue;
+            regions.push_back({bs.centroid, bs.area});
+        }
+    }else{
+        const Rect roi = dl ? dl->reusableRoi(src16.size()) : Rect();
+        DeadlineStep step(dl, DL_LABEL, DG_ROI_LABELLING, roi.area()>0);
+        const Rect work = step.cheap() ? roi : Rect(0, 0, src16.cols, src16.rows);
+        DebugSink* dbg = opts ? opts->debug : nullptr;
+        Mat stretched16 = stretch16U(src16(work), a, b, scratch);
+        Mat enhanced16  = gamma16U(stretched16, (float)kGamma, scratch);
+        CHIP_DEBUG_PUBLISH(dbg, "stretch16", stretched16);
+        CHIP_DEBUG_PUBLISH(dbg, "gamma16", enhanced16);
+        Mat& view8 = scratch.view8; enhanced16.convertTo(view8, CV_8U, 1.0/256.0);
+        CHIP_DEBUG_PUBLISH(dbg, "view8", view8);
+
+        Mat& bin8 = scratch.bin8;
+        if(kDoOtsu){
+            double otsu_th = threshold(view8, bin8, 0, 255, THRESH_BINARY|THRESH_OTSU);
+            if(kOtsuScale!=1.0){
+                otsu_th = std::max(0.0, std::min(255.0, otsu_th*kOtsuScale));
+                threshold(view8, bin8, otsu_th, 255, THRESH_BINARY);
+            }
+            if(report) report->otsu_th=otsu_th;
+        }else{
+            threshold(view8, bin8, 128, 255, THRESH_BINARY);
+        }
+        CHIP_DEBUG_PUBLISH(dbg, "bin8", bin8);
+
+        Mat& labels = scratch.labels;
+        Mat& stats = scratch.stats;
+        Mat& centroids = scratch.centroids;
+        int nLabels = connectedComponentsWithStats(bin8, labels, stats, centroids, 8, CV_32S);
+        regions.reserve(std::max(0, nLabels-1));
+        for(int lbl=1; lbl<nLabels; ++lbl){
+            int area = stats.at<int>(lbl, CC_STAT_AREA);
+            if(area<kAreaMin || area>kAreaMax) continue;
+            float cx=(float)centroids.at<double>(lbl,0) + work.x;
+            float cy=(float)centroids.at<double>(lbl,1) + work.y;
+            regions.push_back({Point2f(cx,cy), area});
+        }
     }
 
     vector<Point2f> centers_l1_in; centers_l1_in.reserve(regions.size());
     for(auto&r:regions) centers_l1_in.push_back(r.c);
+    if(dl && !centers_l1_in.empty()){
+        const int m = opts->deadline.roi_margin;
+        const Rect bb = boundingRect(centers_l1_in);
+        dl->setRoi(Rect(bb.x-m, bb.y-m, bb.width+2*m, bb.height+2*m) & Rect(0, 0, src16.cols, src16.rows));
+    }
     auto l1_groups      = clusterByEpsGroups(centers_l1_in, kEPS_L1);
     auto centers_l1_out = groupsToCenters(centers_l1_in, l1_groups);
     auto l2_groups      = clusterByEpsGroups(centers_l1_out, kEPS_L2);
     auto centers_l2     = groupsToCenters(centers_l1_out, l2_groups);
+    if(report){ report->spots=(int)regions.size(); report->clusters=(int)l2_groups.size(); }
 
     vector<Point2f> anchors; anchors.reserve(l2_groups.size());
     vector<vector<Point2f>> l2_pts(l2_groups.size());
@@ -373,56 +461,175 @@ static void CoreDetect(
         }
         if(pts.empty()){ anchors.push_back(Point2f(NAN,NAN)); l2_pts[gi]=std::move(pts); continue; }
         auto col = assignColsByX(pts);
-        auto row = assignRowsByY(pts, col);
-        int aidx = pickAnchorThirdCol(pts, col, row);
+        auto row = assignRowsByY(dm, pts, col);
+        int aidx = pickAnchorThirdCol(pcols, pts, col, row);
         anchors.push_back(pts[aidx]);
         l2_pts[gi] = std::move(pts);
     }
-    fixAnchorsRowOnly(anchors, centers_l2);
-
-    vector<int> order = sortWellIndex2x8(centers_l2);
+    vector<int> row_begin;
+    vector<int> order = sortWellIndex(centers_l2, wrows, row_begin);
+    auto well_row_of = [&](int k){
+        int r=0; while(r+1<wrows && k>=row_begin[r+1]) ++r; return r;
+    };
 
-    for(int wr=0; wr<WellRow; ++wr)
-        for(int wc=0; wc<WellCol; ++wc)
-            for(int pr=0; pr<PointRow; ++pr)
-                for(int pc=0; pc<PointCol; ++pc)
-                    PostionArray[wr][wc][pr][pc] = _POINTPOSITIONINFO{};
+    bool lattice_ok=false;
+    if(opts && opts->lattice.enable){
+        vector<LatticeSample> samples; vector<int> sgi;
+        for(int k=0;k<(int)order.size();++k){
+            int gi=order[k];
+            if(!std::isfinite(anchors[gi].x)||!std::isfinite(anchors[gi].y)) continue;
+            int r=well_row_of(k);
+            samples.push_back(LatticeSample{r, k-row_begin[r], anchors[gi]});
+            sgi.push_back(gi);
+        }
+        LatticeModel lm; vector<char> inl;
+        lattice_ok=fitLatticeModel(samples, opts->lattice, lm, &inl);
+        int n=0;
+        if(lattice_ok){
+            for(int k=0;k<(int)order.size();++k){
+                int gi=order[k], r=well_row_of(k);
+                auto it=std::find(sgi.begin(),sgi.end(),gi);
+                if(it!=sgi.end() && (inl[it-sgi.begin()] || !opts->lattice.snap_outliers)) continue;
+                anchors[gi]=lm.predict(r, k-row_begin[r]); n++;
+            }
+        }
+        if(report){ report->lattice=lm; report->lattice_replaced=n; }
+    }
+    if(!lattice_ok) fixAnchorsRowOnly(anchors, order, row_begin);
 
-    int wells = std::min((int)order.size(), WellRow*WellCol);
+    int wells = std::min((int)order.size(), wrows*wcols);
     for(int k=0; k<wells; ++k){
-        int wr = (k < WellCol)? 0 : 1;
-        int wc = (k < WellCol)? k : (k-WellCol);
+        int wr = k / wcols;
+        int wc = k % wcols;
         int gi = order[k];
 
         const Point2f& anchor = anchors[gi];
+        if(report) report->anchors.push_back(anchor);
         if(!std::isfinite(anchor.x) || !std::isfinite(anchor.y)) continue;
 
-        auto grid = fitGridAddLeft(l2_pts[gi], anchor);
-        for(int pr=0; pr<PointRow; ++pr){
-            for(int pc=0; pc<PointCol; ++pc){
+        auto grid = fitGridAddLeft(dm, l2_pts[gi], anchor);
+        if(opts && opts->redetect.enable){
+            int missing=0;
+            float x0=1e30f,y0=1e30f,x1=-1e30f,y1=-1e30f;
+            for(int pr=0; pr<prows; ++pr) for(int pc=0; pc<pcols; ++pc){
+                const Point2f& q=grid.p[pr][pc];
+                if(!grid.m[pr][pc]) missing++;
+                if(!std::isfinite(q.x)||!std::isfinite(q.y)) continue;
+                x0=std::min(x0,q.x); y0=std::min(y0,q.y); x1=std::max(x1,q.x); y1=std::max(y1,q.y);
+            }
+            if(missing && x0<=x1){
+                const float mg=kRowGapEps*0.5f;
+                Rect win=anchorWindowRect(Point2f(x1,y1), (y1-y0)+mg, mg, (x1-x0)+mg, mg, src16.size());
+                LocalRedetectParams rp=opts->redetect;
+                if(rp.area_max<=0) rp.area_max=kAreaMax;
+                auto extra=redetectSpotsInWindow(src16, win, rp, l2_pts[gi]);
+                const float tol2=(kRowGapEps*0.4f)*(kRowGapEps*0.4f);
+                vector<char> used(extra.size(),0);
+                int n=0;
+                for(int pr=0; pr<prows; ++pr) for(int pc=0; pc<pcols; ++pc){
+                    if(grid.m[pr][pc]) continue;
+                    const Point2f& g=grid.p[pr][pc];
+                    if(!std::isfinite(g.x)||!std::isfinite(g.y)) continue;
+                    int best=-1; float bd=tol2;
+                    for(int k=0;k<(int)extra.size();++k){
+                        if(used[k]) continue;
+                        Point2f d=extra[k]-g; float d2=d.x*d.x+d.y*d.y;
+                        if(d2<=bd){ bd=d2; best=k; }
+                    }
+                    if(best<0) continue;
+                    used[best]=1; grid.p[pr][pc]=extra[best]; grid.m[pr][pc]=true; n++;
+                }
+                if(report){ report->redetect_wells++; report->redetect_recovered+=n; }
+            }
+        }
+        for(int pr=0; pr<prows; ++pr){
+            for(int pc=0; pc<pcols; ++pc){
                 _POINTPOSITIONINFO info;
                 info.x = grid.p[pr][pc].x;
                 info.y = grid.p[pr][pc].y;
                 info.measured = grid.m[pr][pc];
                 info.valid = std::isfinite(info.x) && std::isfinite(info.y);
-                PostionArray[wr][wc][pr][pc] = info;
+                out[stdLayoutIndex(L, wr, wc, pr, pc)] = info;
             }
         }
     }
+    if(dl) dl->finish(report);
+}
+
+bool stdLayoutSupported(const StdLayout& L){
+    return L.well_rows>0 && L.well_cols>0 &&
+           L.point_rows>0 && L.point_rows<=kStdMaxPointRow &&
+           L.point_cols>0 && L.point_cols<=kStdMaxPointCol;
+}
+
+bool parseStdLayout(const char* s, StdLayout& L){
+    if(!s) return false;
+    StdLayout t = L;
+    int n = std::sscanf(s, "%dx%dx%dx%d@%dx%d", &t.well_rows, &t.well_cols,
+                        &t.point_rows, &t.point_cols, &t.img_w, &t.img_h);
+    if(n!=4 && n!=6) return false;
+    if(!stdLayoutSupported(t)) return false;
+    L = t;
+    return true;
+}
+
+static bool CoreDetectLayout(const Mat& src16, const StdLayout& L, _POINTPOSITIONINFO* out,
+                             const SD_Options* opts, SD_Report* report){
+    if(!out || !stdLayoutSupported(L)) return false;
+    if(L.point_rows==6 && L.point_cols==3)      CoreDetect(src16, L, PointDims<6,3>{}, out, opts, report);
+    else if(L.point_rows==6 && L.point_cols==2) CoreDetect(src16, L, PointDims<6,2>{}, out, opts, report);
+    else{
+        PointDims<0,0> dm; dm.pr_=L.point_rows; dm.pc_=L.point_cols;
+        CoreDetect(src16, L, dm, out, opts, report);
+    }
+    return true;
 }
 
 void PerformShapeDetection(
     ushort usImage[],
-    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol])
+    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol],
+    const SD_Options* opts, SD_Report* report)
 {
     Mat src16(STD_IMG_H, STD_IMG_W, CV_16UC1, (void*)usImage);
-    CoreDetect(src16, PostionArray);
+    CoreDetect(src16, kStdBuildLayout, PointDims<PointRow,PointCol>{}, &PostionArray[0][0][0][0], opts, report);
 }
 
 void PerformShapeDetectionDyn(
     const ushort* usImage, int width, int height,
-    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol])
+    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol],
+    const SD_Options* opts, SD_Report* report)
 {
     Mat src16(height, width, CV_16UC1, const_cast<ushort*>(usImage));
-    CoreDetect(src16, PostionArray);
+    CoreDetect(src16, kStdBuildLayout, PointDims<PointRow,PointCol>{}, &PostionArray[0][0][0][0], opts, report);
+}
+
+bool PerformShapeDetectionLayout(
+    const ushort* usImage, const StdLayout& L,
+    _POINTPOSITIONINFO* PostionArray,
+    const SD_Options* opts, SD_Report* report)
+{
+    if(!usImage || L.img_w<=0 || L.img_h<=0) return false;
+    Mat src16(L.img_h, L.img_w, CV_16UC1, const_cast<ushort*>(usImage));
+    return CoreDetectLayout(src16, L, PostionArray, opts, report);
+}
+
+bool PerformShapeDetectionROI(
+    const cv::Mat& src16, const StdLayout& L,
+    _POINTPOSITIONINFO* PostionArray,
+    const SD_Options* opts, SD_Report* report)
+{
+    if(src16.empty() || src16.type()!=CV_16UC1) return false;
+    return CoreDetectLayout(src16, L, PostionArray, opts, report);
+}
+
+bool PerformShapeDetectionRaw(
+    const RawFrameView& frame, const StdLayout& L,
+    _POINTPOSITIONINFO* PostionArray,
+    const SD_Options* opts, SD_Report* report)
+{
+    thread_local RawFrameBuffer buf;
+    if(!buf.unpack(frame)) return false;
+    SD_Options o = opts ? *opts : SD_Options{};
+    o.histogram = buf.hist.data();
+    return CoreDetectLayout(buf.frame16, L, PostionArray, &o, report);
 }
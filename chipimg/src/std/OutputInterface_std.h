@@ -1,5 +1,6 @@
 #pragma once
 #include <limits>
+#include "DetectOptions.h"
 
 #ifndef WellRow
 #define WellRow 2
@@ -34,10 +35,63 @@ struct _POINTPOSITIONINFO {
     bool  valid    = false;
 };
 
+// 运行期布局：孔行 x 孔列 x 点行 x 点列，以及原始缓冲区尺寸。
+// 6x3 / 6x2 点阵走编译期特化的快速路径，其余点阵维度不超过 kStdMaxPointRow x kStdMaxPointCol 时走通用路径
+static constexpr int kStdMaxPointRow = 16;
+static constexpr int kStdMaxPointCol = 8;
+
+struct StdLayout {
+    int well_rows  = WellRow;
+    int well_cols  = WellCol;
+    int point_rows = PointRow;
+    int point_cols = PointCol;
+    int img_w      = STD_IMG_W;
+    int img_h      = STD_IMG_H;
+};
+
+static constexpr StdLayout kStdBuildLayout{};
+
+inline int stdLayoutCount(const StdLayout& L) {
+    return L.well_rows * L.well_cols * L.point_rows * L.point_cols;
+}
+inline int stdLayoutIndex(const StdLayout& L, int wr, int wc, int pr, int pc) {
+    return ((wr * L.well_cols + wc) * L.point_rows + pr) * L.point_cols + pc;
+}
+
+bool stdLayoutSupported(const StdLayout& L);
+
+// "2x8x6x3" 或 "2x8x6x2@2048x1536"；失败时 L 不变
+bool parseStdLayout(const char* s, StdLayout& L);
+
 void PerformShapeDetection(
     ushort usImage[],
-    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol]);
+    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol],
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr);
 
 void PerformShapeDetectionDyn(
     const ushort* usImage, int width, int height,
-    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol]);
+    _POINTPOSITIONINFO (&PostionArray)[WellRow][WellCol][PointRow][PointCol],
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr);
+
+// PostionArray 至少 stdLayoutCount(L) 个元素，按 stdLayoutIndex 排列；布局不受支持时返回 false
+bool PerformShapeDetectionLayout(
+    const ushort* usImage, const StdLayout& L,
+    _POINTPOSITIONINFO* PostionArray,
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr);
+
+// src16 可以是大图上的 ROI 视图（行距任意），L.img_w/img_h 不参与，坐标相对 src16
+bool PerformShapeDetectionROI(
+    const cv::Mat& src16, const StdLayout& L,
+    _POINTPOSITIONINFO* PostionArray,
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr);
+
+// 直接吃相机原始帧（Mono12Packed / Mono10 等）：解包与百分位直方图在同一遍完成，L.img_w/img_h 不参与
+bool PerformShapeDetectionRaw(
+    const RawFrameView& frame, const StdLayout& L,
+    _POINTPOSITIONINFO* PostionArray,
+    const SD_Options* opts = nullptr,
+    SD_Report* report = nullptr);
@@ -1,23 +1,26 @@
 #include "OutputInterface_std.h"
+#include "RawFrameStore.h"
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <cstdlib>
+#include <vector>
 
 using namespace std;
 using namespace cv;
 
 static void draw_points(
-    Mat& img,
-    _POINTPOSITIONINFO (&pos)[WellRow][WellCol][PointRow][PointCol])
+    Mat& img, const StdLayout& L,
+    const vector<_POINTPOSITIONINFO>& pos)
 {
-    for (int wr = 0; wr < WellRow; ++wr)
-    for (int wc = 0; wc < WellCol; ++wc)
-    for (int pr = 0; pr < PointRow; ++pr)
-    for (int pc = 0; pc < PointCol; ++pc) {
-        const auto& p = pos[wr][wc][pr][pc];
+    for (int wr = 0; wr < L.well_rows; ++wr)
+    for (int wc = 0; wc < L.well_cols; ++wc)
+    for (int pr = 0; pr < L.point_rows; ++pr)
+    for (int pc = 0; pc < L.point_cols; ++pc) {
+        const auto& p = pos[stdLayoutIndex(L, wr, wc, pr, pc)];
         if (!p.valid || !isfinite(p.x) || !isfinite(p.y)) continue;
         Point2f pt(p.x, p.y);
         Scalar color = p.measured ? Scalar(0,255,0) : Scalar(0,0,255); // M=绿, F=红
@@ -32,27 +35,42 @@ static void draw_points(
 int main(int argc, char** argv)
 {
     if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <16bit_gray_image>\n";
+        cerr << "Usage: " << argv[0] << " <16bit_gray_image> [layout WRxWCxPRxPC, e.g. 2x8x6x2] [stripe_rows]\n";
         cerr << "Note : image must be CV_16UC1 (16-bit single-channel).\n";
         return 1;
     }
 
     string path = argv[1];
-    Mat src16 = imread(path, IMREAD_UNCHANGED);
+    RawFrameReader frame_reader;   // .chrf 容器时帧数据直接映射，需存活到处理结束
+    Mat src16 = loadFrame16(path, frame_reader);
     if (src16.empty()) { cerr << "❌ Cannot read image: " << path << "\n"; return 2; }
     if (src16.type() != CV_16UC1) { cerr << "❌ Must be CV_16UC1.\n"; return 3; }
 
     cout << "✅ Image loaded: " << path << "  size=" << src16.cols << "x" << src16.rows << "\n";
 
-    _POINTPOSITIONINFO pos[WellRow][WellCol][PointRow][PointCol];
-    PerformShapeDetectionDyn(src16.ptr<ushort>(), src16.cols, src16.rows, pos);
+    StdLayout L;
+    if (argc >= 3 && !parseStdLayout(argv[2], L)) {
+        cerr << "❌ Bad layout: " << argv[2] << "\n"; return 4;
+    }
+    L.img_w = src16.cols;
+    L.img_h = src16.rows;
+
+    // 第三个参数：分带低内存模式的带高（行）
+    SD_Options opts;
+    if (argc >= 4) {
+        opts.stripe.band_rows = atoi(argv[3]);
+        opts.stripe.enable = opts.stripe.band_rows > 0;
+    }
+
+    vector<_POINTPOSITIONINFO> pos(stdLayoutCount(L));
+    PerformShapeDetectionLayout(src16.ptr<ushort>(), L, pos.data(), &opts);
 
-    for (int wr = 0; wr < WellRow; ++wr) {
-        for (int wc = 0; wc < WellCol; ++wc) {
+    for (int wr = 0; wr < L.well_rows; ++wr) {
+        for (int wc = 0; wc < L.well_cols; ++wc) {
             cout << "Well(" << wr << "," << wc << "):\n";
-            for (int r = 0; r < PointRow; ++r) {
-                for (int c = 0; c < PointCol; ++c) {
-                    const auto& p = pos[wr][wc][r][c];
+            for (int r = 0; r < L.point_rows; ++r) {
+                for (int c = 0; c < L.point_cols; ++c) {
+                    const auto& p = pos[stdLayoutIndex(L, wr, wc, r, c)];
                     if (!p.valid) continue;
                     cout << "  P(" << r << "," << c << "): ("
                          << p.x << ", " << p.y << ") "
@@ -66,11 +84,11 @@ int main(int argc, char** argv)
     normalize(src16, disp8, 0, 255, NORM_MINMAX);
     disp8.convertTo(disp8, CV_8U);
     cvtColor(disp8, disp8, COLOR_GRAY2BGR);
-    draw_points(disp8, pos);
+    draw_points(disp8, L, pos);
 
     namedWindow("原图 + 检测点 (ESC退出)", WINDOW_AUTOSIZE);
     imshow("原图 + 检测点 (ESC退出)", disp8);
-    cout << "PointRow=" << PointRow << " PointCol=" << PointCol << endl;
+    cout << "PointRow=" << L.point_rows << " PointCol=" << L.point_cols << endl;
 
     waitKey(0);
     destroyAllWindows();
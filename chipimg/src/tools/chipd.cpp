@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "DetectService.h"
+
+using namespace std;
+
+// 常驻检测服务：从 stdin 或本地 Unix socket 逐行收作业，应答逐行 JSON（协议见 DetectService.h）；
+// 或从共享内存帧环取帧、结果写回结果环
+static int usage(const char* argv0)
+{
+    cerr << "Usage: " << argv0 << " [-j N] [-q N] [-s socket_path | -r frame_ring -R result_ring] [--no-warmup]\n"
+         << "  -j  worker threads (default: all cores)\n"
+         << "  -q  max queued jobs (default 64); stdin blocks when full, socket replies busy\n"
+         << "  -s  listen on a Unix domain socket instead of stdin/stdout\n"
+         << "  -r/-R  shared-memory frame / result rings created by the acquisition side (see shm_producer);\n"
+         << "         runs until SIGINT/SIGTERM\n"
+         << "  requests: <id> <profile> <source> | stats | quit\n";
+    return 1;
+}
+
+// 一行命令的处理；返回 false 表示收到 quit
+static bool handleLine(DetectService& svc, const string& line,
+                       const function<void(const string&)>& reply)
+{
+    ServiceJob job;
+    string err, out;
+    switch (parseServiceRequest(line, job, err)) {
+    case SC_QUIT:
+        return false;
+    case SC_STATS:
+        formatServiceStats(out, svc.stats());
+        reply(out);
+        return true;
+    case SC_INVALID:
+        formatServiceError(out, job.id, "invalid", err);
+        reply(out);
+        return true;
+    case SC_JOB:
+        break;
+    }
+    const long long id = job.id;
+    job.reply = reply;
+    if (!svc.submit(std::move(job))) {
+        formatServiceError(out, id, "busy", "queue full");
+        reply(out);
+    }
+    return true;
+}
+
+static int serveStdin(DetectService& svc)
+{
+    auto mtx = make_shared<mutex>();
+    const auto reply = [mtx](const string& s) {
+        lock_guard<mutex> lk(*mtx);
+        fwrite(s.data(), 1, s.size(), stdout);
+        fflush(stdout);
+    };
+    string line;
+    while (getline(cin, line))
+        if (!handleLine(svc, line, reply)) break;
+    svc.drain();
+    return 0;
+}
+
+static std::atomic<bool> g_stop(false);
+
+static void onSignal(int) { g_stop = true; }
+
+static int serveRing(const RingServiceParams& rp)
+{
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    RingServiceStats st;
+    if (!runRingService(rp, g_stop, &st)) {
+        cerr << "无法打开共享内存环: " << rp.frame_ring << " / " << rp.result_ring << "\n";
+        return 2;
+    }
+    cerr << "frames=" << st.frames << " failed=" << st.failed << " dropped_results=" << st.dropped
+         << " run_mean_ms=" << st.run_mean_ms << "\n";
+    return 0;
+}
+
+#if !defined(_WIN32)
+struct Conn {
+    int   fd = -1;
+    mutex mtx;
+    ~Conn() { if (fd >= 0) ::close(fd); }
+    void send(const string& s)
+    {
+        lock_guard<mutex> lk(mtx);
+        size_t off = 0;
+        while (off < s.size()) {
+            const ssize_t n = ::send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+            if (n <= 0) return;   // 对端已断开，丢弃应答
+            off += (size_t)n;
+        }
+    }
+};
+
+static int serveSocket(DetectService& svc, const string& path)
+{
+    const int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (lfd < 0 || path.size() >= sizeof(addr.sun_path)) { cerr << "socket 创建失败: " << path << "\n"; return 2; }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(lfd, 16) != 0) {
+        cerr << "无法监听: " << path << "\n";
+        ::close(lfd);
+        return 2;
+    }
+    cerr << "listening on " << path << "\n";
+
+    // 连接断开后读线程把自己从 conns 里摘掉（fd 随最后一个引用关闭），退出时等所有读线程结束
+    mutex conns_mtx;
+    condition_variable readers_cv;
+    vector<shared_ptr<Conn>> conns;
+    int readers = 0;
+    bool quitting = false;
+
+    for (;;) {
+        const int fd = accept(lfd, nullptr, nullptr);
+        if (fd < 0) {
+            const int e = errno;
+            {
+                lock_guard<mutex> lk(conns_mtx);
+                if (quitting) break;   // quit 时 shutdown(lfd) 使 accept 返回
+            }
+            if (e == EINTR || e == ECONNABORTED) continue;
+            // EMFILE / ENFILE 等：等已有连接释放再接，服务不退出
+            this_thread::sleep_for(chrono::milliseconds(100));
+            continue;
+        }
+        auto c = make_shared<Conn>();
+        c->fd = fd;
+        {
+            lock_guard<mutex> lk(conns_mtx);
+            if (quitting) break;
+            conns.push_back(c);
+            ++readers;
+        }
+        thread([&, c]{
+            const auto reply = [c](const string& s){ c->send(s); };
+            string buf, line;
+            char chunk[4096];
+            bool quit = false;
+            for (;;) {
+                const ssize_t n = recv(c->fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) break;
+                buf.append(chunk, (size_t)n);
+                size_t nl;
+                while (!quit && (nl = buf.find('\n')) != string::npos) {
+                    line.assign(buf, 0, nl);
+                    buf.erase(0, nl + 1);
+                    quit = !handleLine(svc, line, reply);
+                }
+                if (quit) break;
+            }
+            lock_guard<mutex> lk(conns_mtx);
+            if (quit && !quitting) {
+                quitting = true;
+                shutdown(lfd, SHUT_RDWR);
+                for (auto& o : conns) if (o != c) shutdown(o->fd, SHUT_RD);
+            }
+            conns.erase(std::remove(conns.begin(), conns.end(), c), conns.end());
+            --readers;
+            readers_cv.notify_all();   // 持锁通知：主线程醒来时本线程已不再碰它的栈
+        }).detach();
+    }
+
+    // 已收下的作业都做完并回复后再退出
+    {
+        unique_lock<mutex> lk(conns_mtx);
+        for (auto& o : conns) shutdown(o->fd, SHUT_RD);
+        readers_cv.wait(lk, [&]{ return readers == 0; });
+    }
+    svc.drain();
+    ::close(lfd);
+    unlink(path.c_str());
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    ServiceParams sp;
+    RingServiceParams rp;
+    string sock;
+    for (int i = 1; i < argc; ++i) {
+        const string a = argv[i];
+        if (a == "-j" && i + 1 < argc)      sp.workers = atoi(argv[++i]);
+        else if (a == "-q" && i + 1 < argc) sp.max_queue = atoi(argv[++i]);
+        else if (a == "-s" && i + 1 < argc) sock = argv[++i];
+        else if (a == "-r" && i + 1 < argc) rp.frame_ring = argv[++i];
+        else if (a == "-R" && i + 1 < argc) rp.result_ring = argv[++i];
+        else if (a == "--no-warmup")        sp.warm_up = false;
+        else return usage(argv[0]);
+    }
+
+    if (!rp.frame_ring.empty() || !rp.result_ring.empty()) {
+        if (rp.frame_ring.empty() || rp.result_ring.empty() || !sock.empty()) return usage(argv[0]);
+        rp.workers = sp.workers;
+        rp.warm_up = sp.warm_up;
+        return serveRing(rp);
+    }
+
+    if (sock.empty()) {
+        sp.block_when_full = true;   // 管道输入：满了就不再读，由管道把压力传回上游
+        DetectService svc(sp);
+        return serveStdin(svc);
+    }
+#if defined(_WIN32)
+    cerr << "Unix domain sockets are not supported on this platform\n";
+    return 1;
+#else
+    DetectService svc(sp);
+    return serveSocket(svc, sock);
+#endif
+}
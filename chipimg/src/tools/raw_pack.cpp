@@ -0,0 +1,68 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+#include "RawFrameStore.h"
+#include "FramePrefetch.h"
+
+using namespace std;
+using namespace cv;
+
+// 把 16 位 PNG 打包成 .chrf（未压缩，批量重跑时省掉 zlib 解压），或列出已有容器的帧
+static int usage(const char* argv0)
+{
+    cerr << "Usage: " << argv0 << " [-a] [-j N] <out.chrf> <in1.png> [in2.png ...]\n"
+         << "       " << argv0 << " -l <file.chrf>\n"
+         << "  -a  append to an existing container\n"
+         << "  -j  decode workers (default 2)\n"
+         << "  -l  list frames\n";
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) return usage(argv[0]);
+
+    if (strcmp(argv[1], "-l") == 0) {
+        RawFrameReader rd;
+        if (!rd.open(argv[2])) { cerr << "打开失败: " << argv[2] << "\n"; return 2; }
+        for (int i = 0; i < rd.size(); ++i) {
+            const auto& e = rd.entry(i);
+            cout << i << "\t" << e.view.width << "x" << e.view.height
+                 << "\tfmt=" << e.view.format << "\tstride=" << e.view.stride
+                 << "\t" << e.meta << "\n";
+        }
+        return 0;
+    }
+
+    int ai = 1;
+    bool append = false;
+    PrefetchParams pp;
+    while (ai < argc && argv[ai][0] == '-') {
+        if (strcmp(argv[ai], "-a") == 0) { append = true; ++ai; }
+        else if (strcmp(argv[ai], "-j") == 0 && ai + 1 < argc) { pp.workers = atoi(argv[ai + 1]); ai += 2; }
+        else return usage(argv[0]);
+    }
+    if (argc - ai < 2) return usage(argv[0]);
+
+    RawFrameWriter wr;
+    if (!wr.open(argv[ai], append)) { cerr << "无法写入: " << argv[ai] << "\n"; return 2; }
+
+    // PNG 解码在后台线程池里提前进行，与写盘重叠
+    int failed = 0;
+    FramePrefetcher pf(vector<string>(argv + ai + 1, argv + argc), pp);
+    PrefetchedFrame f;
+    while (pf.next(f)) {
+        if (!f.img) {
+            cerr << "跳过（需为 CV_16UC1）: " << f.path << "\n";
+            ++failed;
+            continue;
+        }
+        if (!wr.append(*f.img, f.path)) { cerr << "写入失败: " << f.path << "\n"; return 3; }
+    }
+    cout << "写入 " << wr.frames() << " 帧 -> " << argv[ai] << "\n";
+    return failed ? 4 : 0;
+}
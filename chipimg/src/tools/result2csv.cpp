@@ -0,0 +1,52 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "ResultRecord.h"
+
+using namespace std;
+
+// .chrr 结果记录转 CSV：默认逐格一行，-s 逐芯片一行汇总
+static int usage(const char* argv0)
+{
+    cerr << "Usage: " << argv0 << " [-s] <in.chrr> [out.csv]\n"
+         << "  -s  one summary row per chip (thresholds, stage counts, timing)\n"
+         << "  output goes to stdout when out.csv is omitted\n";
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    int ai = 1;
+    bool summary = false;
+    if (ai < argc && strcmp(argv[ai], "-s") == 0) { summary = true; ++ai; }
+    if (argc - ai < 1 || argc - ai > 2) return usage(argv[0]);
+
+    ResultRecordReader rd;
+    if (!rd.open(argv[ai])) { cerr << "打开失败: " << argv[ai] << "\n"; return 2; }
+    if (rd.version() > kResultRecordVersion)
+        cerr << "文件版本 " << rd.version() << " 高于本工具（" << kResultRecordVersion << "），只输出已知字段\n";
+
+    TextResultWriter out;
+    if (argc - ai == 2) {
+        if (!out.open(argv[ai + 1])) { cerr << "无法写入: " << argv[ai + 1] << "\n"; return 2; }
+    } else {
+        out.attach(stdout);
+    }
+
+    TextBuffer tb;
+    if (summary) writeResultSummaryCsvHeader(tb);
+    else         writeResultCsvHeader(tb);
+    long long n = 0;
+    bool ok = true;
+    ResultRecord rec;
+    while (rd.next(rec)) {
+        if (summary) writeResultSummaryCsv(tb, rec);
+        else         writeResultCsv(tb, rec);
+        ++n;
+        if (tb.size() >= 64 * 1024) { ok = out.write(tb) && ok; tb.clear(); }
+    }
+    ok = out.write(tb) && out.flush() && ok;
+    cerr << "记录数: " << n << "\n";
+    return ok ? 0 : 3;
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RawFrameStore.h"
+#include "ShmRing.h"
+
+using namespace cv;
+using namespace std;
+
+// 测试用采集端：建帧环和结果环，按给定帧率把图像轮流写进帧环（代替相机），
+// 同时从结果环收结果、统计端到端时延。检测端为 chipd -r <frame_ring> -R <result_ring>。
+static int usage(const char* argv0)
+{
+    cerr << "Usage: " << argv0 << " [-n frames] [-f fps] [-k kind] [-s slots] [-w wait_ms] [-v]\n"
+         << "       <frame_ring> <result_ring> <image.png|frames.chrf> [...]\n"
+         << "  -n  frames to send (default: one pass over the images)\n"
+         << "  -f  frame rate, 0 = as fast as the ring accepts (default 0)\n"
+         << "  -k  chip kind written into each frame header (default auto)\n"
+         << "  -s  frame ring slots (default 8); a full ring drops the frame like a camera would\n"
+         << "  -w  how long to wait for outstanding results after the last frame (default 5000)\n"
+         << "  -v  print one line per result\n";
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    long long n_frames = -1;
+    double fps = 0;
+    ChipKind kind = CHIP_AUTO;
+    int slots = 8, wait_ms = 5000;
+    bool verbose = false;
+    int ai = 1;
+    for (; ai < argc && argv[ai][0] == '-'; ++ai) {
+        const string a = argv[ai];
+        if (a == "-n" && ai + 1 < argc)      n_frames = atoll(argv[++ai]);
+        else if (a == "-f" && ai + 1 < argc) fps = atof(argv[++ai]);
+        else if (a == "-k" && ai + 1 < argc) { if (!parseChipKind(argv[++ai], kind)) return usage(argv[0]); }
+        else if (a == "-s" && ai + 1 < argc) slots = atoi(argv[++ai]);
+        else if (a == "-w" && ai + 1 < argc) wait_ms = atoi(argv[++ai]);
+        else if (a == "-v")                  verbose = true;
+        else return usage(argv[0]);
+    }
+    if (argc - ai < 3 || slots <= 0) return usage(argv[0]);
+    const string frame_ring = argv[ai], result_ring = argv[ai + 1];
+
+    vector<Mat> imgs;
+    int max_w = 0, max_h = 0;
+    for (int i = ai + 2; i < argc; ++i) {
+        RawFrameReader rd;
+        Mat m = loadFrame16(argv[i], rd);
+        if (m.empty() || m.type() != CV_16UC1) { cerr << "跳过（非 16 位单通道或读取失败）: " << argv[i] << "\n"; continue; }
+        imgs.push_back(m.clone());
+        max_w = std::max(max_w, m.cols);
+        max_h = std::max(max_h, m.rows);
+    }
+    if (imgs.empty()) { cerr << "没有可用图像\n"; return 2; }
+    if (n_frames < 0) n_frames = (long long)imgs.size();
+
+    // 结果环槽数给足，检测端偶尔领先时不必等采集端来收
+    ShmRing frames, results;
+    if (!frames.create(frame_ring, (uint32_t)slots, shmFrameSlotBytes(max_w, max_h)) ||
+        !results.create(result_ring, (uint32_t)slots * 4, 256 * 1024)) {
+        cerr << "无法创建共享内存环: " << frame_ring << " / " << result_ring << "\n";
+        ShmRing::remove(frame_ring);
+        return 2;
+    }
+    cerr << "rings ready: " << frame_ring << " (" << slots << " x " << frames.slotBytes() << " B), "
+         << result_ring << "\n";
+
+    std::atomic<long long> sent(0);
+    std::atomic<bool> sending(true);
+    long long received = 0, ok = 0;
+    vector<double> lat;
+    thread collector([&]{
+        ResultRecord rec;
+        chrono::steady_clock::time_point give_up{};
+        for (;;) {
+            if (!sending) {
+                if (received >= sent) break;
+                const auto now = chrono::steady_clock::now();
+                if (give_up == chrono::steady_clock::time_point{}) give_up = now + chrono::milliseconds(wait_ms);
+                else if (now > give_up) break;
+            }
+            if (!takeShmResult(results, rec, 100)) continue;
+            const double ms = (shmNowUs() - rec.timestamp_us) / 1000.0;
+            ++received;
+            if (rec.chip.ok) ++ok;
+            lat.push_back(ms);
+            if (verbose)
+                cout << rec.frame_id << " " << chipKindName(rec.chip.kind) << " " << (rec.chip.ok ? "ok" : "fail")
+                     << " points=" << rec.chip.points.size() << " latency_ms=" << ms << "\n";
+        }
+    });
+
+    long long dropped = 0;
+    const auto t0 = chrono::steady_clock::now();
+    for (long long i = 0; i < n_frames; ++i) {
+        if (fps > 0)
+            this_thread::sleep_until(t0 + chrono::microseconds((long long)(i * 1e6 / fps)));
+        ShmRing::Slot s;
+        // 相机不等人：环满就丢这一帧
+        if (!frames.beginWrite(s, 0)) { ++dropped; continue; }
+        shmPutFrame(s, imgs[i % imgs.size()], (uint64_t)i, shmNowUs(), (int)kind);
+        frames.commitWrite(s, s.bytes);
+        ++sent;
+    }
+    const double send_s = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    sending = false;
+    collector.join();
+
+    cerr << "sent=" << sent << " dropped=" << dropped << " results=" << received << " ok=" << ok
+         << " send_fps=" << (send_s > 0 ? sent / send_s : 0.0) << "\n";
+    if (!lat.empty()) {
+        sort(lat.begin(), lat.end());
+        double sum = 0;
+        for (double v : lat) sum += v;
+        cerr << "latency_ms mean=" << sum / lat.size() << " p50=" << lat[lat.size() / 2]
+             << " p95=" << lat[std::min(lat.size() - 1, lat.size() * 95 / 100)] << " max=" << lat.back() << "\n";
+    }
+    ShmRing::remove(frame_ring);
+    ShmRing::remove(result_ring);
+    return received == sent ? 0 : 3;
+}
@@ -0,0 +1,106 @@
+#include <opencv2/opencv.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ParamSweep.h"
+#include "RawFrameStore.h"
+
+using namespace std;
+using namespace cv;
+
+// 参数扫描：不用再改 main_*.cpp 的常量重编译
+static int usage(const char* argv0)
+{
+    cerr << "Usage: " << argv0 << " <C5|4X|GMY|PG|std> [options] name=lo:hi:step ... <img1> [img2 ...]\n"
+         << "  name=v            fix a parameter (default: ShapeDetectionAPI_*.h)\n"
+         << "  name=lo:hi:step   sweep a parameter\n"
+         << "  -r N              random search: N samples from the grid\n"
+         << "  -s SEED           random seed\n"
+         << "  -j N              worker threads (default: all cores)\n"
+         << "  -k K              print top K (default 10)\n"
+         << "  params:";
+    for (const auto& n : chipParamNames()) cerr << " " << n;
+    cerr << "\n";
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) return usage(argv[0]);
+
+    SweepSpec spec;
+    if (!parseChipKind(argv[1], spec.kind) || spec.kind == CHIP_AUTO) {
+        cerr << "❌ Unknown chip type: " << argv[1] << "\n";
+        return usage(argv[0]);
+    }
+    spec.base = chipDefaultParams(spec.kind);
+
+    int top = 10;
+    vector<string> paths;
+    for (int i = 2; i < argc; ++i) {
+        const string a = argv[i];
+        if ((a == "-r" || a == "-s" || a == "-j" || a == "-k") && i + 1 < argc) {
+            const int v = atoi(argv[++i]);
+            if (a == "-r") spec.random = v;
+            else if (a == "-s") spec.seed = (unsigned)v;
+            else if (a == "-j") spec.workers = v;
+            else top = v;
+            continue;
+        }
+        const size_t eq = a.find('=');
+        if (eq == string::npos) { paths.push_back(a); continue; }
+
+        SweepRange r;
+        r.name = a.substr(0, eq);
+        double lo = 0, hi = 0, step = 0;
+        const int n = sscanf(a.c_str() + eq + 1, "%lf:%lf:%lf", &lo, &hi, &step);
+        if (n == 1) {
+            if (!setChipParam(spec.base, r.name, lo)) { cerr << "❌ Unknown param: " << r.name << "\n"; return 1; }
+            continue;
+        }
+        if (n != 3 || !setChipParam(spec.base, r.name, lo)) { cerr << "❌ Bad range: " << a << "\n"; return 1; }
+        // 扫一个检测不读的参数只会得到一排同分结果
+        if (!chipParamUsed(spec.kind, r.name)) {
+            cerr << "❌ " << chipKindName(spec.kind) << " does not read param: " << r.name << "\n";
+            return 1;
+        }
+        r.lo = lo; r.hi = hi; r.step = step;
+        spec.ranges.push_back(r);
+    }
+    if (paths.empty()) return usage(argv[0]);
+
+    vector<unique_ptr<RawFrameReader>> readers;
+    vector<Mat> frames;
+    for (const auto& p : paths) {
+        readers.emplace_back(new RawFrameReader());
+        Mat m = loadFrame16(p, *readers.back());
+        if (m.empty() || m.type() != CV_16UC1) { cerr << "跳过（需为 CV_16UC1）: " << p << "\n"; continue; }
+        frames.push_back(m);
+    }
+    if (frames.empty()) return 2;
+
+    const double t0 = (double)getTickCount();
+    const vector<SweepEntry> res = runSweep(frames, spec);
+    const double ms = ((double)getTickCount() - t0) * 1000.0 / getTickFrequency();
+    cout << chipKindName(spec.kind) << "  " << res.size() << " 组参数 x " << frames.size()
+         << " 张图，用时 " << ms << " ms\n";
+
+    for (int k = 0; k < (int)res.size() && k < top; ++k) {
+        const auto& e = res[k];
+        printf("#%d score=%.4f complete=%.3f regular=%.3f wells=%d(%.0f%%) ", k + 1,
+               e.score.score, e.score.completeness, e.score.regularity,
+               e.score.modal_wells, e.score.well_consistency * 100.0);
+        for (const auto& r : spec.ranges) {
+            double v = 0;
+            getChipParam(e.params, r.name, v);
+            printf(" %s=%g", r.name.c_str(), v);
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <string>
+
+#include "TuneViewer.h"
+#include "RawFrameStore.h"
+
+using namespace std;
+using namespace cv;
+
+// 交互调参：拖动滑条只重算受影响的下游阶段，回车打印当前参数，Esc / q 退出
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        cerr << "Usage: " << argv[0] << " <C5|4X|GMY|PG> <img> [--lattice]\n";
+        return 1;
+    }
+    ChipKind kind;
+    if (!parseChipKind(argv[1], kind) || kind == CHIP_AUTO || kind == CHIP_STD) {
+        cerr << "❌ Unsupported chip type: " << argv[1] << "\n";
+        return 1;
+    }
+    const string path = argv[2];
+    RawFrameReader frame_reader;
+    Mat src16 = loadFrame16(path, frame_reader);
+    if (src16.empty() || src16.type() != CV_16UC1) {
+        cerr << "读取失败或类型不是 CV_16UC1: " << path << "\n";
+        return 2;
+    }
+
+    SD_Options opts;
+    opts.lattice.enable = (argc >= 4 && string(argv[3]) == "--lattice");
+
+    FrameStages stages(src16);
+    auto pipe = makeTunePipeline(kind, stages, &opts);
+    if (!pipe) {
+        cerr << "❌ Chip type not built: " << argv[1] << "\n";
+        return 1;
+    }
+    runTuneViewer(*pipe, src16, chipDefaultParams(kind), string("tune ") + chipKindName(kind) + " | " + path);
+    cout << "stage cache: hits=" << stages.cache().hits() << " misses=" << stages.cache().misses() << "\n";
+    return 0;
+}
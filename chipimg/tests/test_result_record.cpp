@@ -0,0 +1,171 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ResultRecord.h"
+
+using namespace std;
+
+// .chrr 往返：编码 -> 写文件 -> 截断尾记录 -> 追加打开续写 -> 读回
+static int g_fail = 0;
+#define CHECK(c) do { if (!(c)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); ++g_fail; } } while (0)
+
+static ChipResult makeChip(int index)
+{
+    ChipResult r;
+    r.chip_index = index;
+    r.roi  = cv::Rect(100 + index, 50, 300, 200);
+    r.kind = CHIP_4X;
+    r.ok   = true;
+    r.wells_per_row = { 2, 1 };
+    r.point_rows = 2;
+    r.point_cols = 2;
+    r.slots = 3 * 4;
+    for (int s = 0; s < r.slots; ++s) {
+        if (s == 5) continue;   // 一个无效格
+        ChipPoint q;
+        const int well = s / 4;
+        q.wr = well < 2 ? 0 : 1;
+        q.wc = well < 2 ? well : 0;
+        q.pr = (s % 4) / 2;
+        q.pc = (s % 4) % 2;
+        q.x  = r.roi.x + 10.25f * (s + 1);
+        q.y  = r.roi.y + 7.5f * (s + 1);
+        q.measured = s != 7;
+        r.points.push_back(q);
+    }
+    r.report.low_v  = 120;
+    r.report.high_v = 3900;
+    r.report.spots  = 11;
+    for (int w = 0; w < 3; ++w) r.report.anchors.push_back(cv::Point2f(r.roi.x + 40.f * w, r.roi.y + 20.f));
+    return r;
+}
+
+static bool samePoints(const ChipResult& a, const ChipResult& b)
+{
+    if (a.points.size() != b.points.size()) return false;
+    for (size_t i = 0; i < a.points.size(); ++i) {
+        const ChipPoint& p = a.points[i];
+        const ChipPoint& q = b.points[i];
+        if (p.wr != q.wr || p.wc != q.wc || p.pr != q.pr || p.pc != q.pc || p.measured != q.measured ||
+            fabs(p.x - q.x) > 0.25f || fabs(p.y - q.y) > 0.25f)
+            return false;
+    }
+    return true;
+}
+
+static long long fileSize(const string& path)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    const long long n = ftell(f);
+    fclose(f);
+    return n;
+}
+
+int main()
+{
+    // 内存往返
+    {
+        vector<uint8_t> buf;
+        const ChipResult c = makeChip(0);
+        encodeResultRecord(c, 42, 123456, buf);
+        ResultRecord rec;
+        CHECK(decodeResultRecord(buf.data(), buf.size(), rec));
+        CHECK(rec.frame_id == 42 && rec.timestamp_us == 123456);
+        CHECK(rec.chip.kind == CHIP_4X && rec.chip.ok && rec.chip.slots == c.slots);
+        CHECK(rec.chip.wells_per_row == c.wells_per_row);
+        CHECK(rec.chip.report.low_v == 120 && rec.chip.report.high_v == 3900 && rec.chip.report.spots == 11);
+        CHECK(rec.chip.report.anchors.size() == 3);
+        CHECK(samePoints(c, rec.chip));
+        CHECK(!decodeResultRecord(buf.data(), buf.size() - 1, rec));
+    }
+
+    // ROI 左上方（负偏移）和远在 ROI 外的点、锚点都要原样读回，不能变成 NaN
+    {
+        ChipResult c = makeChip(0);
+        c.points[0].x = c.roi.x - 12.5f;
+        c.points[0].y = c.roi.y - 3.25f;
+        c.points[1].x = c.roi.x + 20000.f;
+        c.report.anchors[0] = cv::Point2f(c.roi.x - 40.f, c.roi.y - 0.75f);
+        c.report.anchors[1] = cv::Point2f(NAN, NAN);
+        vector<uint8_t> buf;
+        encodeResultRecord(c, 7, 0, buf);
+        ResultRecord rec;
+        CHECK(decodeResultRecord(buf.data(), buf.size(), rec));
+        CHECK(samePoints(c, rec.chip));
+        CHECK(rec.chip.report.anchors.size() == 3);
+        if (rec.chip.report.anchors.size() == 3) {
+            CHECK(fabs(rec.chip.report.anchors[0].x - (c.roi.x - 40.f)) < 0.01f);
+            CHECK(fabs(rec.chip.report.anchors[0].y - (c.roi.y - 0.75f)) < 0.01f);
+            CHECK(std::isnan(rec.chip.report.anchors[1].x));
+        }
+        // 坐标非有限的点不能以有效点写出
+        c.points[2].x = NAN;
+        buf.clear();
+        encodeResultRecord(c, 8, 0, buf);
+        CHECK(decodeResultRecord(buf.data(), buf.size(), rec));
+        CHECK(rec.chip.points.size() == c.points.size() - 1);
+    }
+
+    const string path = "test_result_record.chrr";
+    {
+        ResultRecordWriter w;
+        CHECK(w.open(path));
+        CHECK(w.append(makeChip(0), 1, 10));
+        CHECK(w.append(makeChip(1), 2, 20));
+        w.close();
+    }
+    // 模拟写端中途退出：砍掉最后一条记录的末尾几个字节
+    const long long full = fileSize(path);
+    CHECK(full > 0);
+    {
+        FILE* f = fopen(path.c_str(), "rb");
+        vector<char> all((size_t)full);
+        CHECK(f && fread(all.data(), 1, all.size(), f) == all.size());
+        if (f) fclose(f);
+        f = fopen(path.c_str(), "wb");
+        CHECK(f && fwrite(all.data(), 1, all.size() - 5, f) == all.size() - 5);
+        if (f) fclose(f);
+    }
+    {
+        ResultRecordWriter w;
+        CHECK(w.open(path, true));
+        CHECK(w.append(makeChip(2), 3, 30));
+        w.close();
+    }
+    {
+        ResultRecordReader rd;
+        CHECK(rd.open(path));
+        CHECK(rd.version() == kResultRecordVersion);
+        ResultRecord rec;
+        vector<uint64_t> ids;
+        while (rd.next(rec)) {
+            ids.push_back(rec.frame_id);
+            CHECK(samePoints(makeChip((int)rec.frame_id - 1), rec.chip));
+        }
+        // 被截断的第 2 条丢掉，续写的第 3 条能读到
+        CHECK((ids == vector<uint64_t>{ 1, 3 }));
+    }
+    // 记录长度字段损坏（远超文件剩余字节）：读端直接停下，不按它分配
+    {
+        FILE* f = fopen(path.c_str(), "r+b");
+        CHECK(f != nullptr);
+        if (f) {
+            const uint32_t bogus = 0xFFFFFFF0u;
+            fseek(f, 16, SEEK_SET);
+            CHECK(fwrite(&bogus, sizeof(bogus), 1, f) == 1);
+            fclose(f);
+        }
+        ResultRecordReader rd;
+        CHECK(rd.open(path));
+        ResultRecord rec;
+        CHECK(!rd.next(rec));
+    }
+    remove(path.c_str());
+
+    if (g_fail) fprintf(stderr, "%d check(s) failed\n", g_fail);
+    return g_fail ? 1 : 0;
+}
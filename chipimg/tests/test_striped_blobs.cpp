@@ -0,0 +1,121 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "StripedBlobs.h"
+
+using namespace std;
+
+// 分带连通域与整帧 connectedComponentsWithStats 逐项一致：个数、面积、外接框、质心、光栅序。
+// 图形都跨带缝：U 形 / 倒 U 形（两段在不同带里才连上）、对角线（只靠 8 邻接过缝）、棋盘格、贴边块
+static int g_fail = 0;
+#define CHECK(c) do { if (!(c)) { fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #c); ++g_fail; } } while (0)
+
+static const uint16_t kBack = 1000;
+static const uint16_t kFore = 50000;
+
+static void fillRect(cv::Mat& img, int x, int y, int w, int h, uint16_t v)
+{
+    for (int r = y; r < y + h; ++r)
+        for (int c = x; c < x + w; ++c) img.ptr<uint16_t>(r)[c] = v;
+}
+
+// OpenCV 的 8 连通标记按 2x2 块扫描，两个分量首行落在同一对行里时编号先后未必是严格光栅序；
+// 这里各分量首行两两至少隔 2 行，两边的顺序都是确定的
+static cv::Mat makeImage()
+{
+    cv::Mat img(96, 80, CV_16UC1);
+    fillRect(img, 0, 0, img.cols, img.rows, kBack);
+
+    fillRect(img, 5, 10, 12, 30, kFore);                 // 竖条
+    fillRect(img, 30, 20, 3, 31, kFore);                 // U：两臂在下方才连上
+    fillRect(img, 40, 20, 3, 31, kFore);
+    fillRect(img, 30, 48, 13, 3, kFore);
+    fillRect(img, 50, 30, 14, 3, kFore);                 // 倒 U：两腿在上方连着
+    fillRect(img, 50, 30, 3, 25, kFore);
+    fillRect(img, 61, 30, 3, 25, kFore);
+    for (int i = 0; i < 40; ++i) fillRect(img, 5 + i, 50 + i, 1, 1, kFore);   // 对角线
+    for (int r = 0; r < 7; ++r)                          // 棋盘格：只靠对角相连
+        for (int c = 0; c < 7; ++c)
+            if ((r + c) % 2 == 0) fillRect(img, 66 + c, 60 + r, 1, 1, kFore);
+    fillRect(img, 74, 2, 6, 9, kFore);                   // 贴右边
+    fillRect(img, 0, 95, 4, 1, kFore);                   // 末行
+    fillRect(img, 20, 0, 1, 1, kFore);                   // 首行单点
+    fillRect(img, 55, 90, 2, 6, kFore);
+    return img;
+}
+
+// 与 stripedBlobs16U 相同的逐像素映射
+static cv::Mat applyLut(const cv::Mat& img, const vector<uint8_t>& lut)
+{
+    cv::Mat out(img.rows, img.cols, CV_8UC1);
+    for (int r = 0; r < img.rows; ++r) {
+        const uint16_t* p = img.ptr<uint16_t>(r);
+        uchar* q = out.ptr<uchar>(r);
+        for (int c = 0; c < img.cols; ++c) q[c] = lut[p[c]];
+    }
+    return out;
+}
+
+static void compareWithReference(const vector<BlobStat>& blobs, const cv::Mat& view8, double th, int band)
+{
+    cv::Mat bin;
+    cv::threshold(view8, bin, th, 255, cv::THRESH_BINARY);
+    cv::Mat labels, stats, centroids;
+    const int n = cv::connectedComponentsWithStats(bin, labels, stats, centroids, 8, CV_32S);
+
+    CHECK((int)blobs.size() == n - 1);
+    if ((int)blobs.size() != n - 1) {
+        fprintf(stderr, "  band=%d: %d blobs, reference %d\n", band, (int)blobs.size(), n - 1);
+        return;
+    }
+    for (int i = 1; i < n; ++i) {
+        const BlobStat& b = blobs[i - 1];
+        const cv::Rect ref(stats.at<int>(i, cv::CC_STAT_LEFT), stats.at<int>(i, cv::CC_STAT_TOP),
+                           stats.at<int>(i, cv::CC_STAT_WIDTH), stats.at<int>(i, cv::CC_STAT_HEIGHT));
+        const bool same = b.area == stats.at<int>(i, cv::CC_STAT_AREA) && b.bbox == ref &&
+                          fabs(b.centroid.x - centroids.at<double>(i, 0)) < 1e-3 &&
+                          fabs(b.centroid.y - centroids.at<double>(i, 1)) < 1e-3;
+        CHECK(same);
+        if (!same) fprintf(stderr, "  band=%d: blob %d differs\n", band, i - 1);
+    }
+}
+
+int main()
+{
+    const cv::Mat img = makeImage();
+    vector<uint8_t> lut;
+    buildEnhanceLut8(0, 65535, 1.0f, lut);
+    const cv::Mat view8 = applyLut(img, lut);
+
+    vector<uint32_t> hist(65536, 0u);
+    accumulateHistogram16U(img, 0, img.rows, hist.data());
+
+    // 带高 1 时每行一带；96 整除与不整除的带高都要覆盖；>= 行数时即整帧一带
+    const int bands[] = { 1, 2, 3, 7, 16, 31, 64, 96, 200 };
+    for (int band : bands) {
+        vector<BlobStat> blobs;
+        CHECK(stripedBlobs16U(img, lut, nullptr, 128.0, 1.0, band, blobs));
+        compareWithReference(blobs, view8, 128.0, band);
+
+        // Otsu：由 16 位直方图换算，阈值与 OpenCV 一致
+        double th = -1.0;
+        vector<BlobStat> otsu_blobs;
+        CHECK(stripedBlobs16U(img, lut, hist.data(), -1.0, 1.0, band, otsu_blobs, &th));
+        cv::Mat bin;
+        const double ref_th = cv::threshold(view8, bin, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        CHECK(th == ref_th);
+        compareWithReference(otsu_blobs, view8, th, band);
+    }
+
+    // Otsu 没给直方图时拒绝
+    vector<BlobStat> blobs;
+    CHECK(!stripedBlobs16U(img, lut, nullptr, -1.0, 1.0, 16, blobs));
+
+    if (g_fail) {
+        fprintf(stderr, "%d check(s) failed\n", g_fail);
+        return 1;
+    }
+    printf("striped_blobs: ok\n");
+    return 0;
+}